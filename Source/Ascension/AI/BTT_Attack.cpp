@@ -5,49 +5,83 @@
 #include "AIController.h"
 #include "Entities/Characters/Enemies/Enemy.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
 #include "Components/AttackComponent.h"
 
 
 UBTT_Attack::UBTT_Attack()
 {
-	bNotifyTick = true;
-	bCreateNodeInstance = true;
+	bNotifyTick = false;
+	bCreateNodeInstance = false;
+
+	WantsObserveKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UBTT_Attack, WantsObserveKey));
+}
+
+void UBTT_Attack::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+	{
+		WantsObserveKey.ResolveSelectedKey(*BlackboardAsset);
+	}
+}
+
+uint16 UBTT_Attack::GetInstanceMemorySize() const
+{
+	return sizeof(FBTAttackTaskMemory);
 }
 
 EBTNodeResult::Type UBTT_Attack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	
-	BlackboardComponent = OwnerComp.GetBlackboardComponent();
-	ACharacter* ControlledPawn = Cast<ACharacter>(OwnerComp.GetAIOwner()->GetPawn());
-	AEnemy* Enemy = Cast<AEnemy>(ControlledPawn);
+	FBTAttackTaskMemory* Memory = (FBTAttackTaskMemory*) NodeMemory;
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+	UAttackComponent* AttackComponent = Enemy ? Enemy->FindComponentByClass<UAttackComponent>() : nullptr;
 
-	Enemy->Attack();
-	UAttackComponent* AttackComponent = Enemy->FindComponentByClass<UAttackComponent>();
+	Memory->AttackComponent = AttackComponent;
+	Memory->AttackFinishedHandle = 0;
 
-	if (AttackComponent)
+	if (AttackComponent == nullptr)
 	{
-		AttackComponent->OnAttackComplete.AddDynamic(this, &UBTT_Attack::AttackComplete);
+		return EBTNodeResult::Failed;
 	}
 
-	return EBTNodeResult::InProgress;
+	Enemy->Attack();
+
+	// Enemies that are busy, e.g. dodging, don't start the attack. An enemy still attacking is waited for.
+	Memory->AttackFinishedHandle = AttackComponent->BindAttackFinished(AttackComponent->GetLastAttackID(),
+		FOnAttackFinished::CreateUObject(this, &UBTT_Attack::OnAttackFinished, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp)));
+
+	return Memory->AttackFinishedHandle != 0 ? EBTNodeResult::InProgress : EBTNodeResult::Failed;
 }
 
-void UBTT_Attack::AttackComplete_Implementation(const bool Successful)
+EBTNodeResult::Type UBTT_Attack::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	BlackboardComponent->SetValueAsBool(WantsObserveKey.SelectedKeyName, true);
+	FBTAttackTaskMemory* Memory = (FBTAttackTaskMemory*) NodeMemory;
 
-	UBehaviorTreeComponent* OwnerComp = Cast<UBehaviorTreeComponent>(GetOuter());
-	if (OwnerComp)
+	if (UAttackComponent* AttackComponent = Memory->AttackComponent.Get())
 	{
-		ACharacter* ControlledPawn = Cast<ACharacter>(OwnerComp->GetAIOwner()->GetPawn());
-		AEnemy* Enemy = Cast<AEnemy>(ControlledPawn);
-		UAttackComponent* AttackComponent = Enemy->FindComponentByClass<UAttackComponent>();
+		AttackComponent->UnbindAttackFinished(Memory->AttackFinishedHandle);
+	}
+
+	Memory->AttackFinishedHandle = 0;
+
+	return EBTNodeResult::Aborted;
+}
 
-		if (AttackComponent)
-		{
-			AttackComponent->OnAttackComplete.RemoveDynamic(this, &UBTT_Attack::AttackComplete);
-		}
+void UBTT_Attack::OnAttackFinished(uint8 AttackID, bool bSuccessful, TWeakObjectPtr<UBehaviorTreeComponent> OwnerComp)
+{
+	UBehaviorTreeComponent* BehaviorTree = OwnerComp.Get();
+
+	if (BehaviorTree == nullptr)
+	{
+		return;
+	}
 
-		FinishLatentTask(*OwnerComp, EBTNodeResult::Succeeded);
+	if (UBlackboardComponent* BlackboardComponent = BehaviorTree->GetBlackboardComponent())
+	{
+		BlackboardComponent->SetValue<UBlackboardKeyType_Bool>(WantsObserveKey.GetSelectedKeyID(), true);
 	}
+
+	FinishLatentTask(*BehaviorTree, bSuccessful ? EBTNodeResult::Succeeded : EBTNodeResult::Failed);
 }
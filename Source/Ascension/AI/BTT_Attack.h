@@ -5,8 +5,23 @@
 #include "BehaviorTree/BTTaskNode.h"
 #include "BTT_Attack.generated.h"
 
+
+/*
+ * Memory of an attack task, kept per AI by the behavior tree.
+ */
+struct FBTAttackTaskMemory
+{
+	/** Attack component of the enemy performing the attack. */
+	TWeakObjectPtr<class UAttackComponent> AttackComponent;
+
+	/** Handle of the callback waiting for the attack to finish. */
+	uint32 AttackFinishedHandle;
+};
+
 /**
  * Task that makes an enemy perform an attack.
+ * The task isn't instanced: the state of each AI running it is kept in its node memory. It doesn't tick, and
+ * finishes when the attack component calls back with the attack's result.
  */
 UCLASS()
 class ASCENSION_API UBTT_Attack : public UBTTaskNode
@@ -19,15 +34,26 @@ public:
 	FBlackboardKeySelector WantsObserveKey;
 	
 protected:
+	/** Resolves the blackboard keys of the task. */
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
 	/** Starts execution for the task. */
 	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 
-	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Progress")
-	void AttackComplete(const bool Successful);
+	/** Stops waiting for the attack when the task is aborted. */
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/*
+	 * Called by the attack component when the attack finishes.
+	 * @param AttackID		ID of the attack.
+	 * @param bSuccessful	Whether the attack finished normally.
+	 * @param OwnerComp		Behavior tree running the task.
+	 */
+	void OnAttackFinished(uint8 AttackID, bool bSuccessful, TWeakObjectPtr<UBehaviorTreeComponent> OwnerComp);
+
+	/** Returns the size of the memory kept for each AI. */
+	virtual uint16 GetInstanceMemorySize() const override;
 
 public:
 	UBTT_Attack();
-
-private:
-	UBlackboardComponent* BlackboardComponent;
 };
@@ -3,32 +3,108 @@
 #include "Ascension.h"
 #include "BTT_CyclePatrolPoints.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Int.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 #include "Components/PatrolComponent.h"
+#include "AI/PatrolRoute.h"
 #include "AIController.h"
+#include "BrainComponent.h"
+#include "Navigation/PathFollowingComponent.h"
 
 
+UBTT_CyclePatrolPoints::UBTT_CyclePatrolPoints()
+{
+	bCreateNodeInstance = false;
+
+	bFollowRoutePaths = true;
+	RoutePathStartTolerance = 150.0f;
+
+	PatrolPointKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTT_CyclePatrolPoints, PatrolPointKey), AActor::StaticClass());
+	NextPatrolPointIndexKey.AddIntFilter(this, GET_MEMBER_NAME_CHECKED(UBTT_CyclePatrolPoints, NextPatrolPointIndexKey));
+}
+
+void UBTT_CyclePatrolPoints::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+	{
+		PatrolPointKey.ResolveSelectedKey(*BlackboardAsset);
+		NextPatrolPointIndexKey.ResolveSelectedKey(*BlackboardAsset);
+	}
+}
+
+uint16 UBTT_CyclePatrolPoints::GetInstanceMemorySize() const
+{
+	return sizeof(FBTCyclePatrolPointsTaskMemory);
+}
+
 EBTNodeResult::Type UBTT_CyclePatrolPoints::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	FBTCyclePatrolPointsTaskMemory* Memory = (FBTCyclePatrolPointsTaskMemory*) NodeMemory;
 	UBlackboardComponent* BlackboardComponent = OwnerComp.GetBlackboardComponent();
-	AActor* Owner = OwnerComp.GetAIOwner()->GetPawn();
+	AAIController* AIController = OwnerComp.GetAIOwner();
+	AActor* Owner = AIController->GetPawn();
+
+	Memory->MoveRequestID = FAIRequestID::InvalidRequest;
 
-	UPatrolComponent* PatrolComponent = Owner->FindComponentByClass<UPatrolComponent>();
+	UPatrolComponent* PatrolComponent = Owner ? Owner->FindComponentByClass<UPatrolComponent>() : nullptr;
 
 	if (PatrolComponent)
 	{
-		TArray<AActor*> Points = PatrolComponent->GetPatrolPoints();
-		int Index = BlackboardComponent->GetValueAsInt(NextPatrolPointIndexKey.SelectedKeyName);
+		const TArray<AActor*>& Points = PatrolComponent->GetPatrolPoints();
+
+		if (Points.Num() == 0)
+		{
+			return EBTNodeResult::Failed;
+		}
+
+		int Index = BlackboardComponent->GetValue<UBlackboardKeyType_Int>(NextPatrolPointIndexKey.GetSelectedKeyID());
 
 		if (Points.IsValidIndex(Index))
 		{
-			BlackboardComponent->SetValueAsObject(PatrolPointKey.SelectedKeyName, Points[Index]);
+			BlackboardComponent->SetValue<UBlackboardKeyType_Object>(PatrolPointKey.GetSelectedKeyID(), Points[Index]);
 		}
 
 		int NextIndex = (Index + 1) % Points.Num();
-		BlackboardComponent->SetValueAsInt(NextPatrolPointIndexKey.SelectedKeyName, NextIndex);
+		BlackboardComponent->SetValue<UBlackboardKeyType_Int>(NextPatrolPointIndexKey.GetSelectedKeyID(), NextIndex);
+
+		// Characters at the previous point move along the route's path, shared by everyone on the route.
+		const APatrolRoute* Route = bFollowRoutePaths ? PatrolComponent->GetRoute() : nullptr;
+		const TArray<FVector>* RoutePath = Route ? Route->FindPathTo(Index) : nullptr;
+
+		if (RoutePath && FVector::DistSquared2D(Owner->GetActorLocation(), (*RoutePath)[0]) <= FMath::Square(RoutePathStartTolerance))
+		{
+			// Each character follows its own copy, as following a path changes it.
+			const FNavPathSharedPtr Path = MakeShareable(new FNavigationPath(*RoutePath, nullptr));
+			const FAIRequestID RequestID = AIController->RequestMove(FAIMoveRequest(RoutePath->Last()), Path);
+
+			if (RequestID.IsValid())
+			{
+				Memory->MoveRequestID = RequestID;
+				WaitForMessage(OwnerComp, UBrainComponent::AIMessage_MoveFinished, RequestID);
+
+				return EBTNodeResult::InProgress;
+			}
+		}
 
 		return EBTNodeResult::Succeeded;
 	}
 
 	return EBTNodeResult::Failed;
 }
+
+EBTNodeResult::Type UBTT_CyclePatrolPoints::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FBTCyclePatrolPointsTaskMemory* Memory = (FBTCyclePatrolPointsTaskMemory*) NodeMemory;
+	AAIController* AIController = OwnerComp.GetAIOwner();
+
+	if (Memory->MoveRequestID.IsValid() && AIController && AIController->GetPathFollowingComponent())
+	{
+		AIController->GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::OwnerFinished, Memory->MoveRequestID);
+	}
+
+	Memory->MoveRequestID = FAIRequestID::InvalidRequest;
+
+	return Super::AbortTask(OwnerComp, NodeMemory);
+}
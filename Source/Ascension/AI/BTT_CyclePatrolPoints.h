@@ -3,10 +3,24 @@
 #pragma once
 
 #include "BehaviorTree/BTTaskNode.h"
+#include "AITypes.h"
 #include "BTT_CyclePatrolPoints.generated.h"
 
+
+/*
+ * Memory of a cycle patrol points task, kept per AI by the behavior tree.
+ */
+struct FBTCyclePatrolPointsTaskMemory
+{
+	/** Move along the route's cached path. Invalid while not moving. */
+	FAIRequestID MoveRequestID;
+};
+
 /**
   * Task that sets the next point that a character has to patrol to.
+  * On a patrol route, a character at the previous point moves to the next along the route's cached path before the
+  * task finishes, so the move that follows has nothing left to pathfind. Otherwise the task finishes straight away.
+  * The task isn't instanced: the state of each AI running it is kept in its node memory.
   */
 UCLASS()
 class ASCENSION_API UBTT_CyclePatrolPoints : public UBTTaskNode
@@ -22,7 +36,27 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Blackboard")
 	FBlackboardKeySelector NextPatrolPointIndexKey;
 
+	/** Whether characters on a patrol route move along its cached paths. */
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	bool bFollowRoutePaths;
+
+	/** Distance from the start of a cached path within which a character can move along it. */
+	UPROPERTY(EditAnywhere, Category = "Patrol", meta = (EditCondition = "bFollowRoutePaths", ClampMin = "0.0"))
+	float RoutePathStartTolerance;
+
 protected:
+	/** Resolves the blackboard keys of the task. */
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
+	/** Size of the memory kept per AI for the task. */
+	virtual uint16 GetInstanceMemorySize() const override;
+
 	/** Starts execution for the task. */
 	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/** Stops the move along the route when the task is aborted. */
+	EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+public:
+	UBTT_CyclePatrolPoints();
 };
@@ -3,56 +3,96 @@
 #include "Ascension.h"
 #include "BTT_Strafe.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 #include "AIController.h"
 #include "Components/StrafeComponent.h"
+#include "Combat/CombatCoordinatorSubsystem.h"
+#include "Entities/Characters/Enemies/Enemy.h"
 
 
 UBTT_Strafe::UBTT_Strafe()
 {
 	bNotifyTick = true;
+	bCreateNodeInstance = false;
+
+	EnemyKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTT_Strafe, EnemyKey), AActor::StaticClass());
+	WantsAttackKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UBTT_Strafe, WantsAttackKey));
+}
+
+void UBTT_Strafe::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+	{
+		EnemyKey.ResolveSelectedKey(*BlackboardAsset);
+		WantsAttackKey.ResolveSelectedKey(*BlackboardAsset);
+	}
+}
+
+uint16 UBTT_Strafe::GetInstanceMemorySize() const
+{
+	return sizeof(FBTStrafeTaskMemory);
 }
 
 EBTNodeResult::Type UBTT_Strafe::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	UBlackboardComponent* BlackboardComponent = OwnerComp.GetBlackboardComponent();
-	UStrafeComponent* StrafeComponent = OwnerComp.GetAIOwner()->GetPawn()->FindComponentByClass<UStrafeComponent>();
-	AActor* Enemy = Cast<AActor>(BlackboardComponent->GetValueAsObject(EnemyKey.SelectedKeyName));
+	FBTStrafeTaskMemory* Memory = (FBTStrafeTaskMemory*) NodeMemory;
+	APawn* Pawn = OwnerComp.GetAIOwner()->GetPawn();
 
-	if (StrafeComponent)
+	Memory->StrafeComponent = Pawn ? Pawn->FindComponentByClass<UStrafeComponent>() : nullptr;
+	Memory->StrafeElapsedTime = 0.0f;
+
+	if (UStrafeComponent* StrafeComponent = Memory->StrafeComponent.Get())
 	{
+		AActor* Enemy = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(EnemyKey.GetSelectedKeyID()));
 		StrafeComponent->StrafeStart(Enemy);
 	}
 
 	return EBTNodeResult::InProgress;
 }
 
+EBTNodeResult::Type UBTT_Strafe::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FBTStrafeTaskMemory* Memory = (FBTStrafeTaskMemory*) NodeMemory;
+
+	if (UStrafeComponent* StrafeComponent = Memory->StrafeComponent.Get())
+	{
+		StrafeComponent->StrafeEnd();
+	}
+
+	return EBTNodeResult::Aborted;
+}
+
 void UBTT_Strafe::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
+	FBTStrafeTaskMemory* Memory = (FBTStrafeTaskMemory*) NodeMemory;
 	UBlackboardComponent* BlackboardComponent = OwnerComp.GetBlackboardComponent();
-	StrafeElapsedTime += DeltaSeconds;
+	UStrafeComponent* StrafeComponent = Memory->StrafeComponent.Get();
 
-	if (StrafeElapsedTime >= StrafeDuration)
-	{
-		StrafeElapsedTime = 0.0f;
+	Memory->StrafeElapsedTime += DeltaSeconds;
 
-		BlackboardComponent->SetValueAsBool(WantsAttackKey.SelectedKeyName, true);
+	// Enemies without an attack token keep circling. The coordinator sets their wants attack key when they get one.
+	if (Memory->StrafeElapsedTime >= StrafeDuration)
+	{
+		const UCombatCoordinatorSubsystem* CombatCoordinator = OwnerComp.GetWorld()->GetSubsystem<UCombatCoordinatorSubsystem>();
 
-		UStrafeComponent* StrafeComponent = OwnerComp.GetAIOwner()->GetPawn()->FindComponentByClass<UStrafeComponent>();
-		if (StrafeComponent)
+		if (CombatCoordinator && !CombatCoordinator->CanAttack(Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn())))
 		{
-			StrafeComponent->StrafeEnd();
+			Memory->StrafeElapsedTime = 0.0f;
 		}
-
-		OwnerComp.OnTaskFinished(this, EBTNodeResult::Succeeded);
 	}
-	else
+
+	if (Memory->StrafeElapsedTime >= StrafeDuration)
 	{
-		AActor* Enemy = Cast<AActor>(BlackboardComponent->GetValueAsObject(EnemyKey.SelectedKeyName));
-		UStrafeComponent* StrafeComponent = OwnerComp.GetAIOwner()->GetPawn()->FindComponentByClass<UStrafeComponent>();
+		BlackboardComponent->SetValue<UBlackboardKeyType_Bool>(WantsAttackKey.GetSelectedKeyID(), true);
 
 		if (StrafeComponent)
 		{
-			StrafeComponent->Strafe(Enemy);
+			StrafeComponent->StrafeEnd();
 		}
+
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
 	}
 }
@@ -5,8 +5,22 @@
 #include "BehaviorTree/BTTaskNode.h"
 #include "BTT_Strafe.generated.h"
 
+
+/*
+ * Memory of a strafe task, kept per AI by the behavior tree.
+ */
+struct FBTStrafeTaskMemory
+{
+	/** Strafe component of the AI's pawn. */
+	TWeakObjectPtr<class UStrafeComponent> StrafeComponent;
+
+	/** Time elapsed during strafing. */
+	float StrafeElapsedTime;
+};
+
 /**
   * Task that makes a character strafe around a point/enemy.
+  * The task isn't instanced: the state of each AI running it is kept in its node memory.
   */
 UCLASS()
 class ASCENSION_API UBTT_Strafe : public UBTTaskNode
@@ -26,17 +40,22 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Blackboard")
 	float StrafeDuration;
 
-	/** Time elapsed during strafing. */
-	UPROPERTY(VisibleAnywhere, Category = "Blackboard")
-	float StrafeElapsedTime = 0.0f;
-
 protected:
+	/** Resolves the blackboard keys of the task. */
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
 	/** Starts execution for the task. */
 	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 
-	/** Tick function. Updates every frame. */
+	/** Stops strafing when the task is aborted. */
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/** Tick function. Counts the strafe time, with the time since the last tick when the AI ticks at an interval. */
 	void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
 
+	/** Returns the size of the memory kept for each AI. */
+	virtual uint16 GetInstanceMemorySize() const override;
+
 public:
 	UBTT_Strafe();
 };
@@ -0,0 +1,13 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "EnemyAIController.h"
+#include "AI/ThrottledBehaviorTreeComponent.h"
+
+
+AEnemyAIController::AEnemyAIController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// RunBehaviorTree only creates a behavior tree component if the controller doesn't have one.
+	BrainComponent = CreateDefaultSubobject<UThrottledBehaviorTreeComponent>(TEXT("BrainComponent"));
+}
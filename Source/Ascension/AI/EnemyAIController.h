@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "AIController.h"
+#include "EnemyAIController.generated.h"
+
+
+/*
+ * Controller of enemies.
+ * Runs its behavior tree on a throttled behavior tree component, so the significance subsystem can lower how often
+ * the behavior trees of less significant enemies tick.
+ */
+UCLASS()
+class ASCENSION_API AEnemyAIController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AEnemyAIController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
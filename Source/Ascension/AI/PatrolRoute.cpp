@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "PatrolRoute.h"
+#include "NavigationSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Patrol Route Build"), STAT_PatrolRouteBuild, STATGROUP_Ascension);
+
+
+// Sets default values
+APatrolRoute::APatrolRoute()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+const TArray<FVector>* APatrolRoute::FindPathTo(const int32 PointIndex) const
+{
+	if (Legs.Num() == 0 || !Points.IsValidIndex(PointIndex))
+	{
+		return nullptr;
+	}
+
+	const FPatrolRouteLeg& Leg = Legs[(PointIndex + Legs.Num() - 1) % Legs.Num()];
+
+	// Paths waiting to be recalculated keep their old points, which may cross the changed navmesh.
+	if (Leg.PathPoints.Num() < 2 || !Leg.Path.IsValid() || !Leg.Path->IsUpToDate())
+	{
+		return nullptr;
+	}
+
+	return &Leg.PathPoints;
+}
+
+void APatrolRoute::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Legs.SetNum(Points.Num() > 1 ? Points.Num() : 0);
+
+	for (int32 LegIndex = 0; LegIndex < Legs.Num(); LegIndex++)
+	{
+		BuildLeg(LegIndex);
+	}
+
+	if (UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &APatrolRoute::OnNavigationGenerationFinished);
+	}
+}
+
+void APatrolRoute::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSystem->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &APatrolRoute::OnNavigationGenerationFinished);
+	}
+
+	for (FPatrolRouteLeg& Leg : Legs)
+	{
+		ReleaseLeg(Leg);
+	}
+
+	Legs.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APatrolRoute::BuildLeg(const int32 LegIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PatrolRouteBuild);
+
+	FPatrolRouteLeg& Leg = Legs[LegIndex];
+	ReleaseLeg(Leg);
+
+	const AActor* Start = Points[LegIndex];
+	const AActor* End = Points[(LegIndex + 1) % Points.Num()];
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSystem ? NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+	if (Start == nullptr || End == nullptr || NavData == nullptr)
+	{
+		return;
+	}
+
+	const FPathFindingQuery Query(this, *NavData, Start->GetActorLocation(), End->GetActorLocation());
+	const FPathFindingResult Result = NavSystem->FindPathSync(Query);
+
+	if (!Result.IsSuccessful() || Result.IsPartial())
+	{
+		return;
+	}
+
+	// The navigation data recalculates the path when tiles under it are rebuilt, and tells the observer.
+	Leg.Path = Result.Path;
+	Leg.Path->EnableRecalculationOnInvalidation(true);
+	Leg.ObserverHandle = Leg.Path->AddObserver(FNavigationPath::FPathObserverDelegate::FDelegate::CreateUObject(this, &APatrolRoute::OnLegPathEvent, LegIndex));
+
+	for (const FNavPathPoint& PathPoint : Leg.Path->GetPathPoints())
+	{
+		Leg.PathPoints.Add(PathPoint.Location);
+	}
+}
+
+void APatrolRoute::ReleaseLeg(FPatrolRouteLeg& Leg)
+{
+	if (Leg.Path.IsValid())
+	{
+		Leg.Path->RemoveObserver(Leg.ObserverHandle);
+		Leg.Path->EnableRecalculationOnInvalidation(false);
+		Leg.Path.Reset();
+	}
+
+	Leg.ObserverHandle.Reset();
+	Leg.PathPoints.Reset();
+}
+
+void APatrolRoute::OnLegPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event, int32 LegIndex)
+{
+	if (!Legs.IsValidIndex(LegIndex))
+	{
+		return;
+	}
+
+	FPatrolRouteLeg& Leg = Legs[LegIndex];
+
+	if (Event == ENavPathEvent::UpdatedDueToNavigationChanged && !Path->IsPartial())
+	{
+		Leg.PathPoints.Reset();
+
+		for (const FNavPathPoint& PathPoint : Path->GetPathPoints())
+		{
+			Leg.PathPoints.Add(PathPoint.Location);
+		}
+	}
+	else if (Event == ENavPathEvent::UpdatedDueToNavigationChanged || Event == ENavPathEvent::RePathFailed)
+	{
+		// Enemies find their own paths until navmesh generation finishes and the leg is found again.
+		Leg.PathPoints.Reset();
+	}
+}
+
+void APatrolRoute::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	for (int32 LegIndex = 0; LegIndex < Legs.Num(); LegIndex++)
+	{
+		if (Legs[LegIndex].PathPoints.Num() == 0)
+		{
+			BuildLeg(LegIndex);
+		}
+	}
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NavigationData.h"
+#include "PatrolRoute.generated.h"
+
+
+/*
+ * Leg of a patrol route, from one of its points to the next.
+ */
+struct FPatrolRouteLeg
+{
+	/** Path found from the point to the next, kept up to date by the navigation data. */
+	FNavPathSharedPtr Path;
+
+	/** Handle of the observer of the path. */
+	FDelegateHandle ObserverHandle;
+
+	/** Points of the path. Empty while no full path is found. */
+	TArray<FVector> PathPoints;
+};
+
+/*
+ * Route patrolled by enemies, looping through its points in order.
+ *
+ * The paths between consecutive points are found once when the route begins play and shared by every enemy on the
+ * route, so patrolling doesn't pathfind. The paths are registered with the navigation data, which recalculates only
+ * the paths crossing navmesh tiles that are rebuilt. Legs without a path are found again once navmesh generation
+ * finishes, and until then enemies patrolling them find their own paths.
+ */
+UCLASS()
+class ASCENSION_API APatrolRoute : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties.
+	APatrolRoute();
+
+	/** Gets the points of the route, in patrol order. */
+	UFUNCTION(BlueprintCallable, Category = "Patrol")
+	const TArray<AActor*>& GetPoints() const { return Points; }
+
+	/*
+	 * Gets the cached path leading to a point of the route from the point before it.
+	 * @param PointIndex		Index of the point.
+	 * @returns TArray<FVector>*	Points of the path. Null if no up to date path is cached.
+	 */
+	const TArray<FVector>* FindPathTo(const int32 PointIndex) const;
+
+protected:
+	// Called when the game starts or when spawned.
+	virtual void BeginPlay() override;
+
+	// Called when the actor exits play.
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/*
+	 * Finds the path of a leg.
+	 * @param LegIndex	Index of the leg, which is the index of its first point.
+	 */
+	void BuildLeg(const int32 LegIndex);
+
+	/*
+	 * Stops observing the path of a leg and clears it.
+	 * @param Leg	The leg.
+	 */
+	void ReleaseLeg(FPatrolRouteLeg& Leg);
+
+	/*
+	 * Called when the path of a leg is updated or invalidated by the navigation data.
+	 * @param Path		The path.
+	 * @param Event		What happened to the path.
+	 * @param LegIndex	Index of the leg.
+	 */
+	void OnLegPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event, int32 LegIndex);
+
+	/** Called when navmesh generation finishes, to find the paths of legs that have none. */
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+protected:
+	/** Points of the route, in patrol order. The last point leads back to the first. */
+	UPROPERTY(EditInstanceOnly, Category = "Patrol Points")
+	TArray<AActor*> Points;
+
+private:
+	/** Legs of the route, indexed by their first point. */
+	TArray<FPatrolRouteLeg> Legs;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "ThrottledBehaviorTreeComponent.h"
+
+
+UThrottledBehaviorTreeComponent::UThrottledBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	TickThrottle = 0.0f;
+	ThrottledDeltaTime = 0.0f;
+}
+
+void UThrottledBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	ThrottledDeltaTime += DeltaTime;
+
+	if (ThrottledDeltaTime < TickThrottle)
+	{
+		return;
+	}
+
+	// Ticking tasks and services get the whole time since the last tick, so timers keep running at the same speed.
+	const float TickDeltaTime = ThrottledDeltaTime;
+	ThrottledDeltaTime = 0.0f;
+
+	Super::TickComponent(TickDeltaTime, TickType, ThisTickFunction);
+}
+
+void UThrottledBehaviorTreeComponent::SetTickThrottle(const float Interval)
+{
+	// Tick on the next frame when the throttle is lowered, so a more significant AI reacts right away.
+	if (Interval < TickThrottle)
+	{
+		ThrottledDeltaTime = TickThrottle;
+	}
+
+	TickThrottle = FMath::Max(Interval, 0.0f);
+}
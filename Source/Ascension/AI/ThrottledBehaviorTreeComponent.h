@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "ThrottledBehaviorTreeComponent.generated.h"
+
+
+/*
+ * Behavior tree component that can be made to tick less often.
+ * The behavior tree schedules its own next tick and overwrites the component's tick interval, so the throttle is
+ * applied in TickComponent instead: ticks are skipped until the throttle interval has passed, and the tree then ticks
+ * once with the time accumulated since its last tick.
+ */
+UCLASS()
+class ASCENSION_API UThrottledBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+	GENERATED_BODY()
+
+public:
+	UThrottledBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	// Called every frame.
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/*
+	 * Sets the minimum time between ticks of the behavior tree.
+	 * @param Interval	Time in seconds. The tree ticks whenever it asks to if 0.
+	 */
+	void SetTickThrottle(const float Interval);
+
+	/** Returns the minimum time between ticks of the behavior tree. */
+	FORCEINLINE float GetTickThrottle() const { return TickThrottle; }
+
+private:
+	/** Minimum time between ticks of the behavior tree. */
+	float TickThrottle;
+
+	/** Time since the behavior tree last ticked. */
+	float ThrottledDeltaTime;
+};
@@ -9,6 +9,9 @@ UAbility::UAbility()
 {
 	AbilityName = FString("Ability");
 	AbilityID = 0;
+	Cooldown = 0.0f;
+	MaxCharges = 1;
+	StaminaCost = 0.0f;
 	AbilitySystem = nullptr;
 }
 
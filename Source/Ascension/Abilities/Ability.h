@@ -34,6 +34,24 @@ public:
 	UPROPERTY(Category = Properties, EditDefaultsOnly, BlueprintReadWrite)
 	uint8 AbilityID;
 
+	/*
+	 * Time in seconds taken to restore a charge of the ability after it is used.
+	 */
+	UPROPERTY(Category = Cost, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0, UIMin = 0))
+	float Cooldown;
+
+	/*
+	 * Maximum number of charges of the ability that can be stored.
+	 */
+	UPROPERTY(Category = Cost, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 1, UIMin = 1))
+	uint8 MaxCharges;
+
+	/*
+	 * Stamina consumed when the ability is activated.
+	 */
+	UPROPERTY(Category = Cost, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0, UIMin = 0))
+	float StaminaCost;
+
 protected:
 	/*
 	 * Movement parameters for the ability.
@@ -71,6 +89,12 @@ public:
 	FCustomMovementParams GetMovementParams() const;
 	virtual FCustomMovementParams GetMovementParams_Implementation() const;
 
+	/*
+	 * Gets the animation montage played by the ability.
+	 * @returns UAnimMontage*	Montage of the ability. Null if the ability doesn't play a montage.
+	 */
+	virtual class UAnimMontage* GetAnimMontage() const { return nullptr; }
+
 protected:
 	// TODO: Find a better way to initialize this.
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Properties)
@@ -15,3 +15,62 @@ class ASCENSION_API UAbilityGlobals : public UObject
 	GENERATED_BODY()
 	
 };
+
+/*
+ * Cooldown, charge and cost state of an ability registered with an ability system.
+ * Every constraint is stored as a timestamp so that checking it is a single comparison against the current time.
+ */
+struct FAbilityCostState
+{
+	FAbilityCostState()
+		: ReadyTime(-MAX_FLT)
+		, Cooldown(0.0f)
+		, ChargeSpan(0.0f)
+		, StaminaTime(0.0f)
+		, MaxCharges(1)
+		, bCostAboveMaxStamina(false)
+	{}
+
+	/** Time at which at least one charge of the ability is available. */
+	float ReadyTime;
+
+	/** Time taken to restore a single charge. */
+	float Cooldown;
+
+	/** Time taken to restore every charge except the first, i.e. (MaxCharges - 1) * Cooldown. */
+	float ChargeSpan;
+
+	/** Stamina cost of the ability, expressed as the time taken to regenerate that much stamina. */
+	float StaminaTime;
+
+	/** Maximum number of charges that can be stored. */
+	uint8 MaxCharges;
+
+	/** Whether the stamina cost is above the maximum stamina, so the ability can never be paid for. */
+	bool bCostAboveMaxStamina;
+};
+
+/*
+ * Struct describing the cooldown state of an ability, used to query cooldowns in bulk.
+ */
+USTRUCT(BlueprintType)
+struct FAbilityCooldownInfo
+{
+	GENERATED_BODY()
+
+	/** Name of the ability. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cooldown")
+	FString AbilityName;
+
+	/** Time in seconds until the ability can be activated again. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cooldown")
+	float RemainingTime = 0.0f;
+
+	/** Number of charges currently available. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cooldown")
+	int32 Charges = 0;
+
+	/** Maximum number of charges that can be stored. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cooldown")
+	int32 MaxCharges = 0;
+};
@@ -4,6 +4,7 @@
 #include "GameAbilitySystemComponent.h"
 #include "UObject/UObjectGlobals.h"
 #include "Abilities/Ability.h"
+#include "Components/StateTimelineComponent.h"
 
 // Sets default values for this component's properties
 UGameAbilitySystemComponent::UGameAbilitySystemComponent()
@@ -15,6 +16,12 @@ UGameAbilitySystemComponent::UGameAbilitySystemComponent()
 	ClearAbilities();
 	NextAbilityID = 0;
 	Owner = GetOwner();
+	StateTimeline = nullptr;
+
+	// Stamina starts full.
+	MaxStamina = 100.0f;
+	StaminaRegenRate = 20.0f;
+	StaminaEmptyTime = -MAX_FLT;
 }
 
 
@@ -22,6 +29,14 @@ UGameAbilitySystemComponent::UGameAbilitySystemComponent()
 void UGameAbilitySystemComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	StateTimeline = GetOwner()->FindComponentByClass<UStateTimelineComponent>();
+
+	// Abilities assigned through the editor don't go through AddAbility, so make sure they have a slot.
+	for (auto& Pair : AbilitiesMap)
+	{
+		RegisterAbilitySlot(Pair.Key, Pair.Value);
+	}
 }
 
 
@@ -76,6 +91,7 @@ void UGameAbilitySystemComponent::AddAbility(const FString& AbilityName, TSubcla
 	if (!AbilitiesMap.Contains(AbilityName))
 	{
 		AbilitiesMap.Add(AbilityName, Ability);
+		RegisterAbilitySlot(AbilityName, Ability);
 	}
 }
 
@@ -84,10 +100,30 @@ void UGameAbilitySystemComponent::ClearAbilities()
 	AbilitiesMap.Empty();
 	ActiveAbilitiesMap.Empty();
 	ActiveAbilityNameIDsMap.Empty();
+	AbilityCostStates.Empty();
+	AbilitySlotMap.Empty();
 }
 
 bool UGameAbilitySystemComponent::CanActivateAbility(const FString& AbilityName)
 {
+	const int32* Slot = AbilitySlotMap.Find(AbilityName);
+
+	if (Slot != nullptr)
+	{
+		const FAbilityCostState& CostState = AbilityCostStates[*Slot];
+
+		// Waiting for stamina would never help, so fail straight away.
+		if (CostState.bCostAboveMaxStamina)
+		{
+			return false;
+		}
+
+		const float CurrentTime = GetWorld()->GetTimeSeconds();
+
+		// Each constraint is a single comparison against the current time.
+		return (CurrentTime >= CostState.ReadyTime) && (CurrentTime >= StaminaEmptyTime + CostState.StaminaTime);
+	}
+
 	return true;
 }
 
@@ -99,6 +135,12 @@ bool UGameAbilitySystemComponent::ActivateAbility(const FString& AbilityName, ui
 	{
 		if (CanActivateAbility(AbilityName))
 		{
+			const int32 Slot = GetAbilitySlot(AbilityName);
+			if (Slot != INDEX_NONE)
+			{
+				CommitAbilityCost(Slot, GetWorld()->GetTimeSeconds());
+			}
+
 			UAbility* Ability = NewObject<UAbility>(this, AbilityClass);
 			uint8 AbilityID = NextAbilityID++;
 			Ability->Initialize(AbilityName, AbilityID, this);
@@ -113,6 +155,7 @@ bool UGameAbilitySystemComponent::ActivateAbility(const FString& AbilityName, ui
 			ActiveAbilityNameIDsMap[AbilityName].Add(AbilityID);
 
 			ActivatedAbilityID = AbilityID;
+			RecordAbilityEvent(AbilityName, true);
 			return true;
 		}
 	}
@@ -124,6 +167,8 @@ void UGameAbilitySystemComponent::FinishAbility(const FString& AbilityName = FSt
 {
 	if (!AbilityName.Equals(FString("")))
 	{
+		RecordAbilityEvent(AbilityName, false);
+
 		if (ActiveAbilityNameIDsMap.Contains(AbilityName))
 		{
 			TArray<uint8> IDs = ActiveAbilityNameIDsMap[AbilityName];
@@ -149,6 +194,7 @@ void UGameAbilitySystemComponent::FinishAbility(const FString& AbilityName = FSt
 	else if (ActiveAbilitiesMap.Contains(AbilityID))
 	{
 		FString Name = ActiveAbilitiesMap[AbilityID]->AbilityName;
+		RecordAbilityEvent(Name, false);
 		ActiveAbilitiesMap[AbilityID]->Finish();
 		ActiveAbilitiesMap.Remove(AbilityID);
 
@@ -162,6 +208,118 @@ void UGameAbilitySystemComponent::FinishAbility(const FString& AbilityName = FSt
 	}
 }
 
+float UGameAbilitySystemComponent::GetStamina() const
+{
+	const float Stamina = (GetWorld()->GetTimeSeconds() - StaminaEmptyTime) * StaminaRegenRate;
+	return FMath::Min(Stamina, MaxStamina);
+}
+
+void UGameAbilitySystemComponent::GetAbilityCooldowns(TArray<FAbilityCooldownInfo>& CooldownInfos) const
+{
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	CooldownInfos.SetNum(AbilityCostStates.Num());
+
+	for (auto& Pair : AbilitySlotMap)
+	{
+		CooldownInfos[Pair.Value].AbilityName = Pair.Key;
+		FillCooldownInfo(Pair.Value, CurrentTime, CooldownInfos[Pair.Value]);
+	}
+}
+
+bool UGameAbilitySystemComponent::GetAbilityCooldown(const FString& AbilityName, FAbilityCooldownInfo& CooldownInfo) const
+{
+	const int32 Slot = GetAbilitySlot(AbilityName);
+
+	if (Slot != INDEX_NONE)
+	{
+		CooldownInfo.AbilityName = AbilityName;
+		FillCooldownInfo(Slot, GetWorld()->GetTimeSeconds(), CooldownInfo);
+		return true;
+	}
+
+	return false;
+}
+
+int32 UGameAbilitySystemComponent::GetAbilitySlot(const FString& AbilityName) const
+{
+	const int32* Slot = AbilitySlotMap.Find(AbilityName);
+	return Slot != nullptr ? *Slot : INDEX_NONE;
+}
+
+TSubclassOf<UAbility> UGameAbilitySystemComponent::GetAbilityInSlot(const int32 Slot) const
+{
+	for (const auto& Pair : AbilitySlotMap)
+	{
+		if (Pair.Value == Slot)
+		{
+			return GetAbility(Pair.Key);
+		}
+	}
+
+	return nullptr;
+}
+
+void UGameAbilitySystemComponent::RecordAbilityEvent(const FString& AbilityName, const bool bActivated) const
+{
+#if WITH_STATE_TIMELINE
+	if (StateTimeline && UStateTimelineComponent::RecordEvents)
+	{
+		// Abilities are recorded by slot and named on export.
+		StateTimeline->Record(bActivated ? EStateTimelineChannel::AbilityActivated : EStateTimelineChannel::AbilityFinished, 0,
+							  (uint16) GetAbilitySlot(AbilityName));
+	}
+#endif
+}
+
+void UGameAbilitySystemComponent::RegisterAbilitySlot(const FString& AbilityName, TSubclassOf<UAbility> Ability)
+{
+	if (Ability == nullptr || AbilitySlotMap.Contains(AbilityName))
+	{
+		return;
+	}
+
+	// Costs are read once from the class defaults so that activation checks never touch the ability object.
+	const UAbility* AbilityDefaults = Ability->GetDefaultObject<UAbility>();
+	FAbilityCostState CostState = FAbilityCostState();
+	CostState.MaxCharges = FMath::Max<uint8>(AbilityDefaults->MaxCharges, 1);
+	CostState.Cooldown = AbilityDefaults->Cooldown;
+	CostState.ChargeSpan = (CostState.MaxCharges - 1) * CostState.Cooldown;
+	CostState.StaminaTime = AbilityDefaults->StaminaCost / FMath::Max(StaminaRegenRate, KINDA_SMALL_NUMBER);
+	CostState.bCostAboveMaxStamina = AbilityDefaults->StaminaCost > MaxStamina;
+
+	AbilitySlotMap.Add(AbilityName, AbilityCostStates.Add(CostState));
+}
+
+void UGameAbilitySystemComponent::CommitAbilityCost(int32 Slot, float CurrentTime)
+{
+	FAbilityCostState& CostState = AbilityCostStates[Slot];
+
+	// Charges are restored one after another, so consuming one pushes the time at which every charge is available
+	// back by a cooldown. ReadyTime trails that time by the span of the remaining charges.
+	CostState.ReadyTime = FMath::Max(CostState.ReadyTime, CurrentTime - CostState.ChargeSpan) + CostState.Cooldown;
+
+	// Stamina can't regenerate above the maximum, so clamp the empty time before consuming.
+	const float MaxStaminaTime = MaxStamina / FMath::Max(StaminaRegenRate, KINDA_SMALL_NUMBER);
+	StaminaEmptyTime = FMath::Max(StaminaEmptyTime, CurrentTime - MaxStaminaTime) + CostState.StaminaTime;
+}
+
+void UGameAbilitySystemComponent::FillCooldownInfo(int32 Slot, float CurrentTime, FAbilityCooldownInfo& CooldownInfo) const
+{
+	const FAbilityCostState& CostState = AbilityCostStates[Slot];
+	CooldownInfo.MaxCharges = CostState.MaxCharges;
+	CooldownInfo.RemainingTime = FMath::Max(CostState.ReadyTime - CurrentTime, 0.0f);
+
+	if (CostState.Cooldown > 0.0f)
+	{
+		const float TimeUntilFull = FMath::Max(CostState.ReadyTime + CostState.ChargeSpan - CurrentTime, 0.0f);
+		CooldownInfo.Charges = CostState.MaxCharges - FMath::CeilToInt(TimeUntilFull / CostState.Cooldown);
+	}
+	else
+	{
+		CooldownInfo.Charges = CostState.MaxCharges;
+	}
+}
+
 void UGameAbilitySystemComponent::PrintActiveAbilities() const
 {
 	FString AbilityIDsString = FString("Ability IDs: ");
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Abilities/AbilityGlobals.h"
 #include "GameAbilitySystemComponent.generated.h"
 
 
@@ -56,6 +57,37 @@ protected:
 	UPROPERTY(Category = Abilities, VisibleAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"))
 	uint8 NextAbilityID;
 
+	/*
+	 * Cooldown, charge and cost state of each registered ability, indexed by ability slot.
+	 */
+	TArray<FAbilityCostState> AbilityCostStates;
+
+	/*
+	 * Map of ability names to their slot in AbilityCostStates.
+	 */
+	TMap<FString, int32> AbilitySlotMap;
+
+	/*
+	 * State timeline of the owner.
+	 */
+	UPROPERTY(Transient)
+	class UStateTimelineComponent* StateTimeline;
+
+protected:
+	/** Maximum stamina of the entity. */
+	UPROPERTY(Category = Stamina, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0, UIMin = 0))
+	float MaxStamina;
+
+	/** Stamina regenerated per second. */
+	UPROPERTY(Category = Stamina, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0.01, UIMin = 0.01))
+	float StaminaRegenRate;
+
+	/*
+	 * Time at which stamina was (or would have been) empty, assuming continuous regeneration since then.
+	 * Current stamina is derived from this, so stamina never needs to be ticked.
+	 */
+	float StaminaEmptyTime;
+
 public:
 	/*
 	 * Function to get an ability.
@@ -109,6 +141,80 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Abilities")
 	virtual void FinishAbility(const FString& AbilityName, const uint8& AbilityID);
 
+	/*
+	 * Function to get the current stamina of the entity.
+	 * @returns float	Current stamina.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Stamina")
+	float GetStamina() const;
+
+	/*
+	 * Function to get the cooldown state of every registered ability in one call.
+	 * @param CooldownInfos		Array filled with the cooldown state of each ability.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Abilities")
+	void GetAbilityCooldowns(TArray<FAbilityCooldownInfo>& CooldownInfos) const;
+
+	/*
+	 * Function to get the cooldown state of an ability.
+	 * @param AbilityName	Name of the ability.
+	 * @param CooldownInfo	Cooldown state of the ability.
+	 * @returns bool		Whether the ability is registered with the system.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Abilities")
+	bool GetAbilityCooldown(const FString& AbilityName, FAbilityCooldownInfo& CooldownInfo) const;
+
+	/*
+	 * Function to get the raw cost state of every registered ability, indexed by ability slot.
+	 * Used by native systems (e.g. AI) that poll many abilities at once.
+	 */
+	FORCEINLINE const TArray<FAbilityCostState>& GetAbilityCostStates() const { return AbilityCostStates; }
+
+	/*
+	 * Function to get the slot of an ability.
+	 * @param AbilityName	Name of the ability.
+	 * @returns int32		Slot of the ability, INDEX_NONE if the ability is not registered.
+	 */
+	int32 GetAbilitySlot(const FString& AbilityName) const;
+
+	/*
+	 * Function to get the class of the ability in a slot.
+	 * @param Slot						Slot of the ability.
+	 * @returns TSubclassOf<UAbility>	Class of the ability, null if no ability is registered in the slot.
+	 */
+	TSubclassOf<UAbility> GetAbilityInSlot(const int32 Slot) const;
+
+protected:
+	/*
+	 * Registers the cooldown and cost data of an ability class into a slot.
+	 * @param AbilityName	Name of the ability.
+	 * @param Ability		Class of the ability.
+	 */
+	void RegisterAbilitySlot(const FString& AbilityName, TSubclassOf<UAbility> Ability);
+
+	/*
+	 * Records the activation or end of an ability in the owner's state timeline.
+	 * @param AbilityName	Name of the ability.
+	 * @param bActivated	Whether the ability was activated, otherwise it finished.
+	 */
+	void RecordAbilityEvent(const FString& AbilityName, const bool bActivated) const;
+
+	/*
+	 * Consumes a charge and the stamina cost of an ability.
+	 * @param Slot			Slot of the ability.
+	 * @param CurrentTime	Current world time.
+	 */
+	void CommitAbilityCost(int32 Slot, float CurrentTime);
+
+	/*
+	 * Fills the cooldown info of an ability slot.
+	 * @param Slot			Slot of the ability.
+	 * @param CurrentTime	Current world time.
+	 * @param CooldownInfo	Cooldown info to fill.
+	 */
+	void FillCooldownInfo(int32 Slot, float CurrentTime, FAbilityCooldownInfo& CooldownInfo) const;
+
+public:
 	/*
 	 * Method to print active abilities and their IDs.
 	 */
@@ -0,0 +1,288 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+ * Kinds of actions tracked by components performing abilities.
+ */
+enum class EActionKind : uint8
+{
+	Attack,
+	Dodge
+};
+
+/*
+ * Tracks the active actions of a component by ability ID, and by the definition (ability name) they were activated
+ * from. Actions of each definition are kept in activation order, so the oldest action of a definition can be found
+ * without searching.
+ *
+ * Active actions are stored densely in an inline array, and an ID to slot table gives constant time lookups, so
+ * adding, removing and finding actions never searches or allocates while fewer than InlineCapacity actions are active.
+ *
+ * @param Kind				Kind of action tracked.
+ * @param InlineCapacity	Number of active actions stored without allocating.
+ */
+template <EActionKind Kind, int32 InlineCapacity = 4>
+class TActionTracker
+{
+public:
+	/** Kind of action tracked. */
+	static constexpr EActionKind ActionKind = Kind;
+
+	TActionTracker()
+	{
+		Reset();
+	}
+
+	/*
+	 * Adds an active action.
+	 * @param Definition	Name of the ability the action was activated from.
+	 * @param ID			ID of the action.
+	 * @returns bool		Whether the action was added. False if an action with the ID is already active.
+	 */
+	bool Add(const FName Definition, const uint8 ID)
+	{
+		if (Contains(ID))
+		{
+			return false;
+		}
+
+		const int16 DefinitionIndex = FindOrAddDefinition(Definition);
+		const int16 Slot = (int16) Slots.Num();
+
+		FSlot& NewSlot = Slots.AddDefaulted_GetRef();
+		NewSlot.ID = ID;
+		NewSlot.Definition = DefinitionIndex;
+		NewSlot.Prev = Tails[DefinitionIndex];
+		NewSlot.Next = INDEX_NONE;
+
+		// Append to the activation order of the definition.
+		if (Tails[DefinitionIndex] != INDEX_NONE)
+		{
+			Slots[Tails[DefinitionIndex]].Next = Slot;
+		}
+		else
+		{
+			Heads[DefinitionIndex] = Slot;
+		}
+
+		Tails[DefinitionIndex] = Slot;
+		SlotOfID[ID] = Slot;
+
+		return true;
+	}
+
+	/*
+	 * Removes an active action.
+	 * @param ID		ID of the action.
+	 * @returns bool	Whether the action was active.
+	 */
+	bool Remove(const uint8 ID)
+	{
+		const int16 Slot = SlotOfID[ID];
+
+		if (Slot == INDEX_NONE)
+		{
+			return false;
+		}
+
+		Unlink(Slot);
+		SlotOfID[ID] = INDEX_NONE;
+
+		// Keep the slots dense by moving the last slot into the hole.
+		const int16 LastSlot = (int16) (Slots.Num() - 1);
+
+		if (Slot != LastSlot)
+		{
+			const FSlot& Moved = Slots[LastSlot];
+			Slots[Slot] = Moved;
+			SlotOfID[Moved.ID] = Slot;
+
+			if (Moved.Prev != INDEX_NONE)
+			{
+				Slots[Moved.Prev].Next = Slot;
+			}
+			else
+			{
+				Heads[Moved.Definition] = Slot;
+			}
+
+			if (Moved.Next != INDEX_NONE)
+			{
+				Slots[Moved.Next].Prev = Slot;
+			}
+			else
+			{
+				Tails[Moved.Definition] = Slot;
+			}
+		}
+
+		Slots.Pop(false);
+		return true;
+	}
+
+	/*
+	 * Checks whether an action is active.
+	 * @param ID	ID of the action.
+	 */
+	FORCEINLINE bool Contains(const uint8 ID) const
+	{
+		return SlotOfID[ID] != INDEX_NONE;
+	}
+
+	/*
+	 * Finds the oldest active action of a definition.
+	 * @param Definition	Name of the ability.
+	 * @returns int32		ID of the action. INDEX_NONE if no action of the definition is active.
+	 */
+	int32 FindFirst(const FName Definition) const
+	{
+		const int32 DefinitionIndex = Definitions.IndexOfByKey(Definition);
+
+		if (DefinitionIndex == INDEX_NONE || Heads[DefinitionIndex] == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+
+		return Slots[Heads[DefinitionIndex]].ID;
+	}
+
+	/*
+	 * Resolves the action meant by a definition and ID, the way components finish actions.
+	 * With a definition, the action with the ID if it belongs to the definition, or else the oldest action of the
+	 * definition. Without a definition, the action with the ID.
+	 * @param Definition	Name of the ability. None to only use the ID.
+	 * @param ID			ID of the action.
+	 * @returns int32		ID of the action. INDEX_NONE if no action matches.
+	 */
+	int32 Resolve(const FName Definition, const uint8 ID) const
+	{
+		if (Definition.IsNone())
+		{
+			return Contains(ID) ? ID : INDEX_NONE;
+		}
+
+		if (Contains(ID) && Definitions[Slots[SlotOfID[ID]].Definition] == Definition)
+		{
+			return ID;
+		}
+
+		return FindFirst(Definition);
+	}
+
+	/*
+	 * Checks whether an action of a definition has ever been added.
+	 * @param Definition	Name of the ability.
+	 */
+	FORCEINLINE bool IsKnownDefinition(const FName Definition) const
+	{
+		return Definitions.Contains(Definition);
+	}
+
+	/*
+	 * Gets the definition of an active action.
+	 * @param ID		ID of the action.
+	 * @returns FName	Name of the ability. None if the action isn't active.
+	 */
+	FORCEINLINE FName GetDefinition(const uint8 ID) const
+	{
+		return Contains(ID) ? Definitions[Slots[SlotOfID[ID]].Definition] : NAME_None;
+	}
+
+	/*
+	 * Returns the number of active actions.
+	 */
+	FORCEINLINE int32 Num() const
+	{
+		return Slots.Num();
+	}
+
+	/*
+	 * Gets the ID of the action in a slot, to iterate over the active actions. Slots are in no particular order.
+	 * @param Slot	Index of the slot, below Num().
+	 */
+	FORCEINLINE uint8 GetIDAt(const int32 Slot) const
+	{
+		return Slots[Slot].ID;
+	}
+
+	/*
+	 * Removes every action and definition.
+	 */
+	void Reset()
+	{
+		Slots.Reset();
+		Definitions.Reset();
+		Heads.Reset();
+		Tails.Reset();
+		FMemory::Memset(SlotOfID, 0xFF, sizeof(SlotOfID));
+	}
+
+private:
+	/*
+	 * Slot holding an active action, linked to the other actions of its definition.
+	 */
+	struct FSlot
+	{
+		uint8 ID;
+		int16 Definition;
+		int16 Prev;
+		int16 Next;
+	};
+
+	/** Finds the index of a definition, adding it if necessary. */
+	int16 FindOrAddDefinition(const FName Definition)
+	{
+		int32 DefinitionIndex = Definitions.IndexOfByKey(Definition);
+
+		if (DefinitionIndex == INDEX_NONE)
+		{
+			DefinitionIndex = Definitions.Add(Definition);
+			Heads.Add(INDEX_NONE);
+			Tails.Add(INDEX_NONE);
+		}
+
+		return (int16) DefinitionIndex;
+	}
+
+	/** Unlinks a slot from the activation order of its definition. */
+	void Unlink(const int16 Slot)
+	{
+		const FSlot& Removed = Slots[Slot];
+
+		if (Removed.Prev != INDEX_NONE)
+		{
+			Slots[Removed.Prev].Next = Removed.Next;
+		}
+		else
+		{
+			Heads[Removed.Definition] = Removed.Next;
+		}
+
+		if (Removed.Next != INDEX_NONE)
+		{
+			Slots[Removed.Next].Prev = Removed.Prev;
+		}
+		else
+		{
+			Tails[Removed.Definition] = Removed.Prev;
+		}
+	}
+
+private:
+	/** Active actions. */
+	TArray<FSlot, TInlineAllocator<InlineCapacity>> Slots;
+
+	/** Slot of each active ID. INDEX_NONE for inactive IDs. */
+	int16 SlotOfID[256];
+
+	/** Definitions actions have been added for. */
+	TArray<FName, TInlineAllocator<4>> Definitions;
+
+	/** Slot of the oldest and newest active action of each definition. */
+	TArray<int16, TInlineAllocator<4>> Heads;
+	TArray<int16, TInlineAllocator<4>> Tails;
+};
@@ -3,12 +3,59 @@
 #include "Ascension.h"
 #include "Attack.h"
 #include "Abilities/AbilitySystems/GameAbilitySystemComponent.h"
+#include "Animation/AnimMontage.h"
+#include "Animation/AnimSequence.h"
+#include "Engine/SkeletalMeshSocket.h"
+
+
+#if WITH_EDITOR
+/*
+ * Gets the component space transform of a bone of a sequence, walking up the bone's parent chain.
+ * Bones without animation use the reference pose. The root is kept at its reference pose when the sequence uses root
+ * motion, as the root motion is applied to the actor at runtime.
+ * @param Sequence		Sequence to sample, or null for the reference pose.
+ * @param Skeleton		Skeleton of the sequence.
+ * @param Time			Time in the sequence.
+ * @param BoneIndex		Index of the bone in the skeleton.
+ * @returns FTransform	Transform of the bone in component space.
+ */
+static FTransform GetComponentSpaceBoneTransform(const UAnimSequence* Sequence, const USkeleton* Skeleton, const float Time, const int32 BoneIndex)
+{
+	const FReferenceSkeleton& ReferenceSkeleton = Skeleton->GetReferenceSkeleton();
+	FTransform ComponentTransform = FTransform::Identity;
+
+	for (int32 Index = BoneIndex; Index != INDEX_NONE; Index = ReferenceSkeleton.GetParentIndex(Index))
+	{
+		FTransform LocalTransform = ReferenceSkeleton.GetRefBonePose()[Index];
+		const bool bLockedRoot = Index == 0 && Sequence && Sequence->bEnableRootMotion;
+
+		if (Sequence && !bLockedRoot)
+		{
+			const int32 TrackIndex = Skeleton->GetRawAnimationTrackIndex(Index, Sequence);
+
+			if (TrackIndex != INDEX_NONE)
+			{
+				Sequence->GetBoneTransform(LocalTransform, TrackIndex, Time, true);
+			}
+		}
+
+		ComponentTransform = ComponentTransform * LocalTransform;
+	}
+
+	return ComponentTransform;
+}
+#endif
 
 
 UAttack::UAttack()
 	: Super()
 {
 	AnimMontage = nullptr;
+	HitWindowNotifyName = FName("HitWindow");
+
+#if WITH_EDITORONLY_DATA
+	TrajectoryMesh = nullptr;
+#endif
 }
 
 void UAttack::Activate()
@@ -24,3 +71,108 @@ FAttackEffectInfo UAttack::GetEffectInfo() const
 {
 	return EffectInfo;
 }
+
+void UAttack::BakeTrajectory()
+{
+#if WITH_EDITOR
+	Trajectory.Samples.Reset();
+	Trajectory.NumSockets = 0;
+	Trajectory.StartTime = 0.0f;
+	Trajectory.EndTime = 0.0f;
+
+	if (AnimMontage == nullptr || AnimMontage->SlotAnimTracks.Num() == 0 || TrajectorySocketNames.Num() == 0)
+	{
+		return;
+	}
+
+	const USkeleton* Skeleton = AnimMontage->GetSkeleton();
+
+	if (Skeleton == nullptr)
+	{
+		return;
+	}
+
+	// Resolve each socket to the bone it is attached to.
+	const FReferenceSkeleton& ReferenceSkeleton = Skeleton->GetReferenceSkeleton();
+	TArray<int32, TInlineAllocator<4>> SocketBones;
+	TArray<FTransform, TInlineAllocator<4>> SocketTransforms;
+
+	for (const FName& SocketName : TrajectorySocketNames)
+	{
+		const USkeletalMeshSocket* Socket = TrajectoryMesh ? TrajectoryMesh->FindSocket(SocketName) : nullptr;
+		Socket = Socket ? Socket : Skeleton->FindSocket(SocketName);
+
+		const int32 BoneIndex = ReferenceSkeleton.FindBoneIndex(Socket ? Socket->BoneName : SocketName);
+
+		if (BoneIndex == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: Trajectory socket %s not found, trajectory not baked."), *GetName(), *SocketName.ToString())
+			return;
+		}
+
+		SocketBones.Add(BoneIndex);
+		SocketTransforms.Add(Socket ? Socket->GetSocketLocalTransform() : FTransform::Identity);
+	}
+
+	// Only the hit window needs to be baked.
+	float StartTime = 0.0f;
+	float EndTime = AnimMontage->GetPlayLength();
+
+	for (const FAnimNotifyEvent& Notify : AnimMontage->Notifies)
+	{
+		if (Notify.NotifyStateClass && (Notify.NotifyName == HitWindowNotifyName || Notify.NotifyStateClass->GetNotifyName() == HitWindowNotifyName.ToString()))
+		{
+			StartTime = Notify.GetTriggerTime();
+			EndTime = Notify.GetEndTriggerTime();
+			break;
+		}
+	}
+
+	const FAnimTrack& AnimTrack = AnimMontage->SlotAnimTracks[0].AnimTrack;
+	const int32 NumSamples = FMath::FloorToInt((EndTime - StartTime) * Trajectory.SampleRate) + 1;
+	Trajectory.Samples.Reserve(NumSamples * SocketBones.Num());
+
+	for (int32 Sample = 0; Sample < NumSamples; Sample++)
+	{
+		const float Position = FMath::Min(StartTime + Sample / Trajectory.SampleRate, EndTime);
+		const FAnimSegment* Segment = AnimTrack.GetSegmentAtTime(Position);
+		const UAnimSequence* Sequence = Segment ? Cast<UAnimSequence>(Segment->AnimReference) : nullptr;
+		const float SequenceTime = Segment ? Segment->ConvertTrackPosToAnimPos(Position) : 0.0f;
+
+		for (int32 Socket = 0; Socket < SocketBones.Num(); Socket++)
+		{
+			const FTransform BoneTransform = GetComponentSpaceBoneTransform(Sequence, Skeleton, SequenceTime, SocketBones[Socket]);
+			Trajectory.Samples.Add((SocketTransforms[Socket] * BoneTransform).GetLocation());
+		}
+	}
+
+	Trajectory.NumSockets = SocketBones.Num();
+	Trajectory.StartTime = StartTime;
+	Trajectory.EndTime = EndTime;
+#endif
+}
+
+#if WITH_EDITOR
+void UAttack::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	BakeTrajectory();
+}
+
+void UAttack::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.GetPropertyName();
+
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(UAttack, AnimMontage) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(UAttack, TrajectorySocketNames) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(UAttack, HitWindowNotifyName) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(UAttack, TrajectoryMesh) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(FAttackTrajectory, SampleRate))
+	{
+		BakeTrajectory();
+	}
+}
+#endif
@@ -41,10 +41,60 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Effects")
 	FAttackEffectInfo EffectInfo;
 
+	/*
+	 * Weapon sockets whose path through the montage is baked into the trajectory.
+	 * Socket names are looked up on the trajectory mesh if set, then on the montage's skeleton, then as bone names.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Trajectory")
+	TArray<FName> TrajectorySocketNames;
+
+	/*
+	 * Name of the notify state marking the hit window of the montage. Only the hit window is baked.
+	 * If the montage has no such notify, the whole montage is baked.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Trajectory")
+	FName HitWindowNotifyName;
+
+	/*
+	 * Path of the weapon sockets during the hit window, baked when the attack is saved.
+	 * Replayed by hit detection so that no bone transforms need to be evaluated for the query.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Trajectory")
+	FAttackTrajectory Trajectory;
+
+#if WITH_EDITORONLY_DATA
+	/** Mesh holding the weapon sockets, if they aren't skeleton sockets. */
+	UPROPERTY(EditDefaultsOnly, Category = "Trajectory")
+	class USkeletalMesh* TrajectoryMesh;
+#endif
+
 public:
 	/*
 	 * Gets the effect info of the attack.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Getters")
 	FAttackEffectInfo GetEffectInfo() const;
+
+	/*
+	 * Gets the animation montage of the attack.
+	 */
+	virtual UAnimMontage* GetAnimMontage() const override { return AnimMontage; }
+
+	/*
+	 * Gets the baked weapon trajectory of the attack.
+	 */
+	FORCEINLINE const FAttackTrajectory& GetTrajectory() const { return Trajectory; }
+
+	/*
+	 * Samples the path of the trajectory sockets through the hit window of the montage.
+	 * Called automatically when the attack is saved or cooked.
+	 */
+	UFUNCTION(CallInEditor, Category = "Trajectory")
+	void BakeTrajectory();
+
+#if WITH_EDITOR
+	/* UObject functions. */
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 };
@@ -62,3 +62,56 @@ struct FAttackEffectInfo
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
 	FAttackEffect AttackEffect;
 };
+
+/*
+ * Struct containing the baked path of the weapon sockets of an attack.
+ * Socket locations are sampled at a fixed rate over the hit window of the attack's montage and stored in the space of
+ * the skeletal mesh component, so the path can be replayed without evaluating the skeleton.
+ */
+USTRUCT(BlueprintType)
+struct FAttackTrajectory
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of samples taken per second of montage time.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Variables", meta = (ClampMin = 1, UIMin = 1))
+	float SampleRate = 30.0f;
+
+	// Montage position of the first sample.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Variables")
+	float StartTime = 0.0f;
+
+	// Montage position of the last sample.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Variables")
+	float EndTime = 0.0f;
+
+	// Number of sockets sampled.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Variables")
+	int32 NumSockets = 0;
+
+	// Sampled socket locations, ordered by sample then socket.
+	UPROPERTY()
+	TArray<FVector> Samples;
+
+	/*
+	 * Whether the trajectory has been baked.
+	 */
+	FORCEINLINE bool IsBaked() const { return NumSockets > 0 && Samples.Num() >= NumSockets; }
+
+	/*
+	 * Gets the location of a socket at a montage position, interpolated between the nearest samples.
+	 * Positions outside of the baked window are clamped to it.
+	 * @param Position		Position in the montage.
+	 * @param SocketIndex	Index of the socket.
+	 * @returns FVector		Location of the socket in mesh component space.
+	 */
+	FVector GetSocketLocation(const float Position, const int32 SocketIndex) const
+	{
+		const int32 NumSamples = Samples.Num() / NumSockets;
+		const float SampleTime = FMath::Clamp(Position - StartTime, 0.0f, EndTime - StartTime) * SampleRate;
+		const int32 Sample = FMath::Min(FMath::FloorToInt(SampleTime), NumSamples - 1);
+		const int32 NextSample = FMath::Min(Sample + 1, NumSamples - 1);
+
+		return FMath::Lerp(Samples[Sample * NumSockets + SocketIndex], Samples[NextSample * NumSockets + SocketIndex], SampleTime - Sample);
+	}
+};
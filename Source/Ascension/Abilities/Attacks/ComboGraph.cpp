@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "ComboGraph.h"
+
+
+void UComboGraph::PostLoad()
+{
+	Super::PostLoad();
+
+	Compile();
+}
+
+#if WITH_EDITOR
+void UComboGraph::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	Compile();
+}
+#endif
+
+void UComboGraph::Compile()
+{
+	InputColumns.Reset();
+	TransitionTable.Reset();
+	CompiledTransitions.Reset();
+	NodeAbilities.Reset();
+
+	// Node 0 is the entry node, authored nodes follow it.
+	TMap<FName, int32> NodeIndices;
+	NodeAbilities.Add(FString());
+
+	for (const FComboNode& Node : Nodes)
+	{
+		const int32 NodeIndex = NodeAbilities.Add(Node.AbilityName);
+
+		// Transitions can't tell nodes with the same name apart, so only the first can be reached.
+		if (NodeIndices.Contains(Node.NodeName))
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s: Duplicate combo node name %s."), *GetName(), *Node.NodeName.ToString())
+			continue;
+		}
+
+		NodeIndices.Add(Node.NodeName, NodeIndex);
+	}
+
+	auto GetTransitions = [this](const int32 Node) -> const TArray<FComboTransition>&
+	{
+		return Node == EntryNode ? EntryTransitions : Nodes[Node - 1].Transitions;
+	};
+
+	for (int32 Node = 0; Node < NodeAbilities.Num(); Node++)
+	{
+		for (const FComboTransition& Transition : GetTransitions(Node))
+		{
+			if (!InputColumns.Contains(Transition.Input))
+			{
+				InputColumns.Add(Transition.Input, InputColumns.Num());
+			}
+		}
+	}
+
+	const int32 NumInputs = InputColumns.Num();
+	TransitionTable.SetNumZeroed(NodeAbilities.Num() * NumInputs);
+
+	for (int32 Node = 0; Node < NodeAbilities.Num(); Node++)
+	{
+		for (int32 InputIndex = 0; InputIndex < NumInputs; InputIndex++)
+		{
+			FTransitionRange& Range = TransitionTable[Node * NumInputs + InputIndex];
+			Range.First = CompiledTransitions.Num();
+
+			for (const FComboTransition& Transition : GetTransitions(Node))
+			{
+				if (InputColumns.FindChecked(Transition.Input) != InputIndex)
+				{
+					continue;
+				}
+
+				const int32* TargetNode = NodeIndices.Find(Transition.TargetNode);
+
+				if (TargetNode == nullptr)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("%s: Combo transition to unknown node %s."), *GetName(), *Transition.TargetNode.ToString())
+					continue;
+				}
+
+				FCompiledTransition CompiledTransition;
+				CompiledTransition.TargetNode = *TargetNode;
+				CompiledTransition.WindowStart = Transition.WindowStart;
+				CompiledTransition.WindowEnd = Transition.WindowEnd > 0.0f ? Transition.WindowEnd : MAX_FLT;
+				CompiledTransition.RequiredStates = (uint8) Transition.RequiredStates;
+				CompiledTransitions.Add(CompiledTransition);
+			}
+
+			Range.Num = CompiledTransitions.Num() - Range.First;
+		}
+	}
+
+	bCompiled = true;
+}
+
+int32 UComboGraph::FindTransition(const int32 Node, const FName Input, const float TimeInNode, const uint8 States) const
+{
+	if (!bCompiled)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32* InputIndex = InputColumns.Find(Input);
+
+	if (InputIndex == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 CurrentNode = NodeAbilities.IsValidIndex(Node) ? Node : EntryNode;
+	int32 TargetNode = FindTransitionInCell(CurrentNode, *InputIndex, TimeInNode, States);
+
+	// Start a new combo if the current one can't continue.
+	if (TargetNode == INDEX_NONE && CurrentNode != EntryNode)
+	{
+		TargetNode = FindTransitionInCell(EntryNode, *InputIndex, 0.0f, States);
+	}
+
+	return TargetNode;
+}
+
+const FString& UComboGraph::GetNodeAbility(const int32 Node) const
+{
+	static const FString NoAbility;
+	return NodeAbilities.IsValidIndex(Node) ? NodeAbilities[Node] : NoAbility;
+}
+
+int32 UComboGraph::FindTransitionInCell(const int32 Node, const int32 InputIndex, const float TimeInNode, const uint8 States) const
+{
+	const FTransitionRange& Range = TransitionTable[Node * InputColumns.Num() + InputIndex];
+
+	for (int32 Index = Range.First; Index < Range.First + Range.Num; Index++)
+	{
+		const FCompiledTransition& Transition = CompiledTransitions[Index];
+
+		if (TimeInNode >= Transition.WindowStart && TimeInNode <= Transition.WindowEnd && (States & Transition.RequiredStates) == Transition.RequiredStates)
+		{
+			return Transition.TargetNode;
+		}
+	}
+
+	return INDEX_NONE;
+}
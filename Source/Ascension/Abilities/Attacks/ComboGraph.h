@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ComboGraph.generated.h"
+
+
+/*
+ * States of an entity that combo transitions can require.
+ */
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EComboStateFlags : uint8
+{
+	CSF_None			= 0			UMETA(Hidden),
+	CSF_Grounded		= 1 << 0	UMETA(DisplayName = "Grounded"),
+	CSF_Airborne		= 1 << 1	UMETA(DisplayName = "Airborne"),
+	CSF_Moving			= 1 << 2	UMETA(DisplayName = "Moving")
+};
+ENUM_CLASS_FLAGS(EComboStateFlags);
+
+/*
+ * Edge of a combo graph, leading to the next attack of a combo.
+ */
+USTRUCT(BlueprintType)
+struct FComboTransition
+{
+	GENERATED_BODY()
+
+	// Input that takes the transition.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo")
+	FName Input;
+
+	// Name of the node the transition leads to.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo")
+	FName TargetNode;
+
+	// Time after the current attack started from which the transition can be taken.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo", meta = (ClampMin = 0, UIMin = 0))
+	float WindowStart = 0.0f;
+
+	// Time after the current attack started until which the transition can be taken. No limit if 0.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo", meta = (ClampMin = 0, UIMin = 0))
+	float WindowEnd = 0.0f;
+
+	// States the entity needs to be in to take the transition.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo", meta = (Bitmask, BitmaskEnum = "EComboStateFlags"))
+	int32 RequiredStates = 0;
+};
+
+/*
+ * Node of a combo graph, performing an attack.
+ */
+USTRUCT(BlueprintType)
+struct FComboNode
+{
+	GENERATED_BODY()
+
+	// Name of the node, used by transitions to refer to it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo")
+	FName NodeName;
+
+	// Name of the attack ability performed by the node.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo")
+	FString AbilityName;
+
+	// Transitions to the next attacks of the combo.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combo")
+	TArray<FComboTransition> Transitions;
+};
+
+/*
+ * Asset describing the combos of an entity as a graph of attacks.
+ * Each node performs an attack, and each transition leads to the next attack when an input is given within a timing
+ * window while the entity is in the required states. Combos start from the entry transitions, and when no transition
+ * of the current node matches an input, the entry transitions are used to start a new combo.
+ *
+ * The graph is compiled into a flat table with a row per node and a column per input, so selecting the next attack
+ * is a single lookup followed by a check of the few transitions in the cell.
+ */
+UCLASS(BlueprintType)
+class ASCENSION_API UComboGraph : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Index of the node combos start from. */
+	static constexpr int32 EntryNode = 0;
+
+	/** Transitions that start a combo. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combo")
+	TArray<FComboTransition> EntryTransitions;
+
+	/** Attacks of the graph. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combo")
+	TArray<FComboNode> Nodes;
+
+public:
+	/* UObject functions. */
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/*
+	 * Compiles the graph into its transition table.
+	 */
+	void Compile();
+
+	/*
+	 * Finds the node to transition to from a node.
+	 * Falls back to the entry transitions if no transition of the node matches.
+	 * @param Node			Index of the current node.
+	 * @param Input			Input given.
+	 * @param TimeInNode	Time since the current node's attack started.
+	 * @param States		States the entity is in, as EComboStateFlags.
+	 * @returns int32		Index of the node to transition to. INDEX_NONE if there is none.
+	 */
+	int32 FindTransition(const int32 Node, const FName Input, const float TimeInNode, const uint8 States) const;
+
+	/*
+	 * Gets the name of the ability performed by a node.
+	 * @param Node	Index of the node.
+	 */
+	const FString& GetNodeAbility(const int32 Node) const;
+
+private:
+	/*
+	 * Transition of the compiled table.
+	 */
+	struct FCompiledTransition
+	{
+		int32 TargetNode;
+		float WindowStart;
+		float WindowEnd;
+		uint8 RequiredStates;
+	};
+
+	/*
+	 * Cell of the compiled table, holding a range of transitions.
+	 */
+	struct FTransitionRange
+	{
+		uint16 First;
+		uint16 Num;
+	};
+
+	/*
+	 * Checks the transitions of a cell of the table.
+	 * @returns int32	Index of the node to transition to. INDEX_NONE if no transition matches.
+	 */
+	int32 FindTransitionInCell(const int32 Node, const int32 InputIndex, const float TimeInNode, const uint8 States) const;
+
+private:
+	/** Column of the table of each input used by the graph. */
+	TMap<FName, int32> InputColumns;
+
+	/** Table of transition ranges, indexed by node * number of inputs + input. */
+	TArray<FTransitionRange> TransitionTable;
+
+	/** Transitions, grouped by cell. */
+	TArray<FCompiledTransition> CompiledTransitions;
+
+	/** Ability of each node. The entry node has none. */
+	TArray<FString> NodeAbilities;
+
+	/** Whether the graph has been compiled. */
+	bool bCompiled = false;
+};
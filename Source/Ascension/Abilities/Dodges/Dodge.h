@@ -25,6 +25,11 @@ public:
 	 */
 	virtual void Activate();
 
+	/*
+	 * Gets the animation montage of the dodge.
+	 */
+	virtual UAnimMontage* GetAnimMontage() const override { return AnimMontage; }
+
 protected:
 	/** Animation montage of the dodge. */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Variables")
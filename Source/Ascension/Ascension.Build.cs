@@ -7,7 +7,7 @@ public class Ascension : ModuleRules
 	public Ascension(ReadOnlyTargetRules Target) : base (Target)
 	{
         PrivatePCHHeaderFile = "Ascension.h";
-        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "AIModule", "GameplayTasks" });
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "AIModule", "GameplayTasks", "NavigationSystem", "SignificanceManager" });
 
         MinFilesUsingPrecompiledHeaderOverride = 1;
         bFasterWithoutUnity = true;
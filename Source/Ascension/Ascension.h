@@ -6,5 +6,8 @@
 #include "EngineMinimal.h"
 
 DECLARE_LOG_CATEGORY_EXTERN( LogInputBuffer, All, All );
+DECLARE_LOG_CATEGORY_EXTERN( LogBenchmark, Log, All );
+
+DECLARE_STATS_GROUP( TEXT("Ascension"), STATGROUP_Ascension, STATCAT_Advanced );
 
 #endif
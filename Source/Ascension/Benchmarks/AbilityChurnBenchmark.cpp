@@ -0,0 +1,276 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "AbilityChurnBenchmark.h"
+#include "BenchmarkUtils.h"
+#include "Abilities/AbilitySystems/GameAbilitySystemComponent.h"
+#include "Abilities/Attacks/Attack.h"
+#include "Abilities/Dodges/Dodge.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ability Churn Benchmark"), STAT_AbilityChurnBenchmark, STATGROUP_Ascension);
+
+static const FString BenchmarkAttackName = FString("Light01");
+static const FString BenchmarkDodgeName = FString("Dodge");
+
+
+// Sets default values
+AAbilityChurnBenchmark::AAbilityChurnBenchmark()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// Roughly the rate at which a goblin in combat swings and dodges.
+	ActivationsPerSecond = 1.5f;
+	MinAbilityDuration = 0.4f;
+	MaxAbilityDuration = 1.2f;
+	WarmupFrames = 30;
+
+	RunIndex = 0;
+	FramesPerRun = 600;
+	RunFrame = 0;
+	bQuitWhenDone = false;
+	bRunning = false;
+	LastTickTime = 0.0;
+	ObjectsCreatedThisFrame = 0;
+	GCSecondsThisFrame = 0.0;
+	GCStartTime = 0.0;
+	PeakObjectCount = 0;
+	RunFrameMs = 0.0;
+	RunAbilityMs = 0.0;
+}
+
+void AAbilityChurnBenchmark::StartBenchmark(const TArray<int32>& InActorCounts, int32 InFramesPerRun, bool bInQuitWhenDone)
+{
+	if (bRunning || InActorCounts.Num() == 0)
+	{
+		return;
+	}
+
+	ActorCounts = InActorCounts;
+	FramesPerRun = FMath::Max(InFramesPerRun, 1);
+	bQuitWhenDone = bInQuitWhenDone;
+	RunIndex = 0;
+	RandomStream.Initialize(FBenchmarkUtils::RandomSeed);
+
+	CsvLines.Reset();
+	CsvLines.Add(FString("ActorCount,Frame,FrameMs,AbilityMs,UObjectsCreated,GCMs,UObjectCount,ActiveAbilities,UsedPhysicalMB"));
+
+	GUObjectArray.AddUObjectCreateListener(this);
+	PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &AAbilityChurnBenchmark::OnPreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &AAbilityChurnBenchmark::OnPostGarbageCollect);
+
+	bRunning = true;
+	BeginRun();
+	SetActorTickEnabled(true);
+}
+
+void AAbilityChurnBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!bRunning)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_AbilityChurnBenchmark);
+
+	const double TickTime = FPlatformTime::Seconds();
+	const double FrameMs = (TickTime - LastTickTime) * 1000.0;
+	LastTickTime = TickTime;
+
+	// Drive the ability systems. Only this section is counted as ability cost.
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float ActivationChance = ActivationsPerSecond * DeltaSeconds;
+	const uint64 AbilityStartCycles = FPlatformTime::Cycles64();
+
+	for (int32 Index = ActiveAbilities.Num() - 1; Index >= 0; Index--)
+	{
+		const FActiveBenchmarkAbility& ActiveAbility = ActiveAbilities[Index];
+		if (ActiveAbility.FinishTime <= CurrentTime)
+		{
+			const FString& AbilityName = ActiveAbility.bIsAttack ? BenchmarkAttackName : BenchmarkDodgeName;
+			AbilitySystems[ActiveAbility.ActorIndex]->FinishAbility(AbilityName, ActiveAbility.AbilityID);
+			ActiveAbilities.RemoveAtSwap(Index);
+		}
+	}
+
+	for (int32 ActorIndex = 0; ActorIndex < AbilitySystems.Num(); ActorIndex++)
+	{
+		if (RandomStream.FRand() < ActivationChance)
+		{
+			// Attacks are far more common than dodges in combat.
+			const bool bIsAttack = RandomStream.FRand() < 0.75f;
+			uint8 AbilityID = 0;
+
+			if (AbilitySystems[ActorIndex]->ActivateAbility(bIsAttack ? BenchmarkAttackName : BenchmarkDodgeName, AbilityID))
+			{
+				FActiveBenchmarkAbility ActiveAbility;
+				ActiveAbility.ActorIndex = ActorIndex;
+				ActiveAbility.AbilityID = AbilityID;
+				ActiveAbility.bIsAttack = bIsAttack;
+				ActiveAbility.FinishTime = CurrentTime + RandomStream.FRandRange(MinAbilityDuration, MaxAbilityDuration);
+				ActiveAbilities.Add(ActiveAbility);
+			}
+		}
+	}
+
+	const double AbilityMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - AbilityStartCycles);
+	const int32 ObjectCount = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	const int32 ObjectsCreated = ObjectsCreatedThisFrame;
+	const double GCMs = GCSecondsThisFrame * 1000.0;
+	ObjectsCreatedThisFrame = 0;
+	GCSecondsThisFrame = 0.0;
+
+	RunFrame++;
+	if (RunFrame <= WarmupFrames)
+	{
+		return;
+	}
+
+	PeakObjectCount = FMath::Max(PeakObjectCount, ObjectCount);
+	RunFrameMs += FrameMs;
+	RunAbilityMs += AbilityMs;
+
+	const float UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / (1024.0f * 1024.0f);
+	CsvLines.Add(FString::Printf(TEXT("%d,%d,%.3f,%.3f,%d,%.3f,%d,%d,%.1f"), ActorCounts[RunIndex], RunFrame - WarmupFrames,
+								 FrameMs, AbilityMs, ObjectsCreated, GCMs, ObjectCount, ActiveAbilities.Num(), UsedPhysicalMB));
+
+	if (RunFrame - WarmupFrames >= FramesPerRun)
+	{
+		EndRun();
+		RunIndex++;
+
+		if (ActorCounts.IsValidIndex(RunIndex))
+		{
+			BeginRun();
+		}
+		else
+		{
+			WriteResults();
+			Destroy();
+		}
+	}
+}
+
+void AAbilityChurnBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bRunning)
+	{
+		GUObjectArray.RemoveUObjectCreateListener(this);
+		FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+		bRunning = false;
+
+		if (bQuitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAbilityChurnBenchmark::NotifyUObjectCreated(const UObjectBase* Object, int32 Index)
+{
+	ObjectsCreatedThisFrame++;
+}
+
+void AAbilityChurnBenchmark::OnUObjectArrayShutdown()
+{
+	GUObjectArray.RemoveUObjectCreateListener(this);
+}
+
+void AAbilityChurnBenchmark::BeginRun()
+{
+	const int32 ActorCount = ActorCounts[RunIndex];
+	UE_LOG(LogBenchmark, Log, TEXT("Ability churn: starting run with %d actors."), ActorCount)
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 Index = 0; Index < ActorCount; Index++)
+	{
+		AActor* Actor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+		UGameAbilitySystemComponent* AbilitySystem = NewObject<UGameAbilitySystemComponent>(Actor);
+		AbilitySystem->AddAbility(BenchmarkAttackName, UAttack::StaticClass());
+		AbilitySystem->AddAbility(BenchmarkDodgeName, UDodge::StaticClass());
+		AbilitySystem->RegisterComponent();
+
+		SpawnedActors.Add(Actor);
+		AbilitySystems.Add(AbilitySystem);
+	}
+
+	RunFrame = 0;
+	PeakObjectCount = 0;
+	RunFrameMs = 0.0;
+	RunAbilityMs = 0.0;
+	LastTickTime = FPlatformTime::Seconds();
+}
+
+void AAbilityChurnBenchmark::EndRun()
+{
+	const int32 MeasuredFrames = FMath::Max(RunFrame - WarmupFrames, 1);
+	UE_LOG(LogBenchmark, Log, TEXT("Ability churn: %d actors | avg frame %.3f ms | avg ability %.3f ms | peak UObjects %d"),
+		   ActorCounts[RunIndex], RunFrameMs / MeasuredFrames, RunAbilityMs / MeasuredFrames, PeakObjectCount)
+
+	for (AActor* Actor : SpawnedActors)
+	{
+		if (Actor != nullptr)
+		{
+			Actor->Destroy();
+		}
+	}
+
+	SpawnedActors.Reset();
+	AbilitySystems.Reset();
+	ActiveAbilities.Reset();
+}
+
+void AAbilityChurnBenchmark::WriteResults() const
+{
+	FBenchmarkUtils::WriteCsv(TEXT("AbilityChurn"), CsvLines);
+}
+
+void AAbilityChurnBenchmark::OnPreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void AAbilityChurnBenchmark::OnPostGarbageCollect()
+{
+	GCSecondsThisFrame += FPlatformTime::Seconds() - GCStartTime;
+}
+
+/*
+ * Console command starting the ability churn benchmark.
+ * Arguments: Count=<actor count> Counts=<comma separated actor counts> Frames=<frames per run> Quit=<0|1>
+ */
+static FAutoConsoleCommandWithWorldAndArgs AbilityChurnBenchmarkCommand(
+	TEXT("Ascension.Benchmark.AbilityChurn"),
+	TEXT("Stress tests ability activation churn. Usage: Ascension.Benchmark.AbilityChurn [Counts=100,500,2000] [Frames=600] [Quit=0]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		TArray<int32> ActorCounts = { 100, 500, 2000 };
+		int32 Frames = 600;
+		bool bQuit = false;
+		FBenchmarkUtils::ParseCounts(Args, ActorCounts);
+
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("Frames="), Frames);
+			FParse::Bool(*Arg, TEXT("Quit="), bQuit);
+		}
+
+		AAbilityChurnBenchmark* Benchmark = World->SpawnActor<AAbilityChurnBenchmark>();
+		if (Benchmark)
+		{
+			Benchmark->StartBenchmark(ActorCounts, Frames, bQuit);
+		}
+	})
+);
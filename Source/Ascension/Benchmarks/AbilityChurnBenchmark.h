@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "UObject/UObjectArray.h"
+#include "AbilityChurnBenchmark.generated.h"
+
+
+/*
+ * Benchmark that stresses the ability system with randomized activate/finish cycles across many actors.
+ * Each run spawns a number of actors with a UGameAbilitySystemComponent, drives them for a fixed number of frames
+ * and records per-frame costs. Results of every run are written to a CSV file in the profiling directory.
+ *
+ * Started from the console, e.g. for a headless run:
+ *   UE4Editor-Cmd Ascension -game -nullrhi -ExecCmds="Ascension.Benchmark.AbilityChurn Counts=100,500,2000 Quit=1"
+ */
+UCLASS(NotPlaceable, Transient)
+class ASCENSION_API AAbilityChurnBenchmark : public AActor, public FUObjectArray::FUObjectCreateListener
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties.
+	AAbilityChurnBenchmark();
+
+	/*
+	 * Starts the benchmark.
+	 * @param InActorCounts		Number of actors to spawn for each run.
+	 * @param InFramesPerRun	Number of frames each run is measured for.
+	 * @param bInQuitWhenDone	Whether to exit the application once every run is complete.
+	 */
+	void StartBenchmark(const TArray<int32>& InActorCounts, int32 InFramesPerRun, bool bInQuitWhenDone);
+
+	// Called every frame.
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	// Called when the actor exits play.
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	/* UObject create listener functions. */
+	virtual void NotifyUObjectCreated(const class UObjectBase* Object, int32 Index) override;
+	virtual void OnUObjectArrayShutdown() override;
+
+public:
+	/** Number of abilities each actor activates per second on average. */
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float ActivationsPerSecond;
+
+	/** Minimum time in seconds an ability stays active. */
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float MinAbilityDuration;
+
+	/** Maximum time in seconds an ability stays active. */
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float MaxAbilityDuration;
+
+	/** Number of frames to skip after spawning before measuring, so spawning costs don't skew the results. */
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	int32 WarmupFrames;
+
+private:
+	/*
+	 * Struct tracking an ability activated by the benchmark.
+	 */
+	struct FActiveBenchmarkAbility
+	{
+		int32 ActorIndex;
+		uint8 AbilityID;
+		bool bIsAttack;
+		float FinishTime;
+	};
+
+	/** Spawns the actors for the current run. */
+	void BeginRun();
+
+	/** Destroys the actors of the current run and writes its summary. */
+	void EndRun();
+
+	/** Writes the results of every run to disk. */
+	void WriteResults() const;
+
+	/** Called before garbage collection starts. */
+	void OnPreGarbageCollect();
+
+	/** Called after garbage collection completes. */
+	void OnPostGarbageCollect();
+
+private:
+	/** Ability system components of the actors of the current run. */
+	UPROPERTY(Transient)
+	TArray<class UGameAbilitySystemComponent*> AbilitySystems;
+
+	/** Actors spawned for the current run. */
+	UPROPERTY(Transient)
+	TArray<AActor*> SpawnedActors;
+
+	/** Abilities currently active across every actor. */
+	TArray<FActiveBenchmarkAbility> ActiveAbilities;
+
+	/** Number of actors for each run. */
+	TArray<int32> ActorCounts;
+
+	/** Index of the current run. */
+	int32 RunIndex;
+
+	/** Number of frames each run is measured for. */
+	int32 FramesPerRun;
+
+	/** Frame of the current run. */
+	int32 RunFrame;
+
+	/** Whether to quit once the benchmark is complete. */
+	bool bQuitWhenDone;
+
+	/** Whether the benchmark is running. */
+	bool bRunning;
+
+	/** Random stream so runs are reproducible. */
+	FRandomStream RandomStream;
+
+	/** Time of the last benchmark tick, used to measure the frame time. */
+	double LastTickTime;
+
+	/** Number of UObjects created since the last tick. */
+	int32 ObjectsCreatedThisFrame;
+
+	/** Time spent in garbage collection since the last tick. */
+	double GCSecondsThisFrame;
+
+	/** Time at which the current garbage collection started. */
+	double GCStartTime;
+
+	/** Highest UObject count seen during the current run. */
+	int32 PeakObjectCount;
+
+	/** Frame time accumulated during the current run, in milliseconds. */
+	double RunFrameMs;
+
+	/** Ability update time accumulated during the current run, in milliseconds. */
+	double RunAbilityMs;
+
+	/** Lines of the CSV file. */
+	TArray<FString> CsvLines;
+
+	/** Handles of the garbage collection delegates. */
+	FDelegateHandle PreGCHandle;
+	FDelegateHandle PostGCHandle;
+};
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "BenchmarkUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+
+bool FBenchmarkUtils::ParseCounts(const TArray<FString>& Args, TArray<int32>& OutCounts)
+{
+	bool bParsed = false;
+
+	for (const FString& Arg : Args)
+	{
+		int32 Count = 0;
+		if (FParse::Value(*Arg, TEXT("Count="), Count) && Count > 0)
+		{
+			OutCounts = { Count };
+			bParsed = true;
+		}
+
+		// Don't stop on separators, the counts are comma separated.
+		FString CountList;
+		if (FParse::Value(*Arg, TEXT("Counts="), CountList, false))
+		{
+			TArray<FString> CountStrings;
+			CountList.ParseIntoArray(CountStrings, TEXT(","));
+
+			TArray<int32> Counts;
+			for (const FString& CountString : CountStrings)
+			{
+				const int32 ListCount = FCString::Atoi(*CountString);
+				if (ListCount > 0)
+				{
+					Counts.Add(ListCount);
+				}
+			}
+
+			if (Counts.Num() > 0)
+			{
+				OutCounts = MoveTemp(Counts);
+				bParsed = true;
+			}
+		}
+	}
+
+	return bParsed;
+}
+
+bool FBenchmarkUtils::WriteCsv(const FString& BenchmarkName, const TArray<FString>& CsvLines)
+{
+	const FString FileName = FString::Printf(TEXT("%s-%s.csv"), *BenchmarkName, *FDateTime::Now().ToString());
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Benchmarks"), FileName);
+
+	if (!FFileHelper::SaveStringArrayToFile(CsvLines, *FilePath))
+	{
+		UE_LOG(LogBenchmark, Error, TEXT("%s: failed to write results to %s"), *BenchmarkName, *FilePath)
+		return false;
+	}
+
+	UE_LOG(LogBenchmark, Log, TEXT("%s: results written to %s"), *BenchmarkName, *FilePath)
+	return true;
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+ * Helpers shared by the benchmarks, so each benchmark only has to supply its workload.
+ * Covers parsing of the common console arguments, the random seed runs are reproduced with and writing of results.
+ */
+struct ASCENSION_API FBenchmarkUtils
+{
+	/** Seed of the random streams of every benchmark, so runs are reproducible. */
+	static const int32 RandomSeed = 0x41534345;
+
+	/*
+	 * Parses the counts of a benchmark from console arguments.
+	 * Accepts Count=<count> for a single run or Counts=<comma separated counts> for several. Counts below one are ignored.
+	 * @param Args		Console arguments.
+	 * @param OutCounts	Counts to run. Left untouched if no count is given, so it can hold the defaults.
+	 * @return			Whether any counts were parsed.
+	 */
+	static bool ParseCounts(const TArray<FString>& Args, TArray<int32>& OutCounts);
+
+	/*
+	 * Writes the results of a benchmark to a CSV file in the Benchmarks folder of the profiling directory.
+	 * The file is named after the benchmark and the current time, so runs don't overwrite each other.
+	 * @param BenchmarkName	Name of the benchmark, used for the file name and logging.
+	 * @param CsvLines		Lines of the CSV file, starting with the header.
+	 * @return				Whether the file was written.
+	 */
+	static bool WriteCsv(const FString& BenchmarkName, const TArray<FString>& CsvLines);
+};
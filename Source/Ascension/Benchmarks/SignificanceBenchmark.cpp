@@ -0,0 +1,303 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "SignificanceBenchmark.h"
+#include "BenchmarkUtils.h"
+#include "Entities/Characters/Enemies/Enemy.h"
+#include "Entities/Characters/Enemies/Goblin.h"
+#include "Significance/EnemySignificanceSubsystem.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Kismet/GameplayStatics.h"
+
+static const TCHAR* SignificanceEnableName = TEXT("Ascension.Significance.Enable");
+
+
+// Sets default values
+ASignificanceBenchmark::ASignificanceBenchmark()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	SpawnRadius = 20000.0f;
+	WarmupFrames = 60;
+
+	CountIndex = 0;
+	FramesPerPhase = 600;
+	Phase = 0;
+	PhaseFrame = 0;
+	RandomStream.Initialize(FBenchmarkUtils::RandomSeed);
+	PreviousSignificanceEnable = 1;
+	bMeasureAI = false;
+	bQuitWhenDone = false;
+	bRunning = false;
+	LastTickTime = 0.0;
+	FMemory::Memzero(PhaseFrameMs);
+}
+
+void ASignificanceBenchmark::StartBenchmark(TSubclassOf<AEnemy> InEnemyClass, const TArray<int32>& InEnemyCounts, int32 InFramesPerPhase,
+											bool bInMeasureAI, bool bInQuitWhenDone)
+{
+	IConsoleVariable* SignificanceEnable = IConsoleManager::Get().FindConsoleVariable(SignificanceEnableName);
+
+	if (bRunning || InEnemyClass == nullptr || InEnemyCounts.Num() == 0 || SignificanceEnable == nullptr)
+	{
+		return;
+	}
+
+	EnemyClass = InEnemyClass;
+	EnemyCounts = InEnemyCounts;
+	EnemyCounts.Sort();
+	FramesPerPhase = FMath::Max(InFramesPerPhase, 1);
+	bMeasureAI = bInMeasureAI;
+	bQuitWhenDone = bInQuitWhenDone;
+	PreviousSignificanceEnable = SignificanceEnable->GetInt();
+
+	CsvLines.Reset();
+	CsvLines.Add(FString("Enemies,Significance,BehaviorTrees,Frame,FrameMs,Near,Visible,Hidden,Dormant"));
+
+	CountIndex = 0;
+	SpawnEnemies(EnemyCounts[CountIndex]);
+
+	bRunning = true;
+	BeginPhase(0);
+	SetActorTickEnabled(true);
+}
+
+void ASignificanceBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!bRunning)
+	{
+		return;
+	}
+
+	const double TickTime = FPlatformTime::Seconds();
+	const double FrameMs = (TickTime - LastTickTime) * 1000.0;
+	LastTickTime = TickTime;
+
+	PhaseFrame++;
+	if (PhaseFrame <= WarmupFrames)
+	{
+		return;
+	}
+
+	PhaseFrameMs[Phase] += FrameMs;
+
+	const UEnemySignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>();
+	const int32* BucketCounts = SignificanceSubsystem->GetBucketCounts();
+
+	CsvLines.Add(FString::Printf(TEXT("%d,%d,%d,%d,%.3f,%d,%d,%d,%d"), SpawnedEnemies.Num(), IsSignificancePhase(Phase) ? 1 : 0,
+								 IsBehaviorTreePhase(Phase) ? 1 : 0, PhaseFrame - WarmupFrames, FrameMs,
+								 BucketCounts[(uint8) ESignificanceBucket::SB_Near], BucketCounts[(uint8) ESignificanceBucket::SB_Visible],
+								 BucketCounts[(uint8) ESignificanceBucket::SB_Hidden], BucketCounts[(uint8) ESignificanceBucket::SB_Dormant]));
+
+	if (PhaseFrame - WarmupFrames < FramesPerPhase)
+	{
+		return;
+	}
+
+	if (Phase + 1 < GetNumPhases())
+	{
+		BeginPhase(Phase + 1);
+		return;
+	}
+
+	ReportCount();
+
+	if (++CountIndex < EnemyCounts.Num())
+	{
+		SpawnEnemies(EnemyCounts[CountIndex]);
+		BeginPhase(0);
+	}
+	else
+	{
+		FinishBenchmark();
+	}
+}
+
+void ASignificanceBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bRunning)
+	{
+		bRunning = false;
+
+		if (IConsoleVariable* SignificanceEnable = IConsoleManager::Get().FindConsoleVariable(SignificanceEnableName))
+		{
+			SignificanceEnable->Set(PreviousSignificanceEnable);
+		}
+
+		for (AEnemy* Enemy : SpawnedEnemies)
+		{
+			if (Enemy != nullptr)
+			{
+				Enemy->Destroy();
+			}
+		}
+
+		SpawnedEnemies.Reset();
+
+		if (bQuitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASignificanceBenchmark::SpawnEnemies(int32 Count)
+{
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector Origin = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 Index = SpawnedEnemies.Num(); Index < Count; Index++)
+	{
+		// Uniform over the area, so most enemies are far from the player as in a real level.
+		const float Radius = SpawnRadius * FMath::Sqrt(RandomStream.FRand());
+		const float Angle = RandomStream.FRandRange(0.0f, 2.0f * PI);
+		const FVector Location = Origin + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.0f);
+
+		AEnemy* Enemy = GetWorld()->SpawnActor<AEnemy>(EnemyClass, FTransform(Location), SpawnParameters);
+
+		if (Enemy != nullptr)
+		{
+			if (Enemy->GetController() == nullptr)
+			{
+				Enemy->SpawnDefaultController();
+			}
+
+			SpawnedEnemies.Add(Enemy);
+		}
+	}
+
+	UE_LOG(LogBenchmark, Log, TEXT("Significance: spawned %d enemies of %s."), SpawnedEnemies.Num(), *GetNameSafe(EnemyClass))
+}
+
+void ASignificanceBenchmark::BeginPhase(int32 InPhase)
+{
+	IConsoleManager::Get().FindConsoleVariable(SignificanceEnableName)->Set(IsSignificancePhase(InPhase) ? 1 : 0);
+
+	if (bMeasureAI)
+	{
+		SetBehaviorTreesRunning(IsBehaviorTreePhase(InPhase));
+	}
+
+	if (InPhase == 0)
+	{
+		FMemory::Memzero(PhaseFrameMs);
+	}
+
+	Phase = InPhase;
+	PhaseFrame = 0;
+	LastTickTime = FPlatformTime::Seconds();
+}
+
+void ASignificanceBenchmark::SetBehaviorTreesRunning(bool bRun)
+{
+	static const FString PauseReason(TEXT("SignificanceBenchmark"));
+
+	for (AEnemy* Enemy : SpawnedEnemies)
+	{
+		const AAIController* AIController = Enemy ? Cast<AAIController>(Enemy->GetController()) : nullptr;
+		UBrainComponent* Brain = AIController ? AIController->GetBrainComponent() : nullptr;
+
+		if (Brain == nullptr)
+		{
+			continue;
+		}
+
+		if (bRun)
+		{
+			Brain->ResumeLogic(PauseReason);
+		}
+		else if (!Brain->IsPaused())
+		{
+			Brain->PauseLogic(PauseReason);
+		}
+	}
+}
+
+void ASignificanceBenchmark::ReportCount()
+{
+	// The AI time is the frame time with the behavior trees running less the frame time with them paused.
+	const double FullRateMs = bMeasureAI ? FMath::Max(PhaseFrameMs[1] - PhaseFrameMs[0], 0.0) / FramesPerPhase : PhaseFrameMs[0] / FramesPerPhase;
+	const double SignificanceMs = bMeasureAI ? FMath::Max(PhaseFrameMs[3] - PhaseFrameMs[2], 0.0) / FramesPerPhase : PhaseFrameMs[1] / FramesPerPhase;
+	const double Savings = FullRateMs > 0.0 ? (1.0 - SignificanceMs / FullRateMs) * 100.0 : 0.0;
+
+	UE_LOG(LogBenchmark, Log, TEXT("Significance: %d enemies | %s full rate %.3f ms | significance %.3f ms | %.1f%% saved"),
+		   SpawnedEnemies.Num(), bMeasureAI ? TEXT("AI") : TEXT("frame"), FullRateMs, SignificanceMs, Savings)
+}
+
+void ASignificanceBenchmark::FinishBenchmark()
+{
+	FBenchmarkUtils::WriteCsv(bMeasureAI ? TEXT("AI") : TEXT("Significance"), CsvLines);
+	Destroy();
+}
+
+/*
+ * Starts the significance benchmark from console arguments.
+ * Arguments: Count=<number of enemies> Counts=<comma separated numbers of enemies> Frames=<frames per phase>
+ *            Class=<enemy class path> Quit=<0|1>
+ */
+static void StartSignificanceBenchmark(const TArray<FString>& Args, UWorld* World, TArray<int32> Counts, int32 Frames, bool bMeasureAI)
+{
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	bool bQuit = false;
+	TSubclassOf<AEnemy> EnemyClass = AGoblin::StaticClass();
+	FBenchmarkUtils::ParseCounts(Args, Counts);
+
+	for (const FString& Arg : Args)
+	{
+		FString ClassPath;
+		if (FParse::Value(*Arg, TEXT("Class="), ClassPath))
+		{
+			UClass* LoadedClass = LoadClass<AEnemy>(nullptr, *ClassPath);
+			if (LoadedClass)
+			{
+				EnemyClass = LoadedClass;
+			}
+			else
+			{
+				UE_LOG(LogBenchmark, Warning, TEXT("Significance: enemy class %s not found, using %s."), *ClassPath, *GetNameSafe(EnemyClass))
+			}
+		}
+
+		FParse::Value(*Arg, TEXT("Frames="), Frames);
+		FParse::Bool(*Arg, TEXT("Quit="), bQuit);
+	}
+
+	ASignificanceBenchmark* Benchmark = World->SpawnActor<ASignificanceBenchmark>();
+	if (Benchmark)
+	{
+		Benchmark->StartBenchmark(EnemyClass, Counts, Frames, bMeasureAI, bQuit);
+	}
+}
+
+/** Console command starting the significance benchmark. */
+static FAutoConsoleCommandWithWorldAndArgs SignificanceBenchmarkCommand(
+	TEXT("Ascension.Benchmark.Significance"),
+	TEXT("Compares frame times with enemy significance disabled and enabled. Usage: Ascension.Benchmark.Significance [Count=300 | Counts=100,300] [Frames=600] [Class=/Game/Path/BP_Goblin.BP_Goblin_C] [Quit=0]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		StartSignificanceBenchmark(Args, World, { 300 }, 600, false);
+	})
+);
+
+/** Console command starting the significance benchmark measuring the AI time. */
+static FAutoConsoleCommandWithWorldAndArgs AIBenchmarkCommand(
+	TEXT("Ascension.Benchmark.AI"),
+	TEXT("Measures the AI time per frame for numbers of enemies, at full rate and with significance. Usage: Ascension.Benchmark.AI [Counts=50,200,500] [Frames=300] [Class=/Game/Path/BP_Goblin.BP_Goblin_C] [Quit=0]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		StartSignificanceBenchmark(Args, World, { 50, 200, 500 }, 300, true);
+	})
+);
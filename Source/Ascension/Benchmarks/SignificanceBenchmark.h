@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SignificanceBenchmark.generated.h"
+
+
+/*
+ * Benchmark comparing frame times with enemy significance disabled and enabled.
+ * Spawns a number of enemies spread around the first player, measures a number of frames with every enemy updating
+ * at full rate, then the same number of frames with significance buckets. With several enemy counts, more enemies are
+ * spawned and the phases measured again for each count. The frame times of every phase and the number of enemies in
+ * each bucket are written to a CSV file in the profiling directory.
+ *
+ * When measuring AI, each phase is measured twice, with the enemies' behavior trees paused and then running. The AI
+ * time is the difference between the two, so it includes the movement the trees drive.
+ *
+ * Started from the console, e.g. for a headless run:
+ *   UE4Editor-Cmd Ascension TestMap -game -nullrhi -ExecCmds="Ascension.Benchmark.Significance Count=300 Quit=1"
+ *   UE4Editor-Cmd Ascension TestMap -game -nullrhi -ExecCmds="Ascension.Benchmark.AI Counts=50,200,500 Quit=1"
+ * Nothing is rendered in a headless run, so every enemy outside the near distance counts as hidden.
+ */
+UCLASS(NotPlaceable, Transient)
+class ASCENSION_API ASignificanceBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties.
+	ASignificanceBenchmark();
+
+	/*
+	 * Starts the benchmark.
+	 * @param InEnemyClass		Class of the enemies to spawn.
+	 * @param InEnemyCounts		Numbers of enemies to measure, spawned in increasing order.
+	 * @param InFramesPerPhase	Number of frames each phase is measured for.
+	 * @param bInMeasureAI		Whether each phase is also measured with the behavior trees paused, to get the AI time.
+	 * @param bInQuitWhenDone	Whether to exit the application once the benchmark is complete.
+	 */
+	void StartBenchmark(TSubclassOf<class AEnemy> InEnemyClass, const TArray<int32>& InEnemyCounts, int32 InFramesPerPhase,
+						bool bInMeasureAI, bool bInQuitWhenDone);
+
+	// Called every frame.
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	// Called when the actor exits play.
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	/** Radius around the player the enemies are spread over. */
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float SpawnRadius;
+
+	/** Number of frames to skip at the start of each phase, so the buckets and spawning settle before measuring. */
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	int32 WarmupFrames;
+
+private:
+	/*
+	 * Spawns enemies until there are a number of them.
+	 * @param Count		Number of enemies.
+	 */
+	void SpawnEnemies(int32 Count);
+
+	/*
+	 * Starts a phase of the benchmark.
+	 * @param InPhase	Index of the phase.
+	 */
+	void BeginPhase(int32 InPhase);
+
+	/*
+	 * Pauses or resumes the behavior trees of the spawned enemies.
+	 * @param bRun	Whether the behavior trees run.
+	 */
+	void SetBehaviorTreesRunning(bool bRun);
+
+	/** Logs the results of the current enemy count. */
+	void ReportCount();
+
+	/** Writes the results to disk and ends the benchmark. */
+	void FinishBenchmark();
+
+	/** Number of phases measured for each enemy count. */
+	FORCEINLINE int32 GetNumPhases() const { return bMeasureAI ? 4 : 2; }
+
+	/** Whether significance is enabled in a phase. */
+	FORCEINLINE bool IsSignificancePhase(int32 InPhase) const { return InPhase >= GetNumPhases() / 2; }
+
+	/** Whether the behavior trees run in a phase. */
+	FORCEINLINE bool IsBehaviorTreePhase(int32 InPhase) const { return !bMeasureAI || (InPhase & 1) != 0; }
+
+private:
+	/** Enemies spawned. */
+	UPROPERTY(Transient)
+	TArray<class AEnemy*> SpawnedEnemies;
+
+	/** Class of the enemies to spawn. */
+	TSubclassOf<class AEnemy> EnemyClass;
+
+	/** Numbers of enemies to measure, in increasing order. */
+	TArray<int32> EnemyCounts;
+
+	/** Index of the enemy count being measured. */
+	int32 CountIndex;
+
+	/** Number of frames each phase is measured for. */
+	int32 FramesPerPhase;
+
+	/** Phase being measured. */
+	int32 Phase;
+
+	/** Frame of the current phase. */
+	int32 PhaseFrame;
+
+	/** Random stream placing the enemies. Carries on between counts, so earlier enemies stay where they are. */
+	FRandomStream RandomStream;
+
+	/** Value of the significance console variable before the benchmark. */
+	int32 PreviousSignificanceEnable;
+
+	/** Whether each phase is also measured with the behavior trees paused. */
+	bool bMeasureAI;
+
+	/** Whether to quit once the benchmark is complete. */
+	bool bQuitWhenDone;
+
+	/** Whether the benchmark is running. */
+	bool bRunning;
+
+	/** Time of the last benchmark tick, used to measure the frame time. */
+	double LastTickTime;
+
+	/** Frame time accumulated during each phase of the current count, in milliseconds. */
+	double PhaseFrameMs[4];
+
+	/** Lines of the CSV file. */
+	TArray<FString> CsvLines;
+};
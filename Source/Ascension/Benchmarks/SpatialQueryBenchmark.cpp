@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "BenchmarkUtils.h"
+#include "Combat/CombatSpatialHash.h"
+#include "Components/SphereComponent.h"
+
+
+/*
+ * Compares spatial hash queries against engine overlap queries for a number of actors.
+ * Actors with a sphere collision component are spawned at random over an area that grows with the actor count, so the
+ * density of actors stays the same between runs, and both methods run the same radius queries.
+ * @param World			World to run the benchmark in.
+ * @param ActorCount	Number of actors to spawn.
+ * @param NumQueries	Number of queries to run with each method.
+ * @param Radius		Radius of the queries.
+ * @param RandomStream	Random stream used to place actors and queries.
+ * @param CsvLines		Lines of the CSV file the results are appended to.
+ */
+static void RunSpatialQueryBenchmark(UWorld* World, const int32 ActorCount, const int32 NumQueries, const float Radius, FRandomStream& RandomStream, TArray<FString>& CsvLines)
+{
+	// Far above the level so level geometry doesn't affect the overlap queries.
+	const FVector Origin(0.0f, 0.0f, 100000.0f);
+	const float HalfExtent = FMath::Sqrt(float(ActorCount)) * 150.0f;
+	const FCollisionObjectQueryParams ObjectQueryParams(ECC_Pawn);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	TArray<AActor*> Actors;
+	FCombatSpatialHash SpatialHash;
+
+	for (int32 Index = 0; Index < ActorCount; Index++)
+	{
+		const FVector Location = Origin + FVector(RandomStream.FRandRange(-HalfExtent, HalfExtent), RandomStream.FRandRange(-HalfExtent, HalfExtent), 0.0f);
+		AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location), SpawnParameters);
+
+		USphereComponent* Sphere = NewObject<USphereComponent>(Actor);
+		Sphere->InitSphereRadius(40.0f);
+		Sphere->SetCollisionProfileName(UCollisionProfile::Pawn_ProfileName);
+		Sphere->SetWorldLocation(Location);
+		Actor->SetRootComponent(Sphere);
+		Sphere->RegisterComponent();
+
+		Actors.Add(Actor);
+		SpatialHash.Add(Index, Location);
+	}
+
+	TArray<FVector> QueryCenters;
+	for (int32 Index = 0; Index < NumQueries; Index++)
+	{
+		QueryCenters.Add(Origin + FVector(RandomStream.FRandRange(-HalfExtent, HalfExtent), RandomStream.FRandRange(-HalfExtent, HalfExtent), 0.0f));
+	}
+
+	// Spatial hash queries.
+	TArray<int32> Indices;
+	int64 HashResults = 0;
+	uint64 StartCycles = FPlatformTime::Cycles64();
+
+	for (const FVector& Center : QueryCenters)
+	{
+		Indices.Reset();
+		HashResults += SpatialHash.QueryRadius(Center, Radius, Indices);
+	}
+
+	const double HashMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	// Engine overlap queries.
+	TArray<FOverlapResult> Overlaps;
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(Radius);
+	int64 OverlapResults = 0;
+	StartCycles = FPlatformTime::Cycles64();
+
+	for (const FVector& Center : QueryCenters)
+	{
+		Overlaps.Reset();
+		World->OverlapMultiByObjectType(Overlaps, Center, FQuat::Identity, ObjectQueryParams, Shape);
+		OverlapResults += Overlaps.Num();
+	}
+
+	const double OverlapMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	// Incremental updates, moving every point a short distance as it would in a frame.
+	StartCycles = FPlatformTime::Cycles64();
+
+	for (int32 Index = 0; Index < ActorCount; Index++)
+	{
+		SpatialHash.Update(Index, SpatialHash.GetLocation(Index) + FVector(RandomStream.FRandRange(-10.0f, 10.0f), RandomStream.FRandRange(-10.0f, 10.0f), 0.0f));
+	}
+
+	const double UpdateMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	UE_LOG(LogBenchmark, Log, TEXT("Spatial query: %d actors | hash %.2f us/query (%.1f found) | overlap %.2f us/query (%.1f found) | hash update %.3f ms | hash memory %d KB"),
+		   ActorCount, HashMs * 1000.0 / NumQueries, double(HashResults) / NumQueries, OverlapMs * 1000.0 / NumQueries, double(OverlapResults) / NumQueries,
+		   UpdateMs, int32(SpatialHash.GetAllocatedSize() / 1024))
+
+	CsvLines.Add(FString::Printf(TEXT("%d,%d,%.1f,%.3f,%.3f,%.1f,%.1f,%.3f,%d"), ActorCount, NumQueries, Radius, HashMs, OverlapMs,
+								 double(HashResults) / NumQueries, double(OverlapResults) / NumQueries, UpdateMs, int32(SpatialHash.GetAllocatedSize())));
+
+	for (AActor* Actor : Actors)
+	{
+		Actor->Destroy();
+	}
+}
+
+/*
+ * Console command running the spatial query benchmark.
+ * Arguments: Count=<actor count> Counts=<comma separated actor counts> Queries=<queries per run> Radius=<query radius>
+ */
+static FAutoConsoleCommandWithWorldAndArgs SpatialQueryBenchmarkCommand(
+	TEXT("Ascension.Benchmark.SpatialQuery"),
+	TEXT("Compares combat spatial hash queries to engine overlaps. Usage: Ascension.Benchmark.SpatialQuery [Counts=100,500,2000] [Queries=1000] [Radius=500]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		TArray<int32> ActorCounts = { 100, 500, 2000 };
+		int32 NumQueries = 1000;
+		float Radius = 500.0f;
+		FBenchmarkUtils::ParseCounts(Args, ActorCounts);
+
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("Queries="), NumQueries);
+			FParse::Value(*Arg, TEXT("Radius="), Radius);
+		}
+
+		NumQueries = FMath::Max(NumQueries, 1);
+
+		TArray<FString> CsvLines;
+		CsvLines.Add(FString("ActorCount,Queries,Radius,HashMs,OverlapMs,HashAvgFound,OverlapAvgFound,HashUpdateMs,HashBytes"));
+		FRandomStream RandomStream(FBenchmarkUtils::RandomSeed);
+
+		for (const int32 ActorCount : ActorCounts)
+		{
+			RunSpatialQueryBenchmark(World, ActorCount, NumQueries, Radius, RandomStream, CsvLines);
+		}
+
+		FBenchmarkUtils::WriteCsv(TEXT("SpatialQuery"), CsvLines);
+	})
+);
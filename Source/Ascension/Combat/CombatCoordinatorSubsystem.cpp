@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "CombatCoordinatorSubsystem.h"
+#include "Entities/Characters/Enemies/Enemy.h"
+#include "Significance/EnemySignificanceSubsystem.h"
+#include "AIController.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Attacking"), STAT_EnemiesAttacking, STATGROUP_Ascension);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Waiting"), STAT_EnemiesWaiting, STATGROUP_Ascension);
+
+static TAutoConsoleVariable<int32> CVarCombatAttackTokens(
+	TEXT("Ascension.Combat.AttackTokens"),
+	2,
+	TEXT("Number of enemies that can attack a target at once. 0 lets every enemy attack."),
+	ECVF_Default);
+
+
+void UCombatCoordinatorSubsystem::Deinitialize()
+{
+	for (const FCombatant& Combatant : Combatants)
+	{
+		if (UBlackboardComponent* Blackboard = Combatant.Blackboard.Get())
+		{
+			Blackboard->UnregisterObserver(Combatant.WantsObserveKey, Combatant.ObserverHandle);
+		}
+	}
+
+	Combatants.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCombatCoordinatorSubsystem::JoinCombat(AEnemy* Enemy, AActor* Target, const FName WantsAttackKey, const FName WantsObserveKey)
+{
+	AAIController* AIController = Enemy ? Cast<AAIController>(Enemy->GetController()) : nullptr;
+	UBlackboardComponent* Blackboard = AIController ? AIController->GetBlackboardComponent() : nullptr;
+
+	if (Blackboard == nullptr || Target == nullptr)
+	{
+		return;
+	}
+
+	// Sighting the current target again keeps the enemy's token and place in the queue.
+	const int32 ExistingIndex = FindCombatant(Enemy);
+
+	if (ExistingIndex != INDEX_NONE && Combatants[ExistingIndex].Target == Target)
+	{
+		return;
+	}
+
+	LeaveCombat(Enemy);
+
+	FCombatant& Combatant = Combatants.AddDefaulted_GetRef();
+	Combatant.Enemy = Enemy;
+	Combatant.Blackboard = Blackboard;
+	Combatant.Target = Target;
+	Combatant.WantsAttackKey = Blackboard->GetKeyID(WantsAttackKey);
+	Combatant.WantsObserveKey = Blackboard->GetKeyID(WantsObserveKey);
+	Combatant.bHasToken = false;
+
+	// Fighting starts with observing the target.
+	Blackboard->SetValue<UBlackboardKeyType_Bool>(Combatant.WantsObserveKey, false);
+	Combatant.ObserverHandle = Blackboard->RegisterObserver(Combatant.WantsObserveKey, this,
+		FOnBlackboardChangeNotification::CreateUObject(this, &UCombatCoordinatorSubsystem::OnWantsObserveChanged));
+
+	const int32 MaxTokens = CVarCombatAttackTokens.GetValueOnGameThread();
+
+	if (MaxTokens <= 0 || CountTokens(Target) < MaxTokens)
+	{
+		SetHasToken(Combatant, true, false);
+		return;
+	}
+
+	SetHasToken(Combatant, false, false);
+
+	// An attacker between attacks lets the new enemy have a go.
+	const int32 WaiterIndex = Combatants.Num() - 1;
+
+	for (int32 Index = 0; Index < WaiterIndex; Index++)
+	{
+		const FCombatant& Attacker = Combatants[Index];
+		const UBlackboardComponent* AttackerBlackboard = Attacker.Blackboard.Get();
+
+		if (Attacker.bHasToken && Attacker.Target == Target && AttackerBlackboard &&
+			AttackerBlackboard->GetValue<UBlackboardKeyType_Bool>(Attacker.WantsObserveKey))
+		{
+			HandOffToken(Index);
+			break;
+		}
+	}
+}
+
+void UCombatCoordinatorSubsystem::LeaveCombat(AEnemy* Enemy)
+{
+	const int32 Index = FindCombatant(Enemy);
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// The token goes to the enemy that waited longest before the leaving enemy is removed.
+	if (Combatants[Index].bHasToken)
+	{
+		HandOffToken(Index);
+	}
+
+	const int32 LeavingIndex = FindCombatant(Enemy);
+	FCombatant& Combatant = Combatants[LeavingIndex];
+
+	if (UBlackboardComponent* Blackboard = Combatant.Blackboard.Get())
+	{
+		Blackboard->UnregisterObserver(Combatant.WantsObserveKey, Combatant.ObserverHandle);
+	}
+
+	Enemy->SetWaitingToAttack(false);
+	Combatants.RemoveAt(LeavingIndex, 1, false);
+}
+
+bool UCombatCoordinatorSubsystem::CanAttack(const AEnemy* Enemy) const
+{
+	const int32 Index = FindCombatant(Enemy);
+	return Index == INDEX_NONE || Combatants[Index].bHasToken;
+}
+
+void UCombatCoordinatorSubsystem::GetCombatantCounts(const AActor* Target, int32& OutAttackers, int32& OutWaiting) const
+{
+	OutAttackers = 0;
+	OutWaiting = 0;
+
+	for (const FCombatant& Combatant : Combatants)
+	{
+		if (Combatant.Target == Target)
+		{
+			Combatant.bHasToken ? OutAttackers++ : OutWaiting++;
+		}
+	}
+}
+
+EBlackboardNotificationResult UCombatCoordinatorSubsystem::OnWantsObserveChanged(const UBlackboardComponent& Blackboard, FBlackboard::FKey Key)
+{
+	const int32 Index = Combatants.IndexOfByPredicate([&Blackboard](const FCombatant& Combatant) { return Combatant.Blackboard.Get() == &Blackboard; });
+
+	if (Index == INDEX_NONE)
+	{
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	// An attacker done with its attack makes way for the enemy that waited longest.
+	if (Combatants[Index].bHasToken && Blackboard.GetValue<UBlackboardKeyType_Bool>(Key))
+	{
+		HandOffToken(Index);
+	}
+
+	return EBlackboardNotificationResult::ContinueObserving;
+}
+
+bool UCombatCoordinatorSubsystem::HandOffToken(const int32 AttackerIndex)
+{
+	const TWeakObjectPtr<AActor> Target = Combatants[AttackerIndex].Target;
+	const int32 WaiterIndex = Combatants.IndexOfByPredicate([&Target](const FCombatant& Combatant)
+	{
+		return !Combatant.bHasToken && Combatant.Target == Target && Combatant.Enemy.IsValid();
+	});
+
+	if (WaiterIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FCombatant Attacker = Combatants[AttackerIndex];
+	Combatants.RemoveAt(AttackerIndex, 1, false);
+	SetHasToken(Attacker, false, false);
+	Combatants.Add(Attacker);
+
+	SetHasToken(Combatants[AttackerIndex < WaiterIndex ? WaiterIndex - 1 : WaiterIndex], true, true);
+
+	return true;
+}
+
+void UCombatCoordinatorSubsystem::SetHasToken(FCombatant& Combatant, const bool bHasToken, const bool bAttackNow)
+{
+	Combatant.bHasToken = bHasToken;
+	AEnemy* Enemy = Combatant.Enemy.Get();
+
+	if (Enemy == nullptr)
+	{
+		return;
+	}
+
+	Enemy->SetWaitingToAttack(!bHasToken);
+
+	if (bHasToken)
+	{
+		// Attackers get their full update rates back straight away. Waiting enemies slow down on the next significance update.
+		if (UEnemySignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>())
+		{
+			SignificanceSubsystem->MakeSignificant(Enemy);
+		}
+
+		if (bAttackNow)
+		{
+			if (UBlackboardComponent* Blackboard = Combatant.Blackboard.Get())
+			{
+				Blackboard->SetValue<UBlackboardKeyType_Bool>(Combatant.WantsObserveKey, false);
+				Blackboard->SetValue<UBlackboardKeyType_Bool>(Combatant.WantsAttackKey, true);
+			}
+		}
+	}
+
+	int32 NumAttacking = 0;
+
+	for (const FCombatant& Other : Combatants)
+	{
+		NumAttacking += Other.bHasToken ? 1 : 0;
+	}
+
+	SET_DWORD_STAT(STAT_EnemiesAttacking, NumAttacking);
+	SET_DWORD_STAT(STAT_EnemiesWaiting, Combatants.Num() - NumAttacking);
+}
+
+int32 UCombatCoordinatorSubsystem::CountTokens(const AActor* Target) const
+{
+	int32 NumTokens = 0;
+
+	for (const FCombatant& Combatant : Combatants)
+	{
+		if (Combatant.bHasToken && Combatant.Target == Target)
+		{
+			NumTokens++;
+		}
+	}
+
+	return NumTokens;
+}
+
+int32 UCombatCoordinatorSubsystem::FindCombatant(const AEnemy* Enemy) const
+{
+	return Combatants.IndexOfByPredicate([Enemy](const FCombatant& Combatant) { return Combatant.Enemy.Get() == Enemy; });
+}
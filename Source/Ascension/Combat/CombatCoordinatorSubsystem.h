@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "CombatCoordinatorSubsystem.generated.h"
+
+
+/*
+ * Enemy fighting a target, and whether it holds one of the target's attack tokens.
+ */
+struct FCombatant
+{
+	/** The enemy. */
+	TWeakObjectPtr<class AEnemy> Enemy;
+
+	/** The enemy's blackboard. */
+	TWeakObjectPtr<UBlackboardComponent> Blackboard;
+
+	/** Actor the enemy is fighting. */
+	TWeakObjectPtr<AActor> Target;
+
+	/** Blackboard key signalling the enemy wants to attack. */
+	FBlackboard::FKey WantsAttackKey;
+
+	/** Blackboard key signalling the enemy wants to observe. */
+	FBlackboard::FKey WantsObserveKey;
+
+	/** Handle of the observer of the wants observe key. */
+	FDelegateHandle ObserverHandle;
+
+	/** Whether the enemy holds an attack token. */
+	bool bHasToken;
+};
+
+/*
+ * Subsystem coordinating the enemies fighting each target, so only a few of them attack at once.
+ *
+ * Each target has a limited number of attack tokens. Enemies joining combat take a free token, or wait for one. Enemies
+ * without a token circle the target without attacking, and have their update rates lowered like visible enemies, so
+ * only the attackers pay the full AI, movement and animation cost.
+ *
+ * Tokens are handed off through the enemies' blackboards rather than polled: when an attacker's wants observe key is
+ * set after its attack, its token goes to the enemy that has waited longest, which has its wants attack key set.
+ * An enemy starting to wait also takes the token of an attacker that is observing.
+ */
+UCLASS()
+class ASCENSION_API UCombatCoordinatorSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Subsystem functions. */
+	virtual void Deinitialize() override;
+
+	/*
+	 * Adds an enemy to the fight against a target, giving it an attack token if one is free.
+	 * @param Enemy				The enemy.
+	 * @param Target			Actor the enemy fights.
+	 * @param WantsAttackKey	Name of the blackboard key signalling the enemy wants to attack.
+	 * @param WantsObserveKey	Name of the blackboard key signalling the enemy wants to observe.
+	 */
+	void JoinCombat(class AEnemy* Enemy, AActor* Target, const FName WantsAttackKey, const FName WantsObserveKey);
+
+	/*
+	 * Removes an enemy from the fight, handing its attack token to the next waiting enemy.
+	 * @param Enemy		The enemy.
+	 */
+	void LeaveCombat(class AEnemy* Enemy);
+
+	/*
+	 * Checks whether an enemy may attack: it holds an attack token, or isn't coordinated.
+	 * @param Enemy		The enemy.
+	 */
+	bool CanAttack(const class AEnemy* Enemy) const;
+
+	/*
+	 * Gets the number of enemies fighting a target.
+	 * @param Target		The target.
+	 * @param OutAttackers	Number of enemies holding an attack token.
+	 * @param OutWaiting	Number of enemies waiting for one.
+	 */
+	void GetCombatantCounts(const AActor* Target, int32& OutAttackers, int32& OutWaiting) const;
+
+private:
+	/*
+	 * Called when the wants observe key of a combatant changes.
+	 * @param Blackboard	The combatant's blackboard.
+	 * @param Key			The changed key.
+	 * @returns EBlackboardNotificationResult	Whether to keep observing the key.
+	 */
+	EBlackboardNotificationResult OnWantsObserveChanged(const UBlackboardComponent& Blackboard, FBlackboard::FKey Key);
+
+	/*
+	 * Gives the token of an attacker to the enemy fighting the same target that has waited longest, if any.
+	 * The attacker goes to the back of the queue.
+	 * @param AttackerIndex		Index of the attacker in the combatants.
+	 * @returns bool			Whether the token was handed off.
+	 */
+	bool HandOffToken(const int32 AttackerIndex);
+
+	/*
+	 * Gives or takes an attack token, and sets the enemy's update rates to match.
+	 * @param Combatant		The combatant.
+	 * @param bHasToken		Whether the combatant holds a token.
+	 * @param bAttackNow	Whether to set the combatant's wants attack key.
+	 */
+	void SetHasToken(FCombatant& Combatant, const bool bHasToken, const bool bAttackNow);
+
+	/*
+	 * Counts the tokens held by the enemies fighting a target.
+	 * @param Target	The target.
+	 */
+	int32 CountTokens(const AActor* Target) const;
+
+	/*
+	 * Finds the combatant of an enemy.
+	 * @param Enemy		The enemy.
+	 * @returns int32	Index of the combatant. INDEX_NONE if the enemy isn't fighting.
+	 */
+	int32 FindCombatant(const class AEnemy* Enemy) const;
+
+private:
+	/** Enemies fighting, in the order they started waiting for a token. */
+	TArray<FCombatant> Combatants;
+};
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "CombatSpatialHash.h"
+
+
+FCombatSpatialHash::FCombatSpatialHash(const float InCellSize)
+	: CellSize(FMath::Max(InCellSize, 1.0f))
+	, InvCellSize(1.0f / FMath::Max(InCellSize, 1.0f))
+	, NumPoints(0)
+{
+}
+
+void FCombatSpatialHash::Add(const int32 Index, const FVector& Location)
+{
+	check(Index >= 0);
+
+	if (Contains(Index))
+	{
+		Update(Index, Location);
+		return;
+	}
+
+	if (Index >= Occupied.Num())
+	{
+		const int32 NewNum = Index + 1;
+		PositionsX.SetNumZeroed(NewNum);
+		PositionsY.SetNumZeroed(NewNum);
+		PositionsZ.SetNumZeroed(NewNum);
+		CellKeys.SetNumZeroed(NewNum);
+		NextInCell.SetNumZeroed(NewNum);
+		PrevInCell.SetNumZeroed(NewNum);
+		Occupied.Add(false, NewNum - Occupied.Num());
+	}
+
+	PositionsX[Index] = Location.X;
+	PositionsY[Index] = Location.Y;
+	PositionsZ[Index] = Location.Z;
+	Occupied[Index] = true;
+	NumPoints++;
+
+	LinkToCell(Index, GetCellKey(Location));
+}
+
+void FCombatSpatialHash::Remove(const int32 Index)
+{
+	if (!Contains(Index))
+	{
+		return;
+	}
+
+	UnlinkFromCell(Index);
+	Occupied[Index] = false;
+	NumPoints--;
+}
+
+void FCombatSpatialHash::Update(const int32 Index, const FVector& Location)
+{
+	if (!Contains(Index))
+	{
+		return;
+	}
+
+	PositionsX[Index] = Location.X;
+	PositionsY[Index] = Location.Y;
+	PositionsZ[Index] = Location.Z;
+
+	// Most moves stay within the same cell.
+	const uint64 CellKey = GetCellKey(Location);
+
+	if (CellKey != CellKeys[Index])
+	{
+		UnlinkFromCell(Index);
+		LinkToCell(Index, CellKey);
+	}
+}
+
+void FCombatSpatialHash::Reset()
+{
+	PositionsX.Reset();
+	PositionsY.Reset();
+	PositionsZ.Reset();
+	CellKeys.Reset();
+	NextInCell.Reset();
+	PrevInCell.Reset();
+	Occupied.Reset();
+	CellHeads.Reset();
+	NumPoints = 0;
+}
+
+template <typename PredicateType>
+int32 FCombatSpatialHash::QueryCells(const FVector& Min, const FVector& Max, PredicateType Predicate, TArray<int32>& OutIndices) const
+{
+	const int32 MinCellX = FMath::FloorToInt(Min.X * InvCellSize);
+	const int32 MinCellY = FMath::FloorToInt(Min.Y * InvCellSize);
+	const int32 MaxCellX = FMath::FloorToInt(Max.X * InvCellSize);
+	const int32 MaxCellY = FMath::FloorToInt(Max.Y * InvCellSize);
+	const int32 StartNum = OutIndices.Num();
+
+	auto GatherCell = [this, &Min, &Max, &Predicate, &OutIndices](int32 Index)
+	{
+		for (; Index != INDEX_NONE; Index = NextInCell[Index])
+		{
+			const FVector Location(PositionsX[Index], PositionsY[Index], PositionsZ[Index]);
+
+			if (Location.Z >= Min.Z && Location.Z <= Max.Z && Predicate(Location))
+			{
+				OutIndices.Add(Index);
+			}
+		}
+	};
+
+	// Large queries visit the occupied cells instead of every cell they cover.
+	const int64 NumCells = int64(MaxCellX - MinCellX + 1) * int64(MaxCellY - MinCellY + 1);
+
+	if (NumCells > CellHeads.Num())
+	{
+		for (const TPair<uint64, int32>& CellHead : CellHeads)
+		{
+			const int32 CellX = int32(uint32(CellHead.Key >> 32));
+			const int32 CellY = int32(uint32(CellHead.Key));
+
+			if (CellX >= MinCellX && CellX <= MaxCellX && CellY >= MinCellY && CellY <= MaxCellY)
+			{
+				GatherCell(CellHead.Value);
+			}
+		}
+	}
+	else
+	{
+		for (int32 CellX = MinCellX; CellX <= MaxCellX; CellX++)
+		{
+			for (int32 CellY = MinCellY; CellY <= MaxCellY; CellY++)
+			{
+				if (const int32* CellHead = CellHeads.Find(MakeCellKey(CellX, CellY)))
+				{
+					GatherCell(*CellHead);
+				}
+			}
+		}
+	}
+
+	return OutIndices.Num() - StartNum;
+}
+
+int32 FCombatSpatialHash::QueryRadius(const FVector& Center, const float Radius, TArray<int32>& OutIndices) const
+{
+	const float RadiusSquared = Radius * Radius;
+
+	return QueryCells(Center - FVector(Radius), Center + FVector(Radius), [&Center, RadiusSquared](const FVector& Location)
+	{
+		return FVector::DistSquared(Location, Center) <= RadiusSquared;
+	}, OutIndices);
+}
+
+int32 FCombatSpatialHash::QueryCone(const FVector& Origin, const FVector& Direction, const float Radius, const float HalfAngleDegrees, TArray<int32>& OutIndices) const
+{
+	const float RadiusSquared = Radius * Radius;
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(HalfAngleDegrees));
+
+	return QueryCells(Origin - FVector(Radius), Origin + FVector(Radius), [&Origin, &Direction, RadiusSquared, CosHalfAngle](const FVector& Location)
+	{
+		const FVector Offset = Location - Origin;
+		const float DistanceSquared = Offset.SizeSquared();
+
+		if (DistanceSquared > RadiusSquared)
+		{
+			return false;
+		}
+
+		return DistanceSquared <= KINDA_SMALL_NUMBER || FVector::DotProduct(Offset, Direction) >= CosHalfAngle * FMath::Sqrt(DistanceSquared);
+	}, OutIndices);
+}
+
+int32 FCombatSpatialHash::QueryCapsule(const FVector& Start, const FVector& End, const float Radius, TArray<int32>& OutIndices) const
+{
+	const float RadiusSquared = Radius * Radius;
+	const FVector Min = Start.ComponentMin(End) - FVector(Radius);
+	const FVector Max = Start.ComponentMax(End) + FVector(Radius);
+
+	return QueryCells(Min, Max, [&Start, &End, RadiusSquared](const FVector& Location)
+	{
+		return FMath::PointDistToSegmentSquared(Location, Start, End) <= RadiusSquared;
+	}, OutIndices);
+}
+
+SIZE_T FCombatSpatialHash::GetAllocatedSize() const
+{
+	return PositionsX.GetAllocatedSize() + PositionsY.GetAllocatedSize() + PositionsZ.GetAllocatedSize() + CellKeys.GetAllocatedSize() +
+		NextInCell.GetAllocatedSize() + PrevInCell.GetAllocatedSize() + Occupied.GetAllocatedSize() + CellHeads.GetAllocatedSize();
+}
+
+void FCombatSpatialHash::LinkToCell(const int32 Index, const uint64 CellKey)
+{
+	const int32* CellHead = CellHeads.Find(CellKey);
+	const int32 Next = CellHead ? *CellHead : INDEX_NONE;
+
+	CellKeys[Index] = CellKey;
+	PrevInCell[Index] = INDEX_NONE;
+	NextInCell[Index] = Next;
+
+	if (Next != INDEX_NONE)
+	{
+		PrevInCell[Next] = Index;
+	}
+
+	CellHeads.Add(CellKey, Index);
+}
+
+void FCombatSpatialHash::UnlinkFromCell(const int32 Index)
+{
+	const int32 Prev = PrevInCell[Index];
+	const int32 Next = NextInCell[Index];
+
+	if (Next != INDEX_NONE)
+	{
+		PrevInCell[Next] = Prev;
+	}
+
+	if (Prev != INDEX_NONE)
+	{
+		NextInCell[Prev] = Next;
+	}
+	else if (Next != INDEX_NONE)
+	{
+		CellHeads[CellKeys[Index]] = Next;
+	}
+	else
+	{
+		CellHeads.Remove(CellKeys[Index]);
+	}
+}
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+ * Uniform grid over the XY plane, holding points by index.
+ * Positions are stored as separate component arrays indexed by point index, and each cell is a doubly linked list
+ * threaded through the point arrays, so moving a point between cells doesn't allocate.
+ * Queries append the indices of the matching points to an output array.
+ */
+struct ASCENSION_API FCombatSpatialHash
+{
+public:
+	/*
+	 * Constructor of the spatial hash.
+	 * @param InCellSize	Length of the side of a cell.
+	 */
+	explicit FCombatSpatialHash(const float InCellSize = 500.0f);
+
+	/*
+	 * Adds a point, or moves it if it is already in the hash.
+	 * @param Index		Index of the point.
+	 * @param Location	Location of the point.
+	 */
+	void Add(const int32 Index, const FVector& Location);
+
+	/*
+	 * Removes a point.
+	 * @param Index		Index of the point.
+	 */
+	void Remove(const int32 Index);
+
+	/*
+	 * Moves a point that is in the hash.
+	 * @param Index		Index of the point.
+	 * @param Location	New location of the point.
+	 */
+	void Update(const int32 Index, const FVector& Location);
+
+	/*
+	 * Removes every point.
+	 */
+	void Reset();
+
+	/*
+	 * Checks whether a point is in the hash.
+	 * @param Index		Index of the point.
+	 */
+	FORCEINLINE bool Contains(const int32 Index) const { return Index >= 0 && Index < Occupied.Num() && Occupied[Index]; }
+
+	/*
+	 * Gets the location of a point in the hash.
+	 * @param Index		Index of the point.
+	 */
+	FORCEINLINE FVector GetLocation(const int32 Index) const { return FVector(PositionsX[Index], PositionsY[Index], PositionsZ[Index]); }
+
+	/*
+	 * Finds the points within a sphere.
+	 * @param Center		Center of the sphere.
+	 * @param Radius		Radius of the sphere.
+	 * @param OutIndices	Array the indices of the points found are appended to.
+	 * @returns int32		Number of points found.
+	 */
+	int32 QueryRadius(const FVector& Center, const float Radius, TArray<int32>& OutIndices) const;
+
+	/*
+	 * Finds the points within a cone.
+	 * @param Origin			Apex of the cone.
+	 * @param Direction			Normalized direction of the cone.
+	 * @param Radius			Length of the cone.
+	 * @param HalfAngleDegrees	Angle between the direction and the side of the cone.
+	 * @param OutIndices		Array the indices of the points found are appended to.
+	 * @returns int32			Number of points found.
+	 */
+	int32 QueryCone(const FVector& Origin, const FVector& Direction, const float Radius, const float HalfAngleDegrees, TArray<int32>& OutIndices) const;
+
+	/*
+	 * Finds the points within a capsule.
+	 * @param Start			Center of the start of the capsule.
+	 * @param End			Center of the end of the capsule.
+	 * @param Radius		Radius of the capsule.
+	 * @param OutIndices	Array the indices of the points found are appended to.
+	 * @returns int32		Number of points found.
+	 */
+	int32 QueryCapsule(const FVector& Start, const FVector& End, const float Radius, TArray<int32>& OutIndices) const;
+
+	/*
+	 * Returns the number of points in the hash.
+	 */
+	FORCEINLINE int32 Num() const { return NumPoints; }
+
+	/*
+	 * Returns the memory allocated by the hash, in bytes.
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/*
+	 * Calls a predicate for every point in the cells overlapping a box, adding the points it accepts.
+	 * @param Min			Minimum corner of the box.
+	 * @param Max			Maximum corner of the box.
+	 * @param Predicate		Predicate taking the location of a point.
+	 * @param OutIndices	Array the indices of the accepted points are appended to.
+	 * @returns int32		Number of points accepted.
+	 */
+	template <typename PredicateType>
+	int32 QueryCells(const FVector& Min, const FVector& Max, PredicateType Predicate, TArray<int32>& OutIndices) const;
+
+	/*
+	 * Gets the key of the cell containing a location.
+	 * @param Location	The location.
+	 */
+	FORCEINLINE uint64 GetCellKey(const FVector& Location) const
+	{
+		return MakeCellKey(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize));
+	}
+
+	/*
+	 * Makes the key of a cell from its coordinates.
+	 * @param CellX		X coordinate of the cell.
+	 * @param CellY		Y coordinate of the cell.
+	 */
+	static FORCEINLINE uint64 MakeCellKey(const int32 CellX, const int32 CellY)
+	{
+		return (uint64(uint32(CellX)) << 32) | uint64(uint32(CellY));
+	}
+
+	/** Links a point into the list of its cell. */
+	void LinkToCell(const int32 Index, const uint64 CellKey);
+
+	/** Unlinks a point from the list of its cell. */
+	void UnlinkFromCell(const int32 Index);
+
+private:
+	/** Length of the side of a cell. */
+	float CellSize;
+
+	/** Inverse of the cell size. */
+	float InvCellSize;
+
+	/** Number of points in the hash. */
+	int32 NumPoints;
+
+	/** Position components of the points. */
+	TArray<float> PositionsX;
+	TArray<float> PositionsY;
+	TArray<float> PositionsZ;
+
+	/** Key of the cell of each point. */
+	TArray<uint64> CellKeys;
+
+	/** Next and previous point in the cell of each point. INDEX_NONE at the ends of the list. */
+	TArray<int32> NextInCell;
+	TArray<int32> PrevInCell;
+
+	/** Whether each index holds a point. */
+	TBitArray<> Occupied;
+
+	/** First point of each non-empty cell. */
+	TMap<uint64, int32> CellHeads;
+};
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "DamageableSubsystem.h"
+#include "Entities/Characters/GameCharacter.h"
+#include "Algo/StableSort.h"
+
+DECLARE_CYCLE_STAT(TEXT("Resolve Hits"), STAT_ResolveHits, STATGROUP_Ascension);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hits Resolved"), STAT_HitsResolved, STATGROUP_Ascension);
+
+
+void UDamageableSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UDamageableSubsystem::ResolveQueuedHits);
+}
+
+void UDamageableSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	for (int32 CombatIndex = 0; CombatIndex < TrackedComponents.Num(); CombatIndex++)
+	{
+		if (USceneComponent* Component = TrackedComponents[CombatIndex].Get())
+		{
+			Component->TransformUpdated.Remove(TransformUpdatedHandles[CombatIndex]);
+		}
+	}
+
+	QueuedHits.Empty();
+	ResolvingHits.Empty();
+	TrackedComponents.Empty();
+	TransformUpdatedHandles.Empty();
+	SpatialHash.Reset();
+	Damageables.Empty();
+	CombatIndexMap.Empty();
+	FreeIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UDamageableSubsystem::RegisterDamageable(AActor* Actor)
+{
+	if (Actor == nullptr || !Actor->Implements<UDamageable>())
+	{
+		return INDEX_NONE;
+	}
+
+	if (const int32* ExistingIndex = CombatIndexMap.Find(Actor))
+	{
+		return *ExistingIndex;
+	}
+
+	int32 CombatIndex = INDEX_NONE;
+
+	if (FreeIndices.Num() > 0)
+	{
+		CombatIndex = FreeIndices.Pop(false);
+		Damageables[CombatIndex] = Actor;
+	}
+	else
+	{
+		CombatIndex = Damageables.Add(Actor);
+		TrackedComponents.AddDefaulted();
+		TransformUpdatedHandles.AddDefaulted();
+	}
+
+	CombatIndexMap.Add(Actor, CombatIndex);
+	SpatialHash.Add(CombatIndex, Actor->GetActorLocation());
+
+	if (USceneComponent* RootComponent = Actor->GetRootComponent())
+	{
+		TrackedComponents[CombatIndex] = RootComponent;
+		TransformUpdatedHandles[CombatIndex] = RootComponent->TransformUpdated.AddUObject(this, &UDamageableSubsystem::OnDamageableMoved, CombatIndex);
+	}
+
+	Actor->OnEndPlay.AddUniqueDynamic(this, &UDamageableSubsystem::OnDamageableEndPlay);
+
+	return CombatIndex;
+}
+
+void UDamageableSubsystem::UnregisterDamageable(AActor* Actor)
+{
+	int32 CombatIndex = INDEX_NONE;
+
+	if (Actor && CombatIndexMap.RemoveAndCopyValue(Actor, CombatIndex))
+	{
+		if (USceneComponent* Component = TrackedComponents[CombatIndex].Get())
+		{
+			Component->TransformUpdated.Remove(TransformUpdatedHandles[CombatIndex]);
+		}
+
+		TrackedComponents[CombatIndex].Reset();
+		TransformUpdatedHandles[CombatIndex].Reset();
+		SpatialHash.Remove(CombatIndex);
+		Damageables[CombatIndex] = nullptr;
+		FreeIndices.Add(CombatIndex);
+		Actor->OnEndPlay.RemoveDynamic(this, &UDamageableSubsystem::OnDamageableEndPlay);
+	}
+}
+
+int32 UDamageableSubsystem::GetCombatIndex(AActor* Actor)
+{
+	// Game characters cache their index, so only other damageable actors need the map.
+	const AGameCharacter* GameCharacter = Cast<AGameCharacter>(Actor);
+
+	if (GameCharacter && GameCharacter->GetCombatIndex() != INDEX_NONE)
+	{
+		return GameCharacter->GetCombatIndex();
+	}
+
+	return RegisterDamageable(Actor);
+}
+
+AActor* UDamageableSubsystem::GetDamageable(const int32 CombatIndex) const
+{
+	return Damageables.IsValidIndex(CombatIndex) ? Damageables[CombatIndex] : nullptr;
+}
+
+void UDamageableSubsystem::OnDamageableMoved(USceneComponent* Component, EUpdateTransformFlags UpdateFlags, ETeleportType Teleport, int32 CombatIndex)
+{
+	SpatialHash.Update(CombatIndex, Component->GetComponentLocation());
+}
+
+void UDamageableSubsystem::OnDamageableEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterDamageable(Actor);
+}
+
+void UDamageableSubsystem::ResolveQueuedHits(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || QueuedHits.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ResolveHits);
+	INC_DWORD_STAT_BY(STAT_HitsResolved, QueuedHits.Num());
+
+	// Hits caused while resolving are queued for the next frame.
+	Swap(QueuedHits, ResolvingHits);
+
+	// Group hits by target. The sort is stable so hits on a target keep the order they were queued in.
+	Algo::StableSortBy(ResolvingHits, &FCombatHitRecord::TargetIndex);
+
+	int32 Index = 0;
+
+	while (Index < ResolvingHits.Num())
+	{
+		const int32 TargetIndex = ResolvingHits[Index].TargetIndex;
+		const FCombatHitRecord* StrongestHit = &ResolvingHits[Index];
+		float TotalDamage = 0.0f;
+		int32 NumHits = 0;
+
+		for (; Index < ResolvingHits.Num() && ResolvingHits[Index].TargetIndex == TargetIndex; Index++)
+		{
+			const FCombatHitRecord& HitRecord = ResolvingHits[Index];
+			TotalDamage += HitRecord.Damage;
+			NumHits++;
+
+			if (HitRecord.Damage > StrongestHit->Damage)
+			{
+				StrongestHit = &HitRecord;
+			}
+		}
+
+		AActor* Target = GetDamageable(TargetIndex);
+
+		if (Target == nullptr)
+		{
+			continue;
+		}
+
+		FResolvedHit ResolvedHit;
+		ResolvedHit.SourceActor = IsValid(StrongestHit->SourceActor) ? StrongestHit->SourceActor : nullptr;
+		ResolvedHit.Damage = TotalDamage;
+		ResolvedHit.HitEffect = StrongestHit->HitEffect;
+		ResolvedHit.AttackEffect = StrongestHit->AttackEffect;
+		ResolvedHit.HitPoint = StrongestHit->HitPoint;
+		ResolvedHit.NumHits = NumHits;
+
+		// Actors that only implement the interface in Blueprint have no native interface to call.
+		if (IDamageable* Damageable = Cast<IDamageable>(Target))
+		{
+			Damageable->ApplyResolvedHit(ResolvedHit);
+		}
+		else
+		{
+			IDamageable::Execute_ApplyHitEffect(Target, ResolvedHit.SourceActor, ResolvedHit.Damage, ResolvedHit.HitEffect, ResolvedHit.AttackEffect);
+		}
+	}
+
+	ResolvingHits.Reset();
+}
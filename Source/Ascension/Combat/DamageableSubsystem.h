@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Interfaces/Damageable.h"
+#include "Combat/CombatSpatialHash.h"
+#include "DamageableSubsystem.generated.h"
+
+
+/*
+ * Subsystem keeping track of every damageable actor in the world.
+ * Each damageable actor is given a combat index that stays the same for as long as the actor is in play, so combat
+ * code can keep per-actor state in flat arrays and bit sets instead of searching arrays of actors.
+ * Indices of actors that leave play are reused.
+ *
+ * The location of every registered actor is kept in a spatial hash, updated whenever the actor's root component moves,
+ * so finding the damageable actors near a point doesn't need physics queries or iterating actors.
+ *
+ * Hits on damageable actors are also queued here and resolved once per frame, after every actor has ticked. Hits are
+ * resolved in order of target, and multiple hits on the same target are combined so each target takes its damage
+ * and reacts only once per frame.
+ */
+UCLASS()
+class ASCENSION_API UDamageableSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Subsystem functions. */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/*
+	 * Registers a damageable actor. The actor is unregistered automatically when it exits play.
+	 * @param Actor		Actor to register.
+	 * @returns int32	Combat index of the actor. INDEX_NONE if the actor isn't damageable.
+	 */
+	int32 RegisterDamageable(AActor* Actor);
+
+	/*
+	 * Unregisters a damageable actor, freeing its combat index.
+	 * @param Actor		Actor to unregister.
+	 */
+	void UnregisterDamageable(AActor* Actor);
+
+	/*
+	 * Gets the combat index of a damageable actor, registering it if necessary.
+	 * @param Actor		Actor to get the index of.
+	 * @returns int32	Combat index of the actor. INDEX_NONE if the actor isn't damageable.
+	 */
+	int32 GetCombatIndex(AActor* Actor);
+
+	/*
+	 * Gets the actor with a combat index.
+	 * @param CombatIndex	Combat index of the actor.
+	 * @returns AActor*		The actor, or null if no actor has the index.
+	 */
+	AActor* GetDamageable(const int32 CombatIndex) const;
+
+	/*
+	 * Returns the number of combat indices in use or free. Every combat index is below this.
+	 */
+	FORCEINLINE int32 GetNumCombatIndices() const { return Damageables.Num(); }
+
+	/*
+	 * Queues a hit to be resolved at the end of the frame.
+	 * @param HitRecord		The hit.
+	 */
+	FORCEINLINE void QueueHit(const FCombatHitRecord& HitRecord) { QueuedHits.Add(HitRecord); }
+
+	/*
+	 * Finds the damageable actors within a sphere.
+	 * @param Center		Center of the sphere.
+	 * @param Radius		Radius of the sphere.
+	 * @param OutIndices	Array the combat indices of the actors found are appended to.
+	 * @returns int32		Number of actors found.
+	 */
+	FORCEINLINE int32 QueryRadius(const FVector& Center, const float Radius, TArray<int32>& OutIndices) const
+	{
+		return SpatialHash.QueryRadius(Center, Radius, OutIndices);
+	}
+
+	/*
+	 * Finds the damageable actors within a cone.
+	 * @param Origin			Apex of the cone.
+	 * @param Direction			Normalized direction of the cone.
+	 * @param Radius			Length of the cone.
+	 * @param HalfAngleDegrees	Angle between the direction and the side of the cone.
+	 * @param OutIndices		Array the combat indices of the actors found are appended to.
+	 * @returns int32			Number of actors found.
+	 */
+	FORCEINLINE int32 QueryCone(const FVector& Origin, const FVector& Direction, const float Radius, const float HalfAngleDegrees, TArray<int32>& OutIndices) const
+	{
+		return SpatialHash.QueryCone(Origin, Direction, Radius, HalfAngleDegrees, OutIndices);
+	}
+
+	/*
+	 * Finds the damageable actors within a capsule.
+	 * @param Start			Center of the start of the capsule.
+	 * @param End			Center of the end of the capsule.
+	 * @param Radius		Radius of the capsule.
+	 * @param OutIndices	Array the combat indices of the actors found are appended to.
+	 * @returns int32		Number of actors found.
+	 */
+	FORCEINLINE int32 QueryCapsule(const FVector& Start, const FVector& End, const float Radius, TArray<int32>& OutIndices) const
+	{
+		return SpatialHash.QueryCapsule(Start, End, Radius, OutIndices);
+	}
+
+	/*
+	 * Gets the spatial hash holding the locations of the damageable actors, indexed by combat index.
+	 */
+	FORCEINLINE const FCombatSpatialHash& GetSpatialHash() const { return SpatialHash; }
+
+private:
+	/*
+	 * Resolves the hits queued during the frame.
+	 * @param World			World that finished ticking actors.
+	 * @param TickType		Type of the tick.
+	 * @param DeltaSeconds	Time since the last tick.
+	 */
+	void ResolveQueuedHits(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/*
+	 * Called when the root component of a registered actor moves.
+	 * @param Component		The root component.
+	 * @param UpdateFlags	Flags of the transform update.
+	 * @param Teleport		Whether the component was teleported.
+	 * @param CombatIndex	Combat index of the actor.
+	 */
+	void OnDamageableMoved(USceneComponent* Component, EUpdateTransformFlags UpdateFlags, ETeleportType Teleport, int32 CombatIndex);
+
+	/** Called when a registered actor exits play. */
+	UFUNCTION()
+	void OnDamageableEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+private:
+	/** Registered actors, indexed by combat index. Free indices hold null. */
+	UPROPERTY(Transient)
+	TArray<AActor*> Damageables;
+
+	/** Map of registered actors to their combat index. */
+	TMap<const AActor*, int32> CombatIndexMap;
+
+	/** Combat indices that can be reused. */
+	TArray<int32> FreeIndices;
+
+	/** Root components whose movement is tracked, indexed by combat index. */
+	TArray<TWeakObjectPtr<USceneComponent>> TrackedComponents;
+
+	/** Handles of the transform update delegates of the tracked components, indexed by combat index. */
+	TArray<FDelegateHandle> TransformUpdatedHandles;
+
+	/** Locations of the registered actors. */
+	FCombatSpatialHash SpatialHash;
+
+	/** Hits queued during the current frame. */
+	TArray<FCombatHitRecord> QueuedHits;
+
+	/** Hits being resolved. Kept between frames to reuse its allocation. */
+	TArray<FCombatHitRecord> ResolvingHits;
+
+	/** Handle of the post actor tick delegate. */
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,455 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "LockOnSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lock-On Refresh"), STAT_LockOnRefresh, STATGROUP_Ascension);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lock-On Candidates"), STAT_LockOnCandidates, STATGROUP_Ascension);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lock-On Traces"), STAT_LockOnTraces, STATGROUP_Ascension);
+
+static TAutoConsoleVariable<float> CVarLockOnRefreshInterval(
+	TEXT("Ascension.LockOn.RefreshInterval"),
+	0.1f,
+	TEXT("Time in seconds between refreshes of the lock-on candidates."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLockOnMaxDistance(
+	TEXT("Ascension.LockOn.MaxDistance"),
+	2500.0f,
+	TEXT("Distance from the player within which actors can be locked on to."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLockOnMaxAngle(
+	TEXT("Ascension.LockOn.MaxAngle"),
+	60.0f,
+	TEXT("Horizontal angle from the view direction, in degrees, within which actors can be locked on to."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLockOnAngleWeight(
+	TEXT("Ascension.LockOn.AngleWeight"),
+	1.0f,
+	TEXT("Weight of the angle from the view direction in the score of a lock-on candidate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLockOnDistanceWeight(
+	TEXT("Ascension.LockOn.DistanceWeight"),
+	0.5f,
+	TEXT("Weight of the distance from the player in the score of a lock-on candidate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarLockOnMaxTraces(
+	TEXT("Ascension.LockOn.MaxTraces"),
+	8,
+	TEXT("Number of best scored lock-on candidates checked for line of sight on each refresh."),
+	ECVF_Default);
+
+/** Sets the best target of a seeker to its highest scored candidate in sight. */
+static void UpdateBestIndex(FLockOnSeeker& Seeker)
+{
+	Seeker.BestIndex = INDEX_NONE;
+
+	for (int32 Index = 0; Index < Seeker.Candidates.Num(); Index++)
+	{
+		const FLockOnCandidate& Candidate = Seeker.Candidates[Index];
+
+		if (!Candidate.bOccluded && (Seeker.BestIndex == INDEX_NONE || Candidate.Score > Seeker.Candidates[Seeker.BestIndex].Score))
+		{
+			Seeker.BestIndex = Index;
+		}
+	}
+}
+
+
+void ULockOnSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	NextSeekerID = 0;
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ULockOnSubsystem::RefreshSeekers);
+}
+
+void ULockOnSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	for (int32 LockIndex = 0; LockIndex < TrackedComponents.Num(); LockIndex++)
+	{
+		if (USceneComponent* Component = TrackedComponents[LockIndex].Get())
+		{
+			Component->TransformUpdated.Remove(TransformUpdatedHandles[LockIndex]);
+		}
+	}
+
+	Seekers.Empty();
+	TrackedComponents.Empty();
+	TransformUpdatedHandles.Empty();
+	SpatialHash.Reset();
+	Lockables.Empty();
+	LockIndexMap.Empty();
+	FreeIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 ULockOnSubsystem::RegisterLockable(AActor* Actor)
+{
+	if (Actor == nullptr || !Actor->Implements<ULockable>())
+	{
+		return INDEX_NONE;
+	}
+
+	if (const int32* ExistingIndex = LockIndexMap.Find(Actor))
+	{
+		return *ExistingIndex;
+	}
+
+	int32 LockIndex = INDEX_NONE;
+
+	if (FreeIndices.Num() > 0)
+	{
+		LockIndex = FreeIndices.Pop(false);
+		Lockables[LockIndex] = Actor;
+	}
+	else
+	{
+		LockIndex = Lockables.Add(Actor);
+		TrackedComponents.AddDefaulted();
+		TransformUpdatedHandles.AddDefaulted();
+	}
+
+	LockIndexMap.Add(Actor, LockIndex);
+	SpatialHash.Add(LockIndex, Actor->GetActorLocation());
+
+	if (USceneComponent* RootComponent = Actor->GetRootComponent())
+	{
+		TrackedComponents[LockIndex] = RootComponent;
+		TransformUpdatedHandles[LockIndex] = RootComponent->TransformUpdated.AddUObject(this, &ULockOnSubsystem::OnLockableMoved, LockIndex);
+	}
+
+	Actor->OnEndPlay.AddUniqueDynamic(this, &ULockOnSubsystem::OnLockableEndPlay);
+
+	return LockIndex;
+}
+
+void ULockOnSubsystem::UnregisterLockable(AActor* Actor)
+{
+	int32 LockIndex = INDEX_NONE;
+
+	if (Actor && LockIndexMap.RemoveAndCopyValue(Actor, LockIndex))
+	{
+		if (USceneComponent* Component = TrackedComponents[LockIndex].Get())
+		{
+			Component->TransformUpdated.Remove(TransformUpdatedHandles[LockIndex]);
+		}
+
+		TrackedComponents[LockIndex].Reset();
+		TransformUpdatedHandles[LockIndex].Reset();
+		SpatialHash.Remove(LockIndex);
+		Lockables[LockIndex] = nullptr;
+		FreeIndices.Add(LockIndex);
+		Actor->OnEndPlay.RemoveDynamic(this, &ULockOnSubsystem::OnLockableEndPlay);
+
+		// The next actor given the index starts out in sight.
+		for (FLockOnSeeker& Seeker : Seekers)
+		{
+			if (Seeker.Occluded.IsValidIndex(LockIndex))
+			{
+				Seeker.Occluded[LockIndex] = false;
+			}
+		}
+	}
+}
+
+void ULockOnSubsystem::RegisterSeeker(APawn* Pawn)
+{
+	if (Pawn == nullptr || FindSeeker(Pawn) != nullptr)
+	{
+		return;
+	}
+
+	FLockOnSeeker& Seeker = Seekers.AddDefaulted_GetRef();
+	Seeker.Pawn = Pawn;
+	Seeker.SeekerID = NextSeekerID++;
+	Seeker.TimeUntilRefresh = 0.0f;
+	Seeker.BestIndex = INDEX_NONE;
+}
+
+void ULockOnSubsystem::UnregisterSeeker(APawn* Pawn)
+{
+	Seekers.RemoveAll([Pawn](const FLockOnSeeker& Seeker) { return Seeker.Pawn == Pawn; });
+}
+
+const FLockOnSeeker* ULockOnSubsystem::FindSeeker(const APawn* Pawn) const
+{
+	return Seekers.FindByPredicate([Pawn](const FLockOnSeeker& Seeker) { return Seeker.Pawn == Pawn; });
+}
+
+AActor* ULockOnSubsystem::FindBestTarget(const APawn* Seeker) const
+{
+	const FLockOnSeeker* LockOnSeeker = FindSeeker(Seeker);
+
+	if (LockOnSeeker == nullptr || LockOnSeeker->BestIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	return LockOnSeeker->Candidates[LockOnSeeker->BestIndex].Actor.Get();
+}
+
+AActor* ULockOnSubsystem::FindNextTarget(const APawn* Seeker, const AActor* Target, const int32 Direction) const
+{
+	const FLockOnSeeker* LockOnSeeker = FindSeeker(Seeker);
+
+	if (LockOnSeeker == nullptr || Direction == 0)
+	{
+		return nullptr;
+	}
+
+	const TArray<FLockOnCandidate>& Candidates = LockOnSeeker->Candidates;
+	const int32 Current = Candidates.IndexOfByPredicate([Target](const FLockOnCandidate& Candidate) { return Candidate.Actor == Target; });
+
+	// A target that is no longer a candidate switches to the best one.
+	if (Current == INDEX_NONE)
+	{
+		return FindBestTarget(Seeker);
+	}
+
+	const int32 Step = Direction > 0 ? 1 : -1;
+
+	for (int32 Index = Current + Step; Candidates.IsValidIndex(Index); Index += Step)
+	{
+		AActor* Actor = Candidates[Index].Actor.Get();
+
+		if (Actor && !Candidates[Index].bOccluded)
+		{
+			return Actor;
+		}
+	}
+
+	return nullptr;
+}
+
+bool ULockOnSubsystem::IsCandidate(const APawn* Seeker, const AActor* Target) const
+{
+	const FLockOnSeeker* LockOnSeeker = FindSeeker(Seeker);
+	return LockOnSeeker && LockOnSeeker->Candidates.ContainsByPredicate([Target](const FLockOnCandidate& Candidate) { return Candidate.Actor == Target; });
+}
+
+void ULockOnSubsystem::SetHeldTarget(const APawn* Seeker, AActor* Target)
+{
+	FLockOnSeeker* LockOnSeeker = Seekers.FindByPredicate([Seeker](const FLockOnSeeker& Other) { return Other.Pawn == Seeker; });
+
+	if (LockOnSeeker)
+	{
+		LockOnSeeker->HeldTarget = Target;
+	}
+}
+
+bool ULockOnSubsystem::IsTargetValid(const APawn* Seeker, const AActor* Target) const
+{
+	const FLockOnSeeker* LockOnSeeker = FindSeeker(Seeker);
+	const int32* LockIndex = Target ? LockIndexMap.Find(Target) : nullptr;
+
+	if (LockOnSeeker == nullptr || LockIndex == nullptr)
+	{
+		return false;
+	}
+
+	const ILockable* Lockable = Cast<ILockable>(Target);
+
+	if (Lockable && !Lockable->CanBeLockedOn())
+	{
+		return false;
+	}
+
+	if (FVector::Dist2D(SpatialHash.GetLocation(*LockIndex), Seeker->GetActorLocation()) > CVarLockOnMaxDistance.GetValueOnGameThread())
+	{
+		return false;
+	}
+
+	return !(LockOnSeeker->Occluded.IsValidIndex(*LockIndex) && LockOnSeeker->Occluded[*LockIndex]);
+}
+
+void ULockOnSubsystem::RefreshSeekers(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || Seekers.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_LockOnRefresh);
+
+	const float RefreshInterval = CVarLockOnRefreshInterval.GetValueOnGameThread();
+
+	for (int32 SeekerIndex = 0; SeekerIndex < Seekers.Num(); SeekerIndex++)
+	{
+		FLockOnSeeker& Seeker = Seekers[SeekerIndex];
+		Seeker.TimeUntilRefresh -= DeltaSeconds;
+
+		if (Seeker.TimeUntilRefresh > 0.0f)
+		{
+			continue;
+		}
+
+		Seeker.TimeUntilRefresh = RefreshInterval;
+		APawn* Pawn = Seeker.Pawn.Get();
+
+		// Targets are picked where the player's input is, so remote players have no candidates.
+		if (Pawn == nullptr || !Pawn->IsLocallyControlled())
+		{
+			Seeker.Candidates.Reset();
+			Seeker.BestIndex = INDEX_NONE;
+			continue;
+		}
+
+		RefreshCandidates(Seeker);
+		SET_DWORD_STAT(STAT_LockOnCandidates, Seeker.Candidates.Num());
+
+		CandidatesRefreshed.Broadcast(Pawn);
+	}
+}
+
+void ULockOnSubsystem::RefreshCandidates(FLockOnSeeker& Seeker)
+{
+	APawn* Pawn = Seeker.Pawn.Get();
+	AController* Controller = Pawn->GetController();
+
+	FVector ViewLocation = Pawn->GetPawnViewLocation();
+	FRotator ViewRotation = Pawn->GetViewRotation();
+
+	if (Controller)
+	{
+		Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	}
+
+	// Candidates are picked on the horizontal plane, so looking up or down doesn't change them.
+	const FRotationMatrix YawRotation(FRotator(0.0f, ViewRotation.Yaw, 0.0f));
+	const FVector ViewForward = YawRotation.GetUnitAxis(EAxis::X);
+	const FVector ViewRight = YawRotation.GetUnitAxis(EAxis::Y);
+
+	const FVector PawnLocation = Pawn->GetActorLocation();
+	const float MaxDistance = CVarLockOnMaxDistance.GetValueOnGameThread();
+	const float MaxAngle = FMath::Clamp(CVarLockOnMaxAngle.GetValueOnGameThread(), 1.0f, 180.0f);
+	const float AngleWeight = CVarLockOnAngleWeight.GetValueOnGameThread();
+	const float DistanceWeight = CVarLockOnDistanceWeight.GetValueOnGameThread();
+
+	// The cone starts at the camera, so it reaches past the player by the length of the camera boom.
+	QueryIndices.Reset();
+	SpatialHash.QueryCone(ViewLocation, ViewForward, MaxDistance + FVector::Dist2D(ViewLocation, PawnLocation), MaxAngle, QueryIndices);
+
+	Seeker.Candidates.Reset();
+
+	for (const int32 LockIndex : QueryIndices)
+	{
+		AActor* Actor = Lockables[LockIndex];
+		const ILockable* Lockable = Cast<ILockable>(Actor);
+
+		// Actors implementing the interface in Blueprint only have no native interface, and can always be locked on to.
+		if (Actor == nullptr || Actor == Pawn || (Lockable && !Lockable->CanBeLockedOn()))
+		{
+			continue;
+		}
+
+		const FVector Location = SpatialHash.GetLocation(LockIndex);
+		const float Distance = FVector::Dist2D(Location, PawnLocation);
+
+		if (Distance > MaxDistance)
+		{
+			continue;
+		}
+
+		const FVector ToTarget = (Location - ViewLocation).GetSafeNormal2D();
+		const float Yaw = FMath::RadiansToDegrees(FMath::Atan2(ToTarget | ViewRight, ToTarget | ViewForward));
+
+		FLockOnCandidate& Candidate = Seeker.Candidates.AddDefaulted_GetRef();
+		Candidate.Actor = Actor;
+		Candidate.LockIndex = LockIndex;
+		Candidate.Score = AngleWeight * (1.0f - FMath::Abs(Yaw) / MaxAngle) + DistanceWeight * (1.0f - Distance / MaxDistance);
+		Candidate.Yaw = Yaw;
+		Candidate.bOccluded = Seeker.Occluded.IsValidIndex(LockIndex) && Seeker.Occluded[LockIndex];
+	}
+
+	// Check line of sight to the best scored candidates. The results are used until their next check.
+	Seeker.Candidates.Sort([](const FLockOnCandidate& A, const FLockOnCandidate& B) { return A.Score > B.Score; });
+
+	UWorld* World = GetWorld();
+	const FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &ULockOnSubsystem::OnLineOfSightTraced, Seeker.SeekerID);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LockOnLineOfSight), false, Pawn);
+	int32 NumTraces = 0;
+
+	auto TraceLineOfSight = [&](AActor* Actor, const int32 LockIndex)
+	{
+		const ILockable* Lockable = Cast<ILockable>(Actor);
+		const FVector TargetLocation = Lockable ? Lockable->GetLockOnLocation() : Actor->GetActorLocation();
+
+		QueryParams.ClearIgnoredActors();
+		QueryParams.AddIgnoredActor(Pawn);
+		QueryParams.AddIgnoredActor(Actor);
+
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Test, ViewLocation, TargetLocation, ECC_Visibility, QueryParams,
+									   FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, LockIndex);
+		NumTraces++;
+	};
+
+	AActor* HeldTarget = Seeker.HeldTarget.Get();
+	bool bHeldTargetTraced = false;
+
+	for (int32 Index = 0; Index < FMath::Min(Seeker.Candidates.Num(), CVarLockOnMaxTraces.GetValueOnGameThread()); Index++)
+	{
+		const FLockOnCandidate& Candidate = Seeker.Candidates[Index];
+		TraceLineOfSight(Candidate.Actor.Get(), Candidate.LockIndex);
+		bHeldTargetTraced |= Candidate.Actor == HeldTarget;
+	}
+
+	// The held target may be outside of the cone or not among the best candidates, but its lock depends on its line of sight.
+	const int32* HeldLockIndex = HeldTarget && !bHeldTargetTraced ? LockIndexMap.Find(HeldTarget) : nullptr;
+
+	if (HeldLockIndex)
+	{
+		TraceLineOfSight(HeldTarget, *HeldLockIndex);
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnTraces, NumTraces);
+
+	// Cache the candidates from left to right for switching targets.
+	Seeker.Candidates.Sort([](const FLockOnCandidate& A, const FLockOnCandidate& B) { return A.Yaw < B.Yaw; });
+	UpdateBestIndex(Seeker);
+}
+
+void ULockOnSubsystem::OnLineOfSightTraced(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum, uint32 SeekerID)
+{
+	FLockOnSeeker* Seeker = Seekers.FindByPredicate([SeekerID](const FLockOnSeeker& Candidate) { return Candidate.SeekerID == SeekerID; });
+
+	if (Seeker == nullptr)
+	{
+		return;
+	}
+
+	const int32 LockIndex = (int32) TraceDatum.UserData;
+	const bool bOccluded = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits) != nullptr;
+
+	if (!Seeker->Occluded.IsValidIndex(LockIndex))
+	{
+		Seeker->Occluded.Add(false, LockIndex + 1 - Seeker->Occluded.Num());
+	}
+
+	Seeker->Occluded[LockIndex] = bOccluded;
+
+	// The cached candidates use the result straight away, so the best target doesn't wait for the next refresh.
+	FLockOnCandidate* Candidate = Seeker->Candidates.FindByPredicate([LockIndex](const FLockOnCandidate& Other) { return Other.LockIndex == LockIndex; });
+
+	if (Candidate && Candidate->bOccluded != bOccluded)
+	{
+		Candidate->bOccluded = bOccluded;
+		UpdateBestIndex(*Seeker);
+	}
+}
+
+void ULockOnSubsystem::OnLockableMoved(USceneComponent* Component, EUpdateTransformFlags UpdateFlags, ETeleportType Teleport, int32 LockIndex)
+{
+	SpatialHash.Update(LockIndex, Component->GetComponentLocation());
+}
+
+void ULockOnSubsystem::OnLockableEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterLockable(Actor);
+}
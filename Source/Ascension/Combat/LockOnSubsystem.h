@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Interfaces/Lockable.h"
+#include "Combat/CombatSpatialHash.h"
+#include "LockOnSubsystem.generated.h"
+
+/** Delegate called after the lock-on candidates of a player are refreshed. */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnLockOnCandidatesRefreshed, APawn* /* Seeker */);
+
+
+/*
+ * Actor a player could lock on to, as of the last refresh.
+ */
+struct FLockOnCandidate
+{
+	/** The lockable actor. */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Lock index of the actor. */
+	int32 LockIndex;
+
+	/** How good a target the actor is. Higher is better. */
+	float Score;
+
+	/** Horizontal angle from the view direction to the actor, in degrees. Negative to the left. */
+	float Yaw;
+
+	/** Whether the actor was out of sight on its last line of sight check. */
+	bool bOccluded;
+};
+
+/*
+ * Player picking lock-on targets, with the candidates found on its last refresh.
+ */
+struct FLockOnSeeker
+{
+	/** The player's pawn. */
+	TWeakObjectPtr<APawn> Pawn;
+
+	/** Identifier of the seeker, passed to its line of sight traces. */
+	uint32 SeekerID;
+
+	/** Time until the candidates are next refreshed. */
+	float TimeUntilRefresh;
+
+	/** Candidates, sorted from left to right. */
+	TArray<FLockOnCandidate> Candidates;
+
+	/** Index of the best target in the candidates. INDEX_NONE if none can be locked on to. */
+	int32 BestIndex;
+
+	/** Result of the last line of sight check to each lockable actor, indexed by lock index. */
+	TBitArray<> Occluded;
+
+	/** Actor the player is locked on to, checked for line of sight on every refresh. */
+	TWeakObjectPtr<AActor> HeldTarget;
+};
+
+/*
+ * Subsystem picking the actors players lock on to.
+ *
+ * Lockable actors are registered with a lock index, and their locations are kept in a spatial hash, updated whenever
+ * their root component moves. Each locally controlled player registered as a seeker has its candidates refreshed at
+ * an interval: the actors in a cone in front of its view are scored by angle and distance, and the best few are
+ * checked for line of sight with asynchronous traces whose results are used by the next refresh. The actor a player
+ * is locked on to is traced as well, so the lock can be held outside of the cone.
+ *
+ * Candidates are cached sorted from left to right along with the best target, so locking on and switching targets
+ * only walk the cached list, whatever the number of actors around.
+ */
+UCLASS()
+class ASCENSION_API ULockOnSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Subsystem functions. */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/*
+	 * Registers a lockable actor. The actor is unregistered automatically when it exits play.
+	 * @param Actor		Actor to register.
+	 * @returns int32	Lock index of the actor. INDEX_NONE if the actor isn't lockable.
+	 */
+	int32 RegisterLockable(AActor* Actor);
+
+	/*
+	 * Unregisters a lockable actor.
+	 * @param Actor		Actor to unregister.
+	 */
+	void UnregisterLockable(AActor* Actor);
+
+	/*
+	 * Registers a player picking lock-on targets. Its candidates are only refreshed while it is locally controlled.
+	 * @param Pawn	The player's pawn.
+	 */
+	void RegisterSeeker(APawn* Pawn);
+
+	/*
+	 * Unregisters a player picking lock-on targets.
+	 * @param Pawn	The player's pawn.
+	 */
+	void UnregisterSeeker(APawn* Pawn);
+
+	/*
+	 * Gets the best target of a player, as of its last refresh.
+	 * @param Seeker		The player's pawn.
+	 * @returns AActor*		Best target. Null if there is none.
+	 */
+	AActor* FindBestTarget(const APawn* Seeker) const;
+
+	/*
+	 * Gets the target next to the current one, as of the player's last refresh. Targets out of sight are skipped.
+	 * @param Seeker		The player's pawn.
+	 * @param Target		Current target.
+	 * @param Direction		Positive for the next target to the right, negative for the next target to the left.
+	 * @returns AActor*		Next target. Null if there is none in that direction.
+	 */
+	AActor* FindNextTarget(const APawn* Seeker, const AActor* Target, const int32 Direction) const;
+
+	/*
+	 * Checks whether an actor was a candidate on the player's last refresh, in sight or not.
+	 * @param Seeker	The player's pawn.
+	 * @param Target	The actor.
+	 */
+	bool IsCandidate(const APawn* Seeker, const AActor* Target) const;
+
+	/*
+	 * Sets the actor a player is locked on to, so its line of sight keeps being checked wherever it is.
+	 * @param Seeker	The player's pawn.
+	 * @param Target	The actor locked on to. Null when the player releases the lock.
+	 */
+	void SetHeldTarget(const APawn* Seeker, AActor* Target);
+
+	/*
+	 * Checks whether a player can stay locked on to an actor: it must be lockable, in range and in sight.
+	 * Unlike picking a target, the actor doesn't need to be in front of the player's view.
+	 * @param Seeker	The player's pawn.
+	 * @param Target	The actor.
+	 */
+	bool IsTargetValid(const APawn* Seeker, const AActor* Target) const;
+
+	/*
+	 * Returns the delegate called after the candidates of a player are refreshed.
+	 */
+	FORCEINLINE FOnLockOnCandidatesRefreshed& OnCandidatesRefreshed() { return CandidatesRefreshed; }
+
+private:
+	/*
+	 * Refreshes the candidates of the seekers whose refresh interval has passed.
+	 * @param World			World that finished ticking actors.
+	 * @param TickType		Type of the tick.
+	 * @param DeltaSeconds	Time since the last tick.
+	 */
+	void RefreshSeekers(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/*
+	 * Finds and scores the candidates of a seeker, and checks the best of them for line of sight.
+	 * @param Seeker	The seeker.
+	 */
+	void RefreshCandidates(FLockOnSeeker& Seeker);
+
+	/*
+	 * Called when a line of sight trace completes.
+	 * @param TraceHandle	Handle of the trace.
+	 * @param TraceDatum	Results of the trace. The user data holds the lock index of the target.
+	 * @param SeekerID		Identifier of the seeker the trace was for.
+	 */
+	void OnLineOfSightTraced(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum, uint32 SeekerID);
+
+	/*
+	 * Finds a seeker.
+	 * @param Pawn				The seeker's pawn.
+	 * @returns FLockOnSeeker*	The seeker. Null if the pawn isn't registered.
+	 */
+	const FLockOnSeeker* FindSeeker(const APawn* Pawn) const;
+
+	/*
+	 * Called when the root component of a registered actor moves.
+	 * @param Component		The root component.
+	 * @param UpdateFlags	Flags of the transform update.
+	 * @param Teleport		Whether the component was teleported.
+	 * @param LockIndex		Lock index of the actor.
+	 */
+	void OnLockableMoved(USceneComponent* Component, EUpdateTransformFlags UpdateFlags, ETeleportType Teleport, int32 LockIndex);
+
+	/** Called when a registered actor exits play. */
+	UFUNCTION()
+	void OnLockableEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+private:
+	/** Registered actors, indexed by lock index. Free indices hold null. */
+	UPROPERTY(Transient)
+	TArray<AActor*> Lockables;
+
+	/** Map of registered actors to their lock index. */
+	TMap<const AActor*, int32> LockIndexMap;
+
+	/** Lock indices that can be reused. */
+	TArray<int32> FreeIndices;
+
+	/** Root components whose movement is tracked, indexed by lock index. */
+	TArray<TWeakObjectPtr<USceneComponent>> TrackedComponents;
+
+	/** Handles of the transform update delegates of the tracked components, indexed by lock index. */
+	TArray<FDelegateHandle> TransformUpdatedHandles;
+
+	/** Locations of the registered actors. */
+	FCombatSpatialHash SpatialHash;
+
+	/** Players picking lock-on targets. */
+	TArray<FLockOnSeeker> Seekers;
+
+	/** Identifier given to the next seeker. */
+	uint32 NextSeekerID;
+
+	/** Lock indices found by the last query, reused between refreshes. */
+	TArray<int32> QueryIndices;
+
+	/** Delegate called after the candidates of a player are refreshed. */
+	FOnLockOnCandidatesRefreshed CandidatesRefreshed;
+
+	/** Handle of the post actor tick delegate. */
+	FDelegateHandle PostActorTickHandle;
+};
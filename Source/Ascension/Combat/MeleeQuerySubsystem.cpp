@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "MeleeQuerySubsystem.h"
+#include "Components/AttackComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Melee Query Issue"), STAT_MeleeQueryIssue, STATGROUP_Ascension);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Sweeps Issued"), STAT_MeleeSweepsIssued, STATGROUP_Ascension);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Sweeps Deferred"), STAT_MeleeSweepsDeferred, STATGROUP_Ascension);
+
+static TAutoConsoleVariable<int32> CVarMeleeQueryBudget(
+	TEXT("Ascension.Melee.QueryBudget"),
+	64,
+	TEXT("Maximum number of melee sweeps issued per frame. Sweeps over the budget are deferred to later frames."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMeleeQueryMaxDeferredFrames(
+	TEXT("Ascension.Melee.MaxDeferredFrames"),
+	4,
+	TEXT("Number of frames a melee sweep can be deferred before it is dropped."),
+	ECVF_Default);
+
+
+void UMeleeQuerySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	NextSweepSerial = 0;
+	SweepCompleteDelegate.BindUObject(this, &UMeleeQuerySubsystem::OnSweepComplete);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UMeleeQuerySubsystem::IssueQueuedSweeps);
+}
+
+void UMeleeQuerySubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	SweepCompleteDelegate.Unbind();
+
+	// Outstanding sweeps will never complete, so their requesters get no hits rather than waiting forever.
+	static const TArray<FHitResult> NoHits;
+
+	for (const FMeleeSweepRequest& Request : QueuedSweeps)
+	{
+		if (UAttackComponent* Requester = Request.Requester.Get())
+		{
+			Requester->ReceiveSweepResults(Request.AttackID, NoHits);
+		}
+	}
+
+	for (const TPair<uint32, FMeleeSweepRequest>& InFlightSweep : InFlightSweeps)
+	{
+		if (UAttackComponent* Requester = InFlightSweep.Value.Requester.Get())
+		{
+			Requester->ReceiveSweepResults(InFlightSweep.Value.AttackID, NoHits);
+		}
+	}
+
+	QueuedSweeps.Empty();
+	InFlightSweeps.Empty();
+
+	Super::Deinitialize();
+}
+
+void UMeleeQuerySubsystem::QueueSweep(const FMeleeSweepRequest& Request)
+{
+	FMeleeSweepRequest& QueuedRequest = QueuedSweeps.Add_GetRef(Request);
+	QueuedRequest.QueuedFrame = GFrameCounter;
+}
+
+void UMeleeQuerySubsystem::IssueQueuedSweeps(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || QueuedSweeps.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MeleeQueryIssue);
+
+	// Drop sweeps that have waited too long, their attacks have moved on since.
+	const uint64 MaxDeferredFrames = FMath::Max(CVarMeleeQueryMaxDeferredFrames.GetValueOnGameThread(), 0);
+	static const TArray<FHitResult> NoHits;
+
+	QueuedSweeps.RemoveAllSwap([MaxDeferredFrames](const FMeleeSweepRequest& Request)
+	{
+		UAttackComponent* Requester = Request.Requester.Get();
+
+		if (Requester == nullptr)
+		{
+			return true;
+		}
+
+		if (GFrameCounter - Request.QueuedFrame > MaxDeferredFrames)
+		{
+			Requester->ReceiveSweepResults(Request.AttackID, NoHits);
+			return true;
+		}
+
+		return false;
+	}, false);
+
+	// Player sweeps first, then the ones that have waited the longest.
+	QueuedSweeps.StableSort([](const FMeleeSweepRequest& A, const FMeleeSweepRequest& B)
+	{
+		if (A.bHighPriority != B.bHighPriority)
+		{
+			return A.bHighPriority;
+		}
+		return A.QueuedFrame < B.QueuedFrame;
+	});
+
+	const int32 Budget = FMath::Max(CVarMeleeQueryBudget.GetValueOnGameThread(), 0);
+	const int32 NumToIssue = FMath::Min(Budget, QueuedSweeps.Num());
+
+	for (int32 Index = 0; Index < NumToIssue; Index++)
+	{
+		const FMeleeSweepRequest& Request = QueuedSweeps[Index];
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MeleeQuery), false, Request.Requester->GetOwner());
+		const uint32 Serial = NextSweepSerial++;
+
+		World->AsyncSweepByObjectType(EAsyncTraceType::Multi, Request.Start, Request.End, Request.Rotation, Request.ObjectQueryParams,
+									  Request.Shape, QueryParams, &SweepCompleteDelegate, Serial);
+
+		InFlightSweeps.Add(Serial, Request);
+	}
+
+	QueuedSweeps.RemoveAt(0, NumToIssue, false);
+
+	INC_DWORD_STAT_BY(STAT_MeleeSweepsIssued, NumToIssue);
+	INC_DWORD_STAT_BY(STAT_MeleeSweepsDeferred, QueuedSweeps.Num());
+}
+
+void UMeleeQuerySubsystem::OnSweepComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	FMeleeSweepRequest Request;
+
+	if (!InFlightSweeps.RemoveAndCopyValue(TraceDatum.UserData, Request))
+	{
+		return;
+	}
+
+	UAttackComponent* Requester = Request.Requester.Get();
+
+	if (Requester)
+	{
+		Requester->ReceiveSweepResults(Request.AttackID, TraceDatum.OutHits);
+	}
+}
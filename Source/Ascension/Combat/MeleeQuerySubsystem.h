@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "MeleeQuerySubsystem.generated.h"
+
+
+/*
+ * Struct representing a melee sweep queued by an attack component.
+ */
+struct FMeleeSweepRequest
+{
+	FMeleeSweepRequest()
+		: AttackID(0)
+		, Start(FVector::ZeroVector)
+		, End(FVector::ZeroVector)
+		, Rotation(FQuat::Identity)
+		, bHighPriority(false)
+		, QueuedFrame(0)
+	{}
+
+	/** Attack component that queued the sweep and receives its results. */
+	TWeakObjectPtr<class UAttackComponent> Requester;
+
+	/** ID of the attack the sweep belongs to. */
+	uint8 AttackID;
+
+	/** Start of the sweep. */
+	FVector Start;
+
+	/** End of the sweep. */
+	FVector End;
+
+	/** Rotation of the swept shape. */
+	FQuat Rotation;
+
+	/** Shape to sweep. */
+	FCollisionShape Shape;
+
+	/** Object types the sweep can hit. */
+	FCollisionObjectQueryParams ObjectQueryParams;
+
+	/** Whether the sweep is issued before normal priority sweeps. Used for the player's attacks. */
+	bool bHighPriority;
+
+	/** Frame on which the sweep was queued. */
+	uint64 QueuedFrame;
+};
+
+/*
+ * Subsystem that batches the melee hit queries of every attack component in the world.
+ * Attack components queue the volumes their active attacks swept through during their tick. Once every actor has
+ * ticked, the queued sweeps are issued together as asynchronous traces that run alongside the rest of the frame, and
+ * their results are delivered to the attack components at the start of the next frame.
+ * At most a fixed number of sweeps are issued per frame. The player's sweeps are issued first and the rest are
+ * deferred to a later frame, so the cost of melee stays predictable in large fights.
+ */
+UCLASS()
+class ASCENSION_API UMeleeQuerySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Subsystem functions. */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/*
+	 * Queues a sweep to be issued with the next batch.
+	 * The requester receives the results exactly once, with no hits if the sweep was deferred for too long.
+	 * @param Request	Sweep to queue.
+	 */
+	void QueueSweep(const FMeleeSweepRequest& Request);
+
+	/*
+	 * Returns the number of sweeps waiting to be issued.
+	 */
+	FORCEINLINE int32 GetNumQueuedSweeps() const { return QueuedSweeps.Num(); }
+
+private:
+	/*
+	 * Issues the queued sweeps as asynchronous traces, up to the per-frame budget.
+	 * @param World			World that finished ticking actors.
+	 * @param TickType		Type of the tick.
+	 * @param DeltaSeconds	Time since the last tick.
+	 */
+	void IssueQueuedSweeps(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/*
+	 * Delivers the results of an asynchronous sweep to the attack component that queued it.
+	 * @param TraceHandle	Handle of the trace.
+	 * @param TraceDatum	Results of the trace.
+	 */
+	void OnSweepComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+private:
+	/** Sweeps waiting to be issued. */
+	TArray<FMeleeSweepRequest> QueuedSweeps;
+
+	/** Sweeps that have been issued and are waiting for results, mapped by the user data of their trace. */
+	TMap<uint32, FMeleeSweepRequest> InFlightSweeps;
+
+	/** User data given to the next issued sweep. */
+	uint32 NextSweepSerial;
+
+	/** Delegate called when an asynchronous sweep completes. */
+	FTraceDelegate SweepCompleteDelegate;
+
+	/** Handle of the post actor tick delegate. */
+	FDelegateHandle PostActorTickHandle;
+};
@@ -5,8 +5,39 @@
 #include "GameMovementComponent.h"
 #include "Interfaces/Damageable.h"
 #include "Abilities/AbilitySystems/GameAbilitySystemComponent.h"
+#include "Abilities/Attacks/ComboGraph.h"
+#include "Combat/MeleeQuerySubsystem.h"
+#include "Combat/DamageableSubsystem.h"
+#include "Components/HitboxHistoryComponent.h"
+#include "Entities/Characters/GameCharacter.h"
+#include "GameFramework/PlayerState.h"
+#include "Animation/AnimInstance.h"
 #include "Kismet/KismetMathLibrary.h"
 
+static TAutoConsoleVariable<int32> CVarLagCompensationEnable(
+	TEXT("Ascension.LagCompensation.Enable"),
+	1,
+	TEXT("Whether servers check melee hits from remote clients against the hitbox history of their targets."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLagCompensationMaxRewind(
+	TEXT("Ascension.LagCompensation.MaxRewind"),
+	0.25f,
+	TEXT("Maximum time in seconds targets are rewound to check melee hits from remote clients."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLagCompensationInterpDelay(
+	TEXT("Ascension.LagCompensation.InterpDelay"),
+	0.0f,
+	TEXT("Time in seconds clients display other actors behind the server, added to half the round trip time when rewinding."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLagCompensationCandidatePadding(
+	TEXT("Ascension.LagCompensation.CandidatePadding"),
+	200.0f,
+	TEXT("Distance added to melee sweeps when finding the actors to rewind, covering how far they moved since the rewind time."),
+	ECVF_Default);
+
 
 // Sets default values for this component's properties
 UAttackComponent::UAttackComponent()
@@ -16,11 +47,27 @@ UAttackComponent::UAttackComponent()
 
 	// Set gameplay variables.
 	AttackHitBox = nullptr;
-	DamagedActors.Empty();
+
+	// Set hit detection variables.
+	WeaponMesh = nullptr;
+	WeaponTraceRadius = 10.0f;
+	HitObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_Pawn));
+	HitObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_PhysicsBody));
+	HitboxTag = FName("Hitbox");
+	bBatchHitQueries = true;
+	AbilitySystem = nullptr;
+	MeleeQuerySubsystem = nullptr;
+	DamageableSubsystem = nullptr;
+
+	// Set combo variables.
+	ComboGraph = nullptr;
+	CurrentComboNode = UComboGraph::EntryNode;
+	ComboNodeStartTime = 0.0f;
 
 	// Clear active attacks.
-	ActiveAttackIDs.Empty();
-	ActiveAttackNameIDsMap.Empty();
+	ActiveAttacks.Reset();
+	NextAttackFinishedHandle = 1;
+	LastAttackID = 0;
 }
 
 
@@ -34,10 +81,34 @@ void UAttackComponent::BeginPlay()
 	Super::BeginPlay();
 
 	Owner = Cast<ACharacter>(GetOwner());
+	MeleeQuerySubsystem = GetWorld()->GetSubsystem<UMeleeQuerySubsystem>();
+	DamageableSubsystem = GetWorld()->GetSubsystem<UDamageableSubsystem>();
+
+	if (Owner)
+	{
+		AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
+
+		if (WeaponMesh == nullptr)
+		{
+			WeaponMesh = Owner->GetMesh();
+		}
+	}
 }
 
 void UAttackComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	// Attacks cut short by the owner leaving play, e.g. dying mid-swing, fail.
+	TArray<FAttackFinishedBinding, TInlineAllocator<2>> Bindings = MoveTemp(AttackFinishedBindings);
+	AttackFinishedBindings.Reset();
+
+	for (const FAttackFinishedBinding& Binding : Bindings)
+	{
+		Binding.Delegate.ExecuteIfBound(Binding.AttackID, false);
+	}
+
+	// Nothing bound while the owner leaves play will be called.
+	AttackFinishedBindings.Reset();
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -45,8 +116,6 @@ void UAttackComponent::SetupAttack_Implementation(const FString& AttackName = FS
 
 bool UAttackComponent::Attack_Implementation(const FString& AttackName)
 {
-	UGameAbilitySystemComponent* AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
-
 	if (AbilitySystem)
 	{
 		if (AbilitySystem->CanActivateAbility(AttackName))
@@ -56,15 +125,8 @@ bool UAttackComponent::Attack_Implementation(const FString& AttackName)
 
 			if (Activated)
 			{
-				ActiveAttackIDs.Add(AttackID);
-
-				if (!ActiveAttackNameIDsMap.Contains(AttackName))
-				{
-					TArray<uint8> AttackIDs = TArray<uint8>();
-					ActiveAttackNameIDsMap.Add(AttackName, AttackIDs);
-				}
-				ActiveAttackNameIDsMap[AttackName].Add(AttackID);
-
+				ActiveAttacks.Add(FName(*AttackName), AttackID);
+				LastAttackID = AttackID;
 				return true;
 			}
 		}
@@ -75,138 +137,448 @@ bool UAttackComponent::Attack_Implementation(const FString& AttackName)
 
 void UAttackComponent::FinishAttack_Implementation(const FString& AttackName = FString(""), const uint8 AttackID = 0)
 {
-	UGameAbilitySystemComponent* AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
+	const int32 FinishedID = ActiveAttacks.Resolve(FName(*AttackName), AttackID);
 
-	if (!AttackName.Equals(FString("")))
+	if (FinishedID != INDEX_NONE && AbilitySystem)
 	{
-		if (ActiveAttackNameIDsMap.Contains(AttackName))
+		EndActiveAttack(AttackName, FinishedID);
+	}
+}
+
+void UAttackComponent::EndActiveAttack(const FString& AttackName, const uint8 AttackID)
+{
+	AbilitySystem->FinishAbility(AttackName, AttackID);
+	ActiveAttacks.Remove(AttackID);
+	ReleaseAttackTrace(AttackID);
+	NotifyAttackFinished(AttackID, true);
+}
+
+uint32 UAttackComponent::BindAttackFinished(const uint8 AttackID, FOnAttackFinished&& Delegate)
+{
+	if (!ActiveAttacks.Contains(AttackID) || !Delegate.IsBound())
+	{
+		return 0;
+	}
+
+	FAttackFinishedBinding& Binding = AttackFinishedBindings.AddDefaulted_GetRef();
+	Binding.Handle = NextAttackFinishedHandle++;
+	Binding.AttackID = AttackID;
+	Binding.Delegate = MoveTemp(Delegate);
+
+	// 0 is never a valid handle.
+	if (NextAttackFinishedHandle == 0)
+	{
+		NextAttackFinishedHandle = 1;
+	}
+
+	return Binding.Handle;
+}
+
+void UAttackComponent::UnbindAttackFinished(const uint32 Handle)
+{
+	const int32 Index = AttackFinishedBindings.IndexOfByPredicate([Handle](const FAttackFinishedBinding& Binding) { return Binding.Handle == Handle; });
+
+	if (Index != INDEX_NONE)
+	{
+		AttackFinishedBindings.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+void UAttackComponent::NotifyAttackFinished(const uint8 AttackID, const bool bSuccessful)
+{
+	// Bindings are removed before their callback runs, so callbacks can start or wait for other attacks.
+	for (int32 Index = AttackFinishedBindings.Num() - 1; Index >= 0; Index--)
+	{
+		if (Index < AttackFinishedBindings.Num() && AttackFinishedBindings[Index].AttackID == AttackID)
 		{
-			TArray<uint8> IDs = ActiveAttackNameIDsMap[AttackName];
+			const FOnAttackFinished Delegate = MoveTemp(AttackFinishedBindings[Index].Delegate);
+			AttackFinishedBindings.RemoveAtSwap(Index, 1, false);
+			Delegate.ExecuteIfBound(AttackID, bSuccessful);
+		}
+	}
+}
 
-			if (IDs.Num() > 0)
-			{
-				if (IDs.Contains(AttackID) && ActiveAttackIDs.Contains(AttackID))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(AttackName, AttackID);
-						ActiveAttackIDs.Remove(AttackID);
-						ActiveAttackNameIDsMap[AttackName].Remove(AttackID);
-					}
-				}
-				else if (ActiveAttackIDs.Contains(IDs[0]))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(AttackName, IDs[0]);
-						ActiveAttackIDs.Remove(IDs[0]);
-						ActiveAttackNameIDsMap[AttackName].Remove(IDs[0]);
-					}
-				}
-			}
+bool UAttackComponent::ComboAttack(const FName Input)
+{
+	int32 Node = INDEX_NONE;
+	const FString AttackName = SelectComboAttack(Input, Node);
+
+	if (Node != INDEX_NONE && Attack(AttackName))
+	{
+		AdvanceCombo(Node);
+		return true;
+	}
+
+	return false;
+}
+
+FString UAttackComponent::SelectComboAttack(const FName Input, int32& OutNode) const
+{
+	OutNode = INDEX_NONE;
+
+	if (ComboGraph == nullptr || Owner == nullptr)
+	{
+		return FString();
+	}
+
+	EComboStateFlags States = Owner->GetCharacterMovement()->IsFalling() ? EComboStateFlags::CSF_Airborne : EComboStateFlags::CSF_Grounded;
+
+	if (!Owner->GetVelocity().IsNearlyZero())
+	{
+		States |= EComboStateFlags::CSF_Moving;
+	}
+
+	const float TimeInNode = GetWorld()->GetTimeSeconds() - ComboNodeStartTime;
+	OutNode = ComboGraph->FindTransition(CurrentComboNode, Input, TimeInNode, (uint8) States);
+
+	return OutNode != INDEX_NONE ? ComboGraph->GetNodeAbility(OutNode) : FString();
+}
+
+void UAttackComponent::AdvanceCombo(const int32 Node)
+{
+	CurrentComboNode = Node;
+	ComboNodeStartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UAttackComponent::ResetComboGraph()
+{
+	CurrentComboNode = UComboGraph::EntryNode;
+}
+
+void UAttackComponent::DetectHit()
+{
+	for (int32 Slot = 0; Slot < ActiveAttacks.Num(); Slot++)
+	{
+		FAttackTraceState* TraceState = FindOrAddAttackTrace(ActiveAttacks.GetIDAt(Slot));
+
+		if (TraceState)
+		{
+			SweepAttack(*TraceState);
 		}
 	}
+}
 
-	else if (ActiveAttackIDs.Contains(AttackID))
+FAttackTraceState* UAttackComponent::FindOrAddAttackTrace(const uint8 AttackID)
+{
+	for (FAttackTraceState& TraceState : AttackTraceStates)
 	{
-		if (AbilitySystem)
+		if (TraceState.AttackID == AttackID && !TraceState.bReleased)
 		{
-			AbilitySystem->FinishAbility(AttackName, AttackID);
-			ActiveAttackIDs.Remove(AttackID);
+			return &TraceState;
+		}
+	}
 
-			if (ActiveAttackNameIDsMap.Contains(AttackName))
-			{
-				if (ActiveAttackNameIDsMap[AttackName].Contains(AttackID))
-				{
-					ActiveAttackNameIDsMap[AttackName].Remove(AttackID);
-				}
-			}
+	if (AbilitySystem)
+	{
+		UAttack* Attack = Cast<UAttack>(AbilitySystem->GetActiveAbility(FString(""), AttackID));
+
+		if (Attack)
+		{
+			FAttackTraceState& TraceState = AttackTraceStates.AddDefaulted_GetRef();
+			TraceState.AttackID = AttackID;
+			TraceState.Attack = Attack;
+			return &TraceState;
 		}
 	}
+
+	return nullptr;
 }
 
-void UAttackComponent::DetectHit()
+void UAttackComponent::ReleaseAttackTrace(const uint8 AttackID)
 {
-	// TODO: Rework this.
-	/*
-	if (AttackHitBox)
+	for (int Index = 0; Index < AttackTraceStates.Num(); Index++)
 	{
-		TArray<UPrimitiveComponent*> OverlappingComponents;
-		AttackHitBox->GetOverlappingComponents(OverlappingComponents);
+		FAttackTraceState& TraceState = AttackTraceStates[Index];
 
-		for (int i = 0; i < OverlappingComponents.Num(); i++)
+		if (TraceState.AttackID == AttackID && !TraceState.bReleased)
 		{
-			UPrimitiveComponent* OtherComponent = OverlappingComponents[i];
-			if (OtherComponent->ComponentHasTag(FName("Hitbox")))
+			// Hits of batched sweeps still in flight belong to this attack, so keep its state until they arrive.
+			if (TraceState.PendingSweeps > 0)
+			{
+				TraceState.bReleased = true;
+			}
+			else
 			{
-				AActor* OtherActor = OtherComponent->GetOwner();
-
-				if (DamagedActors.Find(OtherActor) == INDEX_NONE && OtherActor != GetOwner())
-				{
-					if (OtherActor->GetClass()->ImplementsInterface(UDamageable::StaticClass()))
-					{
-						UGameAbilitySystemComponent* AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
-
-						if (!(ActiveAttacks.Num() == 0) && AbilitySystem != nullptr)
-						{
-							// Get the correct attack, not the zeroth index.
-							UAttack* Attack = Cast<UAttack>(AbilitySystem->GetAbility(ActiveAttacks[0]));
-
-							if (Attack != nullptr)
-							{
-								IDamageable::Execute_ApplyHitEffect(OtherActor, GetOwner(), 
-																	Attack->GetEffectInfo().Damage, 
-																	Attack->GetEffectInfo().HitEffect, 
-																	Attack->GetEffectInfo().AttackEffect);
-								DamagedActors.Add(OtherActor);
-							}
-						}
-					}
-				}
+				AttackTraceStates.RemoveAtSwap(Index);
 			}
+			return;
+		}
+	}
+}
+
+void UAttackComponent::SweepAttack(FAttackTraceState& TraceState)
+{
+	UAttack* Attack = TraceState.Attack.Get();
+	USkeletalMeshComponent* OwnerMesh = Owner ? Owner->GetMesh() : nullptr;
+	UAnimInstance* AnimInstance = OwnerMesh ? OwnerMesh->GetAnimInstance() : nullptr;
+
+	// Replay the baked trajectory of the attack if it has one, so no bones need to be evaluated for the query.
+	if (Attack && Attack->GetTrajectory().IsBaked() && AnimInstance && AnimInstance->Montage_IsActive(Attack->GetAnimMontage()))
+	{
+		const FAttackTrajectory& Trajectory = Attack->GetTrajectory();
+		const FCollisionShape SweepShape = FCollisionShape::MakeSphere(WeaponTraceRadius);
+		const FTransform& MeshTransform = OwnerMesh->GetComponentTransform();
+		const float Position = AnimInstance->Montage_GetPosition(Attack->GetAnimMontage());
+		TraceState.PreviousLocations.SetNum(Trajectory.NumSockets);
+
+		for (int Index = 0; Index < Trajectory.NumSockets; Index++)
+		{
+			const FVector CurrentLocation = MeshTransform.TransformPosition(Trajectory.GetSocketLocation(Position, Index));
+			const FVector PreviousLocation = TraceState.bHasPreviousLocations ? TraceState.PreviousLocations[Index] : CurrentLocation;
+
+			SweepSegment(TraceState, PreviousLocation, CurrentLocation, FQuat::Identity, SweepShape);
+
+			TraceState.PreviousLocations[Index] = CurrentLocation;
 		}
 	}
-	*/
+
+	// One sweep per socket per call. The sweep covers the whole path since the last call, so the number of queries
+	// stays the same no matter how far the weapon moved in between.
+	else if (WeaponMesh && WeaponSocketNames.Num() > 0)
+	{
+		const FCollisionShape SweepShape = FCollisionShape::MakeSphere(WeaponTraceRadius);
+		TraceState.PreviousLocations.SetNum(WeaponSocketNames.Num());
+
+		for (int Index = 0; Index < WeaponSocketNames.Num(); Index++)
+		{
+			const FVector CurrentLocation = WeaponMesh->GetSocketLocation(WeaponSocketNames[Index]);
+			const FVector PreviousLocation = TraceState.bHasPreviousLocations ? TraceState.PreviousLocations[Index] : CurrentLocation;
+
+			SweepSegment(TraceState, PreviousLocation, CurrentLocation, FQuat::Identity, SweepShape);
+
+			TraceState.PreviousLocations[Index] = CurrentLocation;
+		}
+	}
+
+	// Without weapon sockets, sweep the hit box along its path instead.
+	else if (AttackHitBox)
+	{
+		const FCollisionShape SweepShape = FCollisionShape::MakeBox(AttackHitBox->GetScaledBoxExtent());
+		const FVector CurrentLocation = AttackHitBox->GetComponentLocation();
+		TraceState.PreviousLocations.SetNum(1);
+		const FVector PreviousLocation = TraceState.bHasPreviousLocations ? TraceState.PreviousLocations[0] : CurrentLocation;
+
+		SweepSegment(TraceState, PreviousLocation, CurrentLocation, AttackHitBox->GetComponentQuat(), SweepShape);
+
+		TraceState.PreviousLocations[0] = CurrentLocation;
+	}
+
+	TraceState.bHasPreviousLocations = true;
 }
 
-void UAttackComponent::ClearDamagedActors_Implementation()
+void UAttackComponent::SweepSegment(FAttackTraceState& TraceState, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape)
 {
-	DamagedActors.Empty();
+	// Hits from remote clients are checked against where the client saw their targets.
+	float RewindTime = 0.0f;
+
+	if (GetLagCompensationTime(RewindTime))
+	{
+		// Boxes are tested as their bounding sphere.
+		const float Radius = Shape.IsSphere() ? Shape.GetSphereRadius() : Shape.GetExtent().Size();
+		SweepSegmentRewound(TraceState, Start, End, Radius, RewindTime);
+		return;
+	}
+
+	if (bBatchHitQueries && MeleeQuerySubsystem)
+	{
+		FMeleeSweepRequest Request;
+		Request.Requester = this;
+		Request.AttackID = TraceState.AttackID;
+		Request.Start = Start;
+		Request.End = End;
+		Request.Rotation = Rotation;
+		Request.Shape = Shape;
+		Request.ObjectQueryParams = FCollisionObjectQueryParams(HitObjectTypes);
+		Request.bHighPriority = Owner && Owner->IsPlayerControlled();
+
+		MeleeQuerySubsystem->QueueSweep(Request);
+		TraceState.PendingSweeps++;
+		return;
+	}
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AttackDetectHit), false, Owner);
+	TArray<FHitResult> Hits;
+
+	GetWorld()->SweepMultiByObjectType(Hits, Start, End, Rotation, FCollisionObjectQueryParams(HitObjectTypes), Shape, QueryParams);
+	ProcessHits(TraceState, Hits);
 }
 
-void UAttackComponent::FinalizeAttackDirection_Implementation(FVector MovementIntent)
+bool UAttackComponent::GetLagCompensationTime(float& OutTime) const
 {
-	ActionDirection = MovementIntent;
+	if (!CVarLagCompensationEnable.GetValueOnGameThread() || DamageableSubsystem == nullptr || Owner == nullptr)
+	{
+		return false;
+	}
+
+	if (Owner->GetLocalRole() != ROLE_Authority || !Owner->IsPlayerControlled() || Owner->IsLocallyControlled())
+	{
+		return false;
+	}
+
+	const APlayerState* PlayerState = Owner->GetPlayerState();
+
+	if (PlayerState == nullptr)
+	{
+		return false;
+	}
+
+	// The client saw its targets half a round trip ago, plus however long it interpolates them behind.
+	const float Rewind = PlayerState->ExactPing * 0.001f * 0.5f + CVarLagCompensationInterpDelay.GetValueOnGameThread();
+	OutTime = GetWorld()->GetTimeSeconds() - FMath::Clamp(Rewind, 0.0f, CVarLagCompensationMaxRewind.GetValueOnGameThread());
+	return true;
 }
 
-void UAttackComponent::PrintActiveAttacks() const
+void UAttackComponent::SweepSegmentRewound(FAttackTraceState& TraceState, const FVector& Start, const FVector& End, const float Radius, const float RewindTime)
+{
+	UAttack* Attack = TraceState.Attack.Get();
+
+	if (Attack == nullptr)
+	{
+		return;
+	}
+
+	TArray<int32> Candidates;
+	DamageableSubsystem->QueryCapsule(Start, End, Radius + CVarLagCompensationCandidatePadding.GetValueOnGameThread(), Candidates);
+
+	bool bHasUnrecordedCandidates = false;
+
+	for (const int32 CombatIndex : Candidates)
+	{
+		AActor* Candidate = DamageableSubsystem->GetDamageable(CombatIndex);
+
+		if (Candidate == nullptr || Candidate == Owner || (CombatIndex < TraceState.HitIndices.Num() && TraceState.HitIndices[CombatIndex]))
+		{
+			continue;
+		}
+
+		const AGameCharacter* Character = Cast<AGameCharacter>(Candidate);
+		const UHitboxHistoryComponent* History = Character ? Character->GetHitboxHistoryComponent() : nullptr;
+
+		if (History == nullptr || !History->HasHistory())
+		{
+			bHasUnrecordedCandidates = true;
+			continue;
+		}
+
+		FVector HitPoint;
+
+		if (History->SweepAtTime(RewindTime, Start, End, Radius, HitPoint))
+		{
+			RegisterHit(TraceState, Attack, Candidate, HitPoint);
+		}
+	}
+
+	// Actors without a history can only be hit where they are now.
+	if (bHasUnrecordedCandidates)
+	{
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AttackDetectHit), false, Owner);
+		TArray<FHitResult> Hits;
+
+		GetWorld()->SweepMultiByObjectType(Hits, Start, End, FQuat::Identity, FCollisionObjectQueryParams(HitObjectTypes), FCollisionShape::MakeSphere(Radius), QueryParams);
+
+		// Actors with a history were tested where the client saw them, a hit where they are now doesn't count.
+		Hits.RemoveAll([](const FHitResult& Hit)
+		{
+			const AGameCharacter* Character = Cast<AGameCharacter>(Hit.GetActor());
+			const UHitboxHistoryComponent* History = Character ? Character->GetHitboxHistoryComponent() : nullptr;
+			return History != nullptr && History->HasHistory();
+		});
+
+		ProcessHits(TraceState, Hits);
+	}
+}
+
+void UAttackComponent::ReceiveSweepResults(const uint8 AttackID, const TArray<FHitResult>& Hits)
+{
+	for (int Index = 0; Index < AttackTraceStates.Num(); Index++)
+	{
+		FAttackTraceState& TraceState = AttackTraceStates[Index];
+
+		if (TraceState.AttackID == AttackID && TraceState.PendingSweeps > 0)
+		{
+			TraceState.PendingSweeps--;
+			ProcessHits(TraceState, Hits);
+
+			if (TraceState.bReleased && TraceState.PendingSweeps == 0)
+			{
+				AttackTraceStates.RemoveAtSwap(Index);
+			}
+			return;
+		}
+	}
+}
+
+void UAttackComponent::ProcessHits(FAttackTraceState& TraceState, const TArray<FHitResult>& Hits)
 {
-	FString AttackIDsString = FString("Attack IDs: ");
-	FString AttackNameIDsString = FString("Attack Name IDs Map Contents: ");
+	UAttack* Attack = TraceState.Attack.Get();
 
-	for (uint8 AttackID : ActiveAttackIDs)
+	if (Attack == nullptr || DamageableSubsystem == nullptr)
 	{
-		AttackIDsString = AttackIDsString.Append(FString::FromInt(AttackID));
-		AttackIDsString = AttackIDsString.Append(FString(" | "));
+		return;
 	}
 
-	for (auto& Pair : ActiveAttackNameIDsMap)
+	for (const FHitResult& Hit : Hits)
 	{
-		FString IDsString = "";
-		for (uint8 AttackID : Pair.Value)
+		UPrimitiveComponent* HitComponent = Hit.GetComponent();
+		AActor* HitActor = Hit.GetActor();
+
+		if (HitComponent == nullptr || HitActor == nullptr || HitActor == Owner)
 		{
-			IDsString = IDsString.Append(FString::FromInt(AttackID));
-			IDsString = IDsString.Append(FString(","));
+			continue;
 		}
 
-		TArray<FStringFormatArg> FormatArgs;
-		FormatArgs.Add(FStringFormatArg(Pair.Key));
-		FormatArgs.Add(FStringFormatArg(IDsString));
+		if (!HitboxTag.IsNone() && !HitComponent->ComponentHasTag(HitboxTag))
+		{
+			continue;
+		}
 
-		AttackNameIDsString = AttackNameIDsString.Append(FString::Format(TEXT("<{0}, [{1}]>"), FormatArgs));
-		AttackNameIDsString = AttackNameIDsString.Append(FString(" || "));
+		RegisterHit(TraceState, Attack, HitActor, Hit.ImpactPoint);
+	}
+}
+
+void UAttackComponent::RegisterHit(FAttackTraceState& TraceState, const UAttack* Attack, AActor* HitActor, const FVector& HitPoint)
+{
+	const int32 CombatIndex = DamageableSubsystem->GetCombatIndex(HitActor);
+
+	if (CombatIndex == INDEX_NONE || (CombatIndex < TraceState.HitIndices.Num() && TraceState.HitIndices[CombatIndex]))
+	{
+		return;
+	}
+
+	if (CombatIndex >= TraceState.HitIndices.Num())
+	{
+		TraceState.HitIndices.Add(false, CombatIndex + 1 - TraceState.HitIndices.Num());
+	}
+	TraceState.HitIndices[CombatIndex] = true;
+
+	const FAttackEffectInfo EffectInfo = Attack->GetEffectInfo();
+
+	FCombatHitRecord HitRecord;
+	HitRecord.SourceActor = Owner;
+	HitRecord.TargetIndex = CombatIndex;
+	HitRecord.Damage = EffectInfo.Damage;
+	HitRecord.HitEffect = EffectInfo.HitEffect;
+	HitRecord.AttackEffect = EffectInfo.AttackEffect;
+	HitRecord.HitPoint = HitPoint;
+	DamageableSubsystem->QueueHit(HitRecord);
+}
+
+void UAttackComponent::ClearDamagedActors_Implementation() {}
+
+void UAttackComponent::FinalizeAttackDirection_Implementation(FVector MovementIntent)
+{
+	ActionDirection = MovementIntent;
+}
+
+void UAttackComponent::PrintActiveAttacks() const
+{
+	FString AttacksString = FString("Active Attacks: ");
+
+	for (int32 Slot = 0; Slot < ActiveAttacks.Num(); Slot++)
+	{
+		const uint8 AttackID = ActiveAttacks.GetIDAt(Slot);
+		AttacksString = AttacksString.Append(FString::Printf(TEXT("<%s, %d> | "), *ActiveAttacks.GetDefinition(AttackID).ToString(), AttackID));
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("%s"), *AttackIDsString)
-	UE_LOG(LogTemp, Warning, TEXT("%s"), *AttackNameIDsString)
+	UE_LOG(LogTemp, Warning, TEXT("%s"), *AttacksString)
 }
@@ -5,11 +5,66 @@
 #include "Components/ActorComponent.h"
 #include "Globals.h"
 #include "Abilities/Attacks/Attack.h"
+#include "Abilities/ActionTracker.h"
 #include "AttackComponent.generated.h"
 
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAttackComplete, bool, Successful);
 
+/** Native delegate called once when an attack finishes. Successful is false if the attack was cut short. */
+DECLARE_DELEGATE_TwoParams(FOnAttackFinished, uint8 /* AttackID */, bool /* bSuccessful */);
+
+
+/*
+ * Struct tracking hit detection for a single active attack.
+ */
+struct FAttackTraceState
+{
+	FAttackTraceState()
+		: AttackID(0)
+		, Attack(nullptr)
+		, bHasPreviousLocations(false)
+		, PendingSweeps(0)
+		, bReleased(false)
+	{}
+
+	/** ID of the attack being traced. */
+	uint8 AttackID;
+
+	/** The active attack, used to read the effects applied on hit. */
+	TWeakObjectPtr<UAttack> Attack;
+
+	/** Location of each weapon socket (or the hit box) on the previous trace. */
+	TArray<FVector, TInlineAllocator<4>> PreviousLocations;
+
+	/** Whether the previous locations have been recorded. */
+	bool bHasPreviousLocations;
+
+	/** Combat indices of the actors that have already been hit by this attack. */
+	TBitArray<> HitIndices;
+
+	/** Number of batched sweeps of this attack whose results haven't been received yet. */
+	int32 PendingSweeps;
+
+	/** Whether the attack has finished. The state is kept until its pending sweeps are received. */
+	bool bReleased;
+};
+
+/*
+ * Native callback waiting for an attack to finish.
+ */
+struct FAttackFinishedBinding
+{
+	/** Handle returned when the callback was bound. */
+	uint32 Handle;
+
+	/** ID of the attack waited for. */
+	uint8 AttackID;
+
+	/** Callback. */
+	FOnAttackFinished Delegate;
+};
+
 
 UCLASS(Blueprintable, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class ASCENSION_API UAttackComponent : public UActorComponent
@@ -33,18 +88,90 @@ protected:
 
 	// Called when the component exits play.
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
-	
+
+public:
+	/*
+	 * Performs the next attack of the combo for an input, using the combo graph.
+	 * @param Input		Input given.
+	 * @returns bool	Whether an attack was executed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Combos")
+	bool ComboAttack(const FName Input);
+
+	/** Restarts the combo from the entry of the combo graph. */
+	UFUNCTION(BlueprintCallable, Category = "Combos")
+	void ResetComboGraph();
+
+	/** Checks whether the component has a combo graph to select its attacks from. */
+	FORCEINLINE bool HasComboGraph() const { return ComboGraph != nullptr; }
+
 protected:
 	/** Collision box that checks what actors are hit. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Collision")
 	UBoxComponent* AttackHitBox;
 
 	/*
-	 * Array containing actors that have been damaged by this attack. 
-	 * TODO: Move to Ability.
+	 * Mesh holding the weapon sockets that are swept for hits.
+	 * Defaults to the owner's mesh if it isn't set.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Collision")
+	UMeshComponent* WeaponMesh;
+
+	/*
+	 * Sockets along the weapon that are swept between frames to detect hits.
+	 * If empty, the attack hit box is swept instead.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Collision")
+	TArray<FName> WeaponSocketNames;
+
+	/** Radius of the sphere swept along the path of each weapon socket. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Collision", meta = (ClampMin = 0, UIMin = 0))
+	float WeaponTraceRadius;
+
+	/** Object types that attacks can hit. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Collision")
+	TArray<TEnumAsByte<EObjectTypeQuery>> HitObjectTypes;
+
+	/** Tag a component needs to have to be damaged when hit. If none, any component can be hit. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Collision")
+	FName HitboxTag;
+
+	/*
+	 * Whether hit sweeps are batched with the rest of the world's melee queries.
+	 * Batched sweeps run asynchronously and their hits are applied on the next frame. If disabled, or if the world has
+	 * no melee query subsystem, sweeps run synchronously when the hit is detected.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Collision")
+	bool bBatchHitQueries;
+
+	/*
+	 * Selects the next attack of the combo for an input, using the combo graph.
+	 * @param Input			Input given.
+	 * @param OutNode		Node of the combo graph of the attack. INDEX_NONE if there is no attack.
+	 * @returns FString		Name of the attack ability. Empty if there is no attack.
+	 */
+	FString SelectComboAttack(const FName Input, int32& OutNode) const;
+
+	/*
+	 * Moves the combo to a node of the combo graph, after its attack has been performed.
+	 * @param Node	Node of the combo graph.
 	 */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Damage")
-	TArray<AActor*> DamagedActors;
+	void AdvanceCombo(const int32 Node);
+
+	/** Deprecated, hits are tracked per attack and cleared when the attack finishes. */
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Hits are tracked per attack and cleared when the attack finishes."))
+	TArray<AActor*> DamagedActors_DEPRECATED;
+
+	/** Graph of the combos that can be performed. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combos")
+	class UComboGraph* ComboGraph;
+
+	/** Node of the combo graph of the last attack performed. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combos")
+	int32 CurrentComboNode;
+
+	/** Time at which the last attack of the combo started. */
+	float ComboNodeStartTime;
 
 public:
 	/** Event that is broadcast when an attack succeeds/fails. */
@@ -84,33 +211,170 @@ public:
 	void FinishAttack(const FString& AttackName, const uint8 AttackID);
 	virtual void FinishAttack_Implementation(const FString& AttackName, const uint8 AttackID);
 
-	/** Scans and detects if the attack hits. */
+	/*
+	 * Scans and detects if the active attacks hit.
+	 * The weapon sockets of each active attack are swept from where they were on the previous call, so fast swings
+	 * don't pass through targets at low frame rates. Each actor is only hit once per attack, and overlapping attacks
+	 * track their hits separately.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Damage")
 	void DetectHit();
 
-	/** Clears the actors that have been damaged by the attack. */
-	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Damage")
+	/*
+	 * Binds a native callback called once when an active attack finishes, or fails if the component exits play first.
+	 * @param AttackID		ID of the active attack.
+	 * @param Delegate		Callback.
+	 * @returns uint32		Handle of the binding, used to unbind it. 0 if the attack isn't active.
+	 */
+	uint32 BindAttackFinished(const uint8 AttackID, FOnAttackFinished&& Delegate);
+
+	/*
+	 * Unbinds a callback waiting for an attack to finish. Does nothing if it was already called.
+	 * @param Handle	Handle of the binding.
+	 */
+	void UnbindAttackFinished(const uint32 Handle);
+
+	/*
+	 * Gets the ID of the last attack that was started.
+	 */
+	FORCEINLINE uint8 GetLastAttackID() const { return LastAttackID; }
+
+	/*
+	 * Checks whether an attack is active.
+	 * @param AttackID	ID of the attack.
+	 */
+	FORCEINLINE bool IsAttackActive(const uint8 AttackID) const { return ActiveAttacks.Contains(AttackID); }
+
+	/** Deprecated, hits are tracked per attack and cleared when the attack finishes. Does nothing. */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Damage", meta = (DeprecatedFunction, DeprecationMessage = "Hits are tracked per attack and cleared when the attack finishes."))
 	void ClearDamagedActors();
 
+	/*
+	 * Called by the melee query subsystem with the results of a batched sweep.
+	 * @param AttackID	ID of the attack the sweep belongs to.
+	 * @param Hits		Hits from the sweep.
+	 */
+	void ReceiveSweepResults(const uint8 AttackID, const TArray<FHitResult>& Hits);
+
 public:
 	/** Finalizes character's attack direction. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Gameplay")
 	void FinalizeAttackDirection(FVector MovementIntent);
 
 protected:
+	/** Active attacks, by ID and by attack name. */
+	TActionTracker<EActionKind::Attack> ActiveAttacks;
+
+	/** The component's owner. */
+	UPROPERTY(VisibleAnywhere, Category = "Owner")
+	ACharacter* Owner;
+
+	/** The owner's ability system. */
+	UPROPERTY()
+	class UGameAbilitySystemComponent* AbilitySystem;
+
+	/** The world's melee query subsystem, used to batch hit sweeps. */
+	UPROPERTY()
+	class UMeleeQuerySubsystem* MeleeQuerySubsystem;
+
+	/** The world's damageable subsystem, used to get the combat index of hit actors. */
+	UPROPERTY()
+	class UDamageableSubsystem* DamageableSubsystem;
+
 	/*
-	 * Array of active attack IDs.
+	 * Hit detection state of the active attacks.
 	 */
-	TArray<uint8> ActiveAttackIDs;
+	TArray<FAttackTraceState> AttackTraceStates;
+
+	/** Native callbacks waiting for attacks to finish. */
+	TArray<FAttackFinishedBinding, TInlineAllocator<2>> AttackFinishedBindings;
+
+	/** Handle given to the next attack finished binding. */
+	uint32 NextAttackFinishedHandle;
 
+	/** ID of the last attack that was started. */
+	uint8 LastAttackID;
+
+protected:
 	/*
-	 * Map of active attack names to IDs.
+	 * Gets the hit detection state of an active attack, creating it if necessary.
+	 * @param AttackID				ID of the active attack.
+	 * @returns FAttackTraceState*	Hit detection state of the attack. Null if the attack isn't active.
 	 */
-	TMap<FString, TArray<uint8>> ActiveAttackNameIDsMap;
+	FAttackTraceState* FindOrAddAttackTrace(const uint8 AttackID);
 
-	/** The component's owner. */
-	UPROPERTY(VisibleAnywhere, Category = "Owner")
-	ACharacter* Owner;
+	/*
+	 * Releases the hit detection state of an attack.
+	 * @param AttackID	ID of the attack.
+	 */
+	void ReleaseAttackTrace(const uint8 AttackID);
+
+	/*
+	 * Ends an active attack: finishes its ability, releases its hit detection and calls the callbacks waiting for it.
+	 * Shared by every FinishAttack override, so the callbacks are called once whichever component finishes the attack.
+	 * @param AttackName	Name of the attack ability.
+	 * @param AttackID		ID of the attack.
+	 */
+	void EndActiveAttack(const FString& AttackName, const uint8 AttackID);
+
+	/*
+	 * Calls and removes the callbacks waiting for an attack to finish.
+	 * @param AttackID		ID of the attack.
+	 * @param bSuccessful	Whether the attack finished normally.
+	 */
+	void NotifyAttackFinished(const uint8 AttackID, const bool bSuccessful);
+
+	/*
+	 * Sweeps the weapon of an attack from its previous location to its current location.
+	 * Uses the baked trajectory of the attack while its montage plays, otherwise the live weapon sockets.
+	 * @param TraceState	Hit detection state of the attack.
+	 */
+	void SweepAttack(FAttackTraceState& TraceState);
+
+	/*
+	 * Sweeps a shape for an attack, either batched or synchronously.
+	 * @param TraceState	Hit detection state of the attack.
+	 * @param Start			Start of the sweep.
+	 * @param End			End of the sweep.
+	 * @param Rotation		Rotation of the shape.
+	 * @param Shape			Shape to sweep.
+	 */
+	void SweepSegment(FAttackTraceState& TraceState, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape);
+
+	/*
+	 * Gets the server time the targets of the owner's attacks should be rewound to, so hits are checked against where
+	 * the owner's client saw them. Only applies on servers, to owners controlled by remote clients.
+	 * @param OutTime	Server time to rewind to.
+	 * @returns bool	Whether the owner's hits should be lag compensated.
+	 */
+	bool GetLagCompensationTime(float& OutTime) const;
+
+	/*
+	 * Sweeps a sphere for an attack against the hitbox histories of the damageable actors near it.
+	 * Actors without a hitbox history are swept synchronously at their current location.
+	 * @param TraceState	Hit detection state of the attack.
+	 * @param Start			Start of the sweep.
+	 * @param End			End of the sweep.
+	 * @param Radius		Radius of the sphere.
+	 * @param RewindTime	Server time to rewind the targets to.
+	 */
+	void SweepSegmentRewound(FAttackTraceState& TraceState, const FVector& Start, const FVector& End, const float Radius, const float RewindTime);
+
+	/*
+	 * Applies the effects of an attack to the damageable actors in a set of hits.
+	 * @param TraceState	Hit detection state of the attack.
+	 * @param Hits			Hits from the sweep.
+	 */
+	void ProcessHits(FAttackTraceState& TraceState, const TArray<FHitResult>& Hits);
+
+	/*
+	 * Applies the effects of an attack to an actor, unless the attack has already hit it.
+	 * @param TraceState	Hit detection state of the attack.
+	 * @param Attack		The attack.
+	 * @param HitActor		Actor hit.
+	 * @param HitPoint		Point the actor was hit at.
+	 */
+	void RegisterHit(FAttackTraceState& TraceState, const UAttack* Attack, AActor* HitActor, const FVector& HitPoint);
 
 protected:
 	/*
@@ -13,8 +13,7 @@ UDodgeComponent::UDodgeComponent()
 	PrimaryComponentTick.bCanEverTick = true;
 
 	// Clear active dodges.
-	ActiveDodgeIDs.Empty();
-	ActiveDodgeNameIDsMap.Empty();
+	ActiveDodges.Reset();
 }
 
 // Called when the game starts
@@ -40,15 +39,7 @@ bool UDodgeComponent::Dodge_Implementation(const FString& DodgeName = FString("D
 
 			if (Activated)
 			{
-				ActiveDodgeIDs.Add(DodgeID);
-
-				if (!ActiveDodgeNameIDsMap.Contains(DodgeName))
-				{
-					TArray<uint8> DodgeIDs = TArray<uint8>();
-					ActiveDodgeNameIDsMap.Add(DodgeName, DodgeIDs);
-				}
-				ActiveDodgeNameIDsMap[DodgeName].Add(DodgeID);
-
+				ActiveDodges.Add(FName(*DodgeName), DodgeID);
 				return true;
 			}
 		}
@@ -60,51 +51,11 @@ bool UDodgeComponent::Dodge_Implementation(const FString& DodgeName = FString("D
 void UDodgeComponent::FinishDodge_Implementation(const FString& DodgeName = FString("Dodge"), const uint8 DodgeID = 0)
 {
 	UGameAbilitySystemComponent* AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
+	const int32 FinishedID = ActiveDodges.Resolve(FName(*DodgeName), DodgeID);
 
-	if (!DodgeName.Equals(FString("")))
+	if (FinishedID != INDEX_NONE && AbilitySystem)
 	{
-		if (ActiveDodgeNameIDsMap.Contains(DodgeName))
-		{
-			TArray<uint8> IDs = ActiveDodgeNameIDsMap[DodgeName];
-
-			if (IDs.Num() > 0)
-			{
-				if (IDs.Contains(DodgeID) && ActiveDodgeIDs.Contains(DodgeID))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(DodgeName, DodgeID);
-						ActiveDodgeIDs.Remove(DodgeID);
-						ActiveDodgeNameIDsMap[DodgeName].Remove(DodgeID);
-					}
-				}
-				else if (ActiveDodgeIDs.Contains(IDs[0]))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(DodgeName, IDs[0]);
-						ActiveDodgeIDs.Remove(IDs[0]);
-						ActiveDodgeNameIDsMap[DodgeName].Remove(IDs[0]);
-					}
-				}
-			}
-		}
-	}
-
-	else if (ActiveDodgeIDs.Contains(DodgeID))
-	{
-		if (AbilitySystem)
-		{
-			AbilitySystem->FinishAbility(DodgeName, DodgeID);
-			ActiveDodgeIDs.Remove(DodgeID);
-
-			if (ActiveDodgeNameIDsMap.Contains(DodgeName))
-			{
-				if (ActiveDodgeNameIDsMap[DodgeName].Contains(DodgeID))
-				{
-					ActiveDodgeNameIDsMap[DodgeName].Remove(DodgeID);
-				}
-			}
-		}
+		AbilitySystem->FinishAbility(DodgeName, FinishedID);
+		ActiveDodges.Remove(FinishedID);
 	}
 }
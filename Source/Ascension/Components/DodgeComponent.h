@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Abilities/ActionTracker.h"
 #include "DodgeComponent.generated.h"
 
 
@@ -50,15 +51,8 @@ public:
 	virtual void FinishDodge_Implementation(const FString& DodgeName, const uint8 DodgeID);
 
 protected:
-	/*
-	 * Array of active dodge IDs.
-	 */
-	TArray<uint8> ActiveDodgeIDs;
-
-	/*
-	 * Map of active dodge names to IDs.
-	 */
-	TMap<FString, TArray<uint8>> ActiveDodgeNameIDsMap;
+	/** Active dodges, by ID and by dodge name. */
+	TActionTracker<EActionKind::Dodge> ActiveDodges;
 
 	/** The component's owner. */
 	UPROPERTY(VisibleAnywhere, Category = "Owner")
@@ -5,8 +5,51 @@
 #include "Interfaces/GameMovementInterface.h"
 #include "Abilities/Attacks/Attack.h"
 #include "Abilities/AbilitySystems/GameAbilitySystemComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "Curves/CurveVector.h"
+#include "Components/StateTimelineComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 
+DECLARE_CYCLE_STAT(TEXT("Full Movement"), STAT_FullMovement, STATGROUP_Ascension);
+DECLARE_CYCLE_STAT(TEXT("Lightweight Movement"), STAT_LightweightMovement, STATGROUP_Ascension);
+
+static TAutoConsoleVariable<int32> CVarMovementProfilePrediction(
+	TEXT("Ascension.Movement.ProfilePrediction"),
+	1,
+	TEXT("Whether the server simulates client moves with the movement profile the client predicted them with."),
+	ECVF_Default);
+
+/** Client moves checked and corrected by the server, for the correction report. */
+static int64 GServerMovesChecked = 0;
+static int64 GServerCorrections = 0;
+static double GCorrectionCountStartTime = 0.0;
+
+/** Cycles and ticks spent in full and lightweight movement, for the movement cost report. */
+static uint64 GMovementModeCycles[2] = { 0, 0 };
+static int64 GMovementModeTicks[2] = { 0, 0 };
+
+
+/*
+ * Makes the movement modifier of an instance of controlled movement.
+ */
+static FMovementModifier MakeControlledMovementModifier(const float Speed, const float Acceleration, const float TurnRate, const bool bHasZMovement,
+														const int32 Priority, const uint8 ProfileID)
+{
+	FMovementModifier Modifier;
+	Modifier.Priority = Priority;
+	Modifier.ProfileID = ProfileID;
+	Modifier.SetSpeed(Speed).SetAcceleration(Acceleration).SetTurnRate(TurnRate);
+
+	if (bHasZMovement)
+	{
+		Modifier.SetFly();
+	}
+
+	return Modifier;
+}
+
+
 // Sets default values for this component's properties
 UGameMovementComponent::UGameMovementComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -19,29 +62,343 @@ UGameMovementComponent::UGameMovementComponent(const FObjectInitializer& ObjectI
 	DefaultSpeed = MaxWalkSpeed;
 	DefaultAcceleration = MaxAcceleration;
 	DefaultTurnRate = RotationRate.Yaw;
+	DefaultGravity = GravityScale;
 	MovementDirection = FVector();
-	ControlledMovementInstanceID = 0;
-	AbilityNameIDsMap.Empty();
+
+	StateTimeline = nullptr;
+
+	// Set lightweight movement variables.
+	LightweightSweepInterval = 0.5f;
+	bWantsLightweightMovement = false;
+	TimeSinceLightweightSweep = 0.0f;
+	bProjectNavMeshWalking = true;
+
+	// Clear movement modifiers.
+	NextModifierHandle = 1;
+	NextModifierSequence = 0;
+	DirectModifierHandle = 0;
+	bModifierFlying = false;
+
+	// Set network prediction variables.
+	MovementProfileID = 0;
+	bUseNetworkProfile = false;
+	NetworkProfileID = 0;
+	SetNetworkMoveDataContainer(NetworkMoveDataContainer);
+
+	// Set controlled movement variables.
+	BasisDirection = FVector::ZeroVector;
+	BasisForward = FVector::ForwardVector;
+	BasisRight = FVector::RightVector;
+	BasisUp = FVector::UpVector;
+	MovementCurve = nullptr;
+	MovementCurveMontage = nullptr;
+	MovementCurveInstanceID = 0;
 }
 
 // Called when the game starts
 void UGameMovementComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	StateTimeline = GetOwner()->FindComponentByClass<UStateTimelineComponent>();
 }
 
-int UGameMovementComponent::SetupControlledMovement(float TargetSpeed, float TargetAcceleration, float TargetTurnRate,
-													float MaxTurnAngleDegrees = 0.0f, bool HasZMovement = false)
+// Called every frame
+void UGameMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// Input has to be added before the movement consumes it.
+	if (MovementCurve != nullptr)
+	{
+		ApplyMovementCurve();
+	}
+
+	// Lightweight movement starts once the character is walking, e.g. after landing.
+	if (bWantsLightweightMovement && MovementMode == EMovementMode::MOVE_Walking)
+	{
+		SetMovementMode(EMovementMode::MOVE_NavWalking);
+	}
+
+	const bool bLightweight = IsLightweightMovement();
+
+	if (bLightweight)
+	{
+		// Only sweep for collisions every so often.
+		TimeSinceLightweightSweep += DeltaTime;
+		bSweepWhileNavWalking = TimeSinceLightweightSweep >= LightweightSweepInterval;
+
+		if (bSweepWhileNavWalking)
+		{
+			TimeSinceLightweightSweep = 0.0f;
+		}
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	{
+		FScopeCycleCounter CycleCounter(bLightweight ? GET_STATID(STAT_LightweightMovement) : GET_STATID(STAT_FullMovement));
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	}
+
+	GMovementModeCycles[bLightweight ? 1 : 0] += FPlatformTime::Cycles64() - StartCycles;
+	GMovementModeTicks[bLightweight ? 1 : 0]++;
+}
+
+FNetworkPredictionData_Client* UGameMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UGameMovementComponent* MutableThis = const_cast<UGameMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Game(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+bool UGameMovementComponent::ClientUpdatePositionAfterServerUpdate()
+{
+	// Saved moves are replayed with their own movement profiles.
+	const bool bResult = Super::ClientUpdatePositionAfterServerUpdate();
+	SetNetworkMovementProfile(false);
+	return bResult;
+}
+
+void UGameMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	const FGameCharacterNetworkMoveData* MoveData = static_cast<const FGameCharacterNetworkMoveData*>(GetCurrentNetworkMoveData());
+
+	if (MoveData != nullptr)
+	{
+		SetNetworkMovementProfile(CVarMovementProfilePrediction.GetValueOnGameThread() != 0, MoveData->MovementProfileID);
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+bool UGameMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc,
+													UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	const bool bError = Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLoc, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+
+	GServerMovesChecked++;
+	GServerCorrections += bError ? 1 : 0;
+	return bError;
+}
+
+void UGameMovementComponent::SetNetworkMovementProfile(const bool bEnable, const uint8 ProfileID)
+{
+	if (bEnable == bUseNetworkProfile && (!bEnable || ProfileID == NetworkProfileID))
+	{
+		return;
+	}
+
+	bUseNetworkProfile = bEnable;
+	NetworkProfileID = ProfileID;
+	NetworkProfile = FMovementModifier();
+
+	if (bEnable && ProfileID != 0)
+	{
+		// Profiles are ability slots, which are registered in the same order on every machine.
+		const UGameAbilitySystemComponent* AbilitySystemComponent = GetOwner()->FindComponentByClass<UGameAbilitySystemComponent>();
+		const TSubclassOf<UAbility> AbilityClass = AbilitySystemComponent ? AbilitySystemComponent->GetAbilityInSlot(ProfileID - 1) : nullptr;
+
+		if (AbilityClass != nullptr)
+		{
+			const FCustomMovementParams MovementParams = AbilityClass.GetDefaultObject()->GetMovementParams();
+			NetworkProfile = MakeControlledMovementModifier(MovementParams.Speed, MovementParams.Acceleration, MovementParams.TurnRate,
+															MovementParams.HasZMovement, MovementParams.Priority, ProfileID);
+		}
+		else
+		{
+			// Unknown profiles fall back to the local ability modifiers.
+			bUseNetworkProfile = false;
+		}
+	}
+
+	ApplyMovementModifiers();
+}
+
+void UGameMovementComponent::SetLightweightMovement(const bool bEnable)
+{
+	bWantsLightweightMovement = bEnable;
+
+	if (bEnable && MovementMode == EMovementMode::MOVE_Walking)
+	{
+		TimeSinceLightweightSweep = 0.0f;
+		SetMovementMode(EMovementMode::MOVE_NavWalking);
+	}
+	else if (!bEnable && MovementMode == EMovementMode::MOVE_NavWalking)
+	{
+		// Walking finds the floor under the character when it starts.
+		SetMovementMode(EMovementMode::MOVE_Walking);
+	}
+}
+
+int32 UGameMovementComponent::PushMovementModifier(const FMovementModifier& Modifier, const FName Source)
+{
+	if (MovementModifiers.Num() >= MaxMovementModifiers)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: Movement modifier stack is full, %s not applied."), *GetNameSafe(GetOwner()), *Source.ToString())
+		return 0;
+	}
+
+	FMovementModifierSlot& Slot = MovementModifiers.AddDefaulted_GetRef();
+	Slot.Handle = NextModifierHandle++;
+	Slot.Sequence = NextModifierSequence++;
+	Slot.Source = Source;
+	Slot.Modifier = Modifier;
+
+	// Handles stay positive so 0 can mean no modifier.
+	if (NextModifierHandle <= 0)
+	{
+		NextModifierHandle = 1;
+	}
+
+	ApplyMovementModifiers();
+
+	if (StateTimeline)
+	{
+		StateTimeline->Record(EStateTimelineChannel::ModifierPushed, (uint8) MovementModifiers.Num(), (uint16) Slot.Handle, Source);
+	}
+
+	return Slot.Handle;
+}
+
+bool UGameMovementComponent::RemoveMovementModifier(const int32 Handle)
 {
-	SetMovementSpeed(TargetSpeed);
-	SetAcceleration(TargetAcceleration);
-	SetTurningRate(TargetTurnRate);
+	const int32 SlotIndex = MovementModifiers.IndexOfByPredicate([Handle](const FMovementModifierSlot& Slot) { return Slot.Handle == Handle; });
 
-	if (HasZMovement)
+	if (SlotIndex == INDEX_NONE)
 	{
-		SetFlyable();
+		return false;
 	}
 
+	const FName Source = MovementModifiers[SlotIndex].Source;
+	MovementModifiers.RemoveAtSwap(SlotIndex, 1, false);
+	ApplyMovementModifiers();
+
+	if (StateTimeline)
+	{
+		StateTimeline->Record(EStateTimelineChannel::ModifierRemoved, (uint8) MovementModifiers.Num(), (uint16) Handle, Source);
+	}
+
+	return true;
+}
+
+bool UGameMovementComponent::UpdateMovementModifier(const int32 Handle, const FMovementModifier& Modifier)
+{
+	FMovementModifierSlot* Slot = MovementModifiers.FindByPredicate([Handle](const FMovementModifierSlot& Slot) { return Slot.Handle == Handle; });
+
+	if (Slot == nullptr)
+	{
+		return false;
+	}
+
+	Slot->Modifier = Modifier;
+	Slot->Sequence = NextModifierSequence++;
+
+	if (StateTimeline)
+	{
+		StateTimeline->Record(EStateTimelineChannel::ModifierUpdated, (uint8) MovementModifiers.Num(), (uint16) Handle, Slot->Source);
+	}
+
+	ApplyMovementModifiers();
+	return true;
+}
+
+void UGameMovementComponent::SetDefaultMovement(const float Speed, const float Acceleration, const float TurnRate)
+{
+	DefaultSpeed = Speed;
+	DefaultAcceleration = Acceleration;
+	DefaultTurnRate = TurnRate;
+	ApplyMovementModifiers();
+}
+
+void UGameMovementComponent::ApplyMovementModifiers()
+{
+	// Finds the modifier that wins a property: highest priority, then most recent.
+	auto FindWinner = [this](const EMovementModifierFlags Flag) -> const FMovementModifier*
+	{
+		const FMovementModifierSlot* Winner = nullptr;
+
+		for (const FMovementModifierSlot& Slot : MovementModifiers)
+		{
+			// The network profile replaces the modifiers of abilities while it is used.
+			if (bUseNetworkProfile && Slot.Modifier.ProfileID != 0)
+			{
+				continue;
+			}
+
+			if (EnumHasAnyFlags(Slot.Modifier.Flags, Flag) && (Winner == nullptr || Slot.Modifier.Priority > Winner->Modifier.Priority ||
+				(Slot.Modifier.Priority == Winner->Modifier.Priority && Slot.Sequence > Winner->Sequence)))
+			{
+				Winner = &Slot;
+			}
+		}
+
+		// The network profile counts as the most recent modifier.
+		if (bUseNetworkProfile && EnumHasAnyFlags(NetworkProfile.Flags, Flag) && (Winner == nullptr || NetworkProfile.Priority >= Winner->Modifier.Priority))
+		{
+			return &NetworkProfile;
+		}
+
+		return Winner ? &Winner->Modifier : nullptr;
+	};
+
+	const FMovementModifier* SpeedModifier = FindWinner(EMovementModifierFlags::Speed);
+	const FMovementModifier* AccelerationModifier = FindWinner(EMovementModifierFlags::Acceleration);
+	const FMovementModifier* TurnRateModifier = FindWinner(EMovementModifierFlags::TurnRate);
+	const FMovementModifier* GravityModifier = FindWinner(EMovementModifierFlags::Gravity);
+
+	MaxWalkSpeed = SpeedModifier ? SpeedModifier->Speed : DefaultSpeed;
+	MaxAcceleration = AccelerationModifier ? AccelerationModifier->Acceleration : DefaultAcceleration;
+	RotationRate = FRotator(0.0f, TurnRateModifier ? TurnRateModifier->TurnRate : DefaultTurnRate, 0.0f);
+	GravityScale = GravityModifier ? GravityModifier->Gravity : DefaultGravity;
+
+	// Only leave flying if the stack put the character in it.
+	const bool bShouldFly = FindWinner(EMovementModifierFlags::Fly) != nullptr;
+
+	if (bShouldFly && MovementMode != EMovementMode::MOVE_Flying)
+	{
+		SetMovementMode(EMovementMode::MOVE_Flying);
+	}
+	else if (!bShouldFly && bModifierFlying && MovementMode == EMovementMode::MOVE_Flying)
+	{
+		SetMovementMode(EMovementMode::MOVE_Falling);
+	}
+
+	bModifierFlying = bShouldFly;
+
+	// The profile of the winning ability modifier is what the client sends with its moves.
+	const FMovementModifierSlot* ProfileSlot = nullptr;
+
+	for (const FMovementModifierSlot& Slot : MovementModifiers)
+	{
+		if (Slot.Modifier.ProfileID != 0 && (ProfileSlot == nullptr || Slot.Modifier.Priority > ProfileSlot->Modifier.Priority ||
+			(Slot.Modifier.Priority == ProfileSlot->Modifier.Priority && Slot.Sequence > ProfileSlot->Sequence)))
+		{
+			ProfileSlot = &Slot;
+		}
+	}
+
+	MovementProfileID = ProfileSlot ? ProfileSlot->Modifier.ProfileID : 0;
+}
+
+int UGameMovementComponent::SetupControlledMovement(float TargetSpeed, float TargetAcceleration, float TargetTurnRate,
+													float MaxTurnAngleDegrees, bool HasZMovement, int32 Priority)
+{
+	return BeginControlledMovement(TargetSpeed, TargetAcceleration, TargetTurnRate, MaxTurnAngleDegrees, HasZMovement, Priority, NAME_None);
+}
+
+int32 UGameMovementComponent::BeginControlledMovement(float TargetSpeed, float TargetAcceleration, float TargetTurnRate,
+													  float MaxTurnAngleDegrees, bool HasZMovement, int32 Priority, const FName Source, const uint8 ProfileID)
+{
+	const FMovementModifier Modifier = MakeControlledMovementModifier(TargetSpeed, TargetAcceleration, TargetTurnRate, HasZMovement, Priority, ProfileID);
+	const int32 Handle = PushMovementModifier(Modifier, Source);
+
+	// A new instance of controlled movement replaces any movement driven by a curve.
+	MovementCurve = nullptr;
+	MovementCurveMontage = nullptr;
+	MovementCurveInstanceID = 0;
+
 	AActor* Owner = GetOwner();
 	if (Owner->Implements<UGameMovementInterface>())
 	{
@@ -67,7 +424,7 @@ int UGameMovementComponent::SetupControlledMovement(float TargetSpeed, float Tar
 		SetMovementDirection(Owner->GetActorForwardVector());
 	}
 
-	return ++ControlledMovementInstanceID;
+	return Handle;
 }
 
 int UGameMovementComponent::SetupControlledMovementAbility(FString AbilityName)
@@ -78,18 +435,25 @@ int UGameMovementComponent::SetupControlledMovementAbility(FString AbilityName)
 	const UAbility* Ability = AbilitySystemComponent->GetActiveAbility(AbilityName, 0);
 	if (Ability != nullptr)
 	{
+		// The ability's slot identifies its movement profile on the server.
+		const int32 Slot = AbilitySystemComponent->GetAbilitySlot(AbilityName);
+		const uint8 ProfileID = Slot != INDEX_NONE && Slot < MAX_uint8 ? uint8(Slot + 1) : 0;
+
 		FCustomMovementParams MovementParams = Ability->GetMovementParams();
-		int MovementID = SetupControlledMovement(MovementParams.Speed, MovementParams.Acceleration, MovementParams.TurnRate,
-												 MovementParams.MaxTurnAngleDegrees, MovementParams.HasZMovement);
+		int MovementID = BeginControlledMovement(MovementParams.Speed, MovementParams.Acceleration, MovementParams.TurnRate,
+												 MovementParams.MaxTurnAngleDegrees, MovementParams.HasZMovement,
+												 MovementParams.Priority, FName(*AbilityName), ProfileID);
+
+		// Drive the movement natively if the ability describes it with a curve.
+		UAnimMontage* Montage = Ability->GetAnimMontage();
 
-		if (!AbilityNameIDsMap.Contains(AbilityName))
+		if (MovementParams.MovementCurve != nullptr && Montage != nullptr)
 		{
-			TArray<int> IDs = TArray<int>();
-			AbilityNameIDsMap.Add(AbilityName, IDs);
+			MovementCurve = MovementParams.MovementCurve;
+			MovementCurveMontage = Montage;
+			MovementCurveInstanceID = MovementID;
 		}
 
-		AbilityNameIDsMap[AbilityName].Add(MovementID);
-
 		return MovementID;
 	}
 
@@ -99,109 +463,292 @@ int UGameMovementComponent::SetupControlledMovementAbility(FString AbilityName)
 void UGameMovementComponent::ControlledMove(FVector MovementVector)
 {
 	// Movement direction is the direction in relation to which the controlled movement is applied.
-	FRotator MovementRotation = MovementDirection.Rotation();
-	FVector ForwardVector = UKismetMathLibrary::GetForwardVector(MovementRotation) * MovementVector.X;
-	FVector SideVector = UKismetMathLibrary::GetRightVector(MovementRotation) * MovementVector.Y;
-	FVector UpVector = UKismetMathLibrary::GetUpVector(MovementRotation) * MovementVector.Z;
+	// The direction can be written from Blueprint, so the basis is refreshed if it changed.
+	if (MovementDirection != BasisDirection)
+	{
+		UpdateMovementBasis();
+	}
 
-	FVector Direction = ForwardVector + SideVector + UpVector;
+	FVector Direction = BasisForward * MovementVector.X + BasisRight * MovementVector.Y + BasisUp * MovementVector.Z;
 	AddInputVector(Direction, false);
 }
 
+void UGameMovementComponent::ApplyMovementCurve()
+{
+	const UAnimInstance* AnimInstance = CharacterOwner && CharacterOwner->GetMesh() ? CharacterOwner->GetMesh()->GetAnimInstance() : nullptr;
+
+	if (AnimInstance == nullptr || MovementCurveMontage == nullptr || !AnimInstance->Montage_IsPlaying(MovementCurveMontage))
+	{
+		MovementCurve = nullptr;
+		MovementCurveMontage = nullptr;
+		MovementCurveInstanceID = 0;
+		return;
+	}
+
+	const float PlayLength = MovementCurveMontage->GetPlayLength();
+	const float NormalizedTime = PlayLength > 0.0f ? AnimInstance->Montage_GetPosition(MovementCurveMontage) / PlayLength : 0.0f;
+
+	ControlledMove(MovementCurve->GetVectorValue(NormalizedTime));
+}
+
 void UGameMovementComponent::FinishControlledMovement(int InstanceID = 0)
 {
-	if (ControlledMovementInstanceID == InstanceID)
+	RemoveMovementModifier(InstanceID);
+
+	if (MovementCurveInstanceID == InstanceID)
 	{
-		ResetMovementSpeed();
-		ResetTurningRate();
-		ResetAcceleration();
-		ResetFlyable();
-		ControlledMovementInstanceID = 0;
+		MovementCurve = nullptr;
+		MovementCurveMontage = nullptr;
+		MovementCurveInstanceID = 0;
 	}
 }
 
 void UGameMovementComponent::FinishControlledMovementAbility(FString AbilityName = FString(""), int InstanceID = 0)
 {
-	if (!AbilityName.Equals(FString("")))
+	if (AbilityName.IsEmpty())
+	{
+		return;
+	}
+
+	const FName Source(*AbilityName);
+	const FMovementModifierSlot* Instance = nullptr;
+
+	// The given instance if it belongs to the ability, otherwise the ability's oldest instance.
+	for (const FMovementModifierSlot& Slot : MovementModifiers)
 	{
-		if (AbilityNameIDsMap.Contains(AbilityName))
+		if (Slot.Source != Source)
 		{
-			TArray<int> IDs = AbilityNameIDsMap[AbilityName];
+			continue;
+		}
 
-			if (IDs.Num() > 0)
-			{
-				if (IDs.Contains(InstanceID))
-				{
-					FinishControlledMovement(InstanceID);
-					AbilityNameIDsMap[AbilityName].Remove(InstanceID);
-				}
-				else
-				{
-					FinishControlledMovement(IDs[0]);
-					AbilityNameIDsMap[AbilityName].Remove(IDs[0]);
-				}
-			}
+		if (Slot.Handle == InstanceID)
+		{
+			Instance = &Slot;
+			break;
+		}
+
+		if (Instance == nullptr || Slot.Sequence < Instance->Sequence)
+		{
+			Instance = &Slot;
 		}
 	}
+
+	if (Instance != nullptr)
+	{
+		FinishControlledMovement(Instance->Handle);
+	}
+}
+
+void UGameMovementComponent::UpdateDirectModifier()
+{
+	if (DirectModifier.Flags == EMovementModifierFlags::None)
+	{
+		RemoveMovementModifier(DirectModifierHandle);
+		DirectModifierHandle = 0;
+	}
+	else if (!UpdateMovementModifier(DirectModifierHandle, DirectModifier))
+	{
+		DirectModifierHandle = PushMovementModifier(DirectModifier, FName("Direct"));
+	}
 }
 
 void UGameMovementComponent::SetMovementSpeed(float Speed)
 {
-	MaxWalkSpeed = Speed;
+	DirectModifier.SetSpeed(Speed);
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::ResetMovementSpeed()
 {
-	MaxWalkSpeed = DefaultSpeed;
+	DirectModifier.Flags &= ~EMovementModifierFlags::Speed;
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::SetAcceleration(float TargetAcceleration)
 {
-	MaxAcceleration = TargetAcceleration;
+	DirectModifier.SetAcceleration(TargetAcceleration);
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::ResetAcceleration()
 {
-	MaxAcceleration = DefaultAcceleration;
+	DirectModifier.Flags &= ~EMovementModifierFlags::Acceleration;
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::SetTurningRate(float Rate)
 {
-	RotationRate = FRotator(0.0f, Rate, 0.0f);
+	DirectModifier.SetTurnRate(Rate);
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::ResetTurningRate()
 {
-	RotationRate = FRotator(0.0f, DefaultTurnRate, 0.0f);
+	DirectModifier.Flags &= ~EMovementModifierFlags::TurnRate;
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::SetMovementDirection(FVector Direction)
 {
 	MovementDirection = Direction;
+	UpdateMovementBasis();
+}
+
+void UGameMovementComponent::UpdateMovementBasis()
+{
+	const FRotationMatrix MovementRotation(MovementDirection.Rotation());
+	BasisForward = MovementRotation.GetScaledAxis(EAxis::X);
+	BasisRight = MovementRotation.GetScaledAxis(EAxis::Y);
+	BasisUp = MovementRotation.GetScaledAxis(EAxis::Z);
+	BasisDirection = MovementDirection;
 }
 
 void UGameMovementComponent::SetGravity(float GravityValue)
 {
-	GravityScale = GravityValue;
+	DirectModifier.SetGravity(GravityValue);
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::ResetGravity()
 {
-	GravityScale = 1.0f;
+	DirectModifier.Flags &= ~EMovementModifierFlags::Gravity;
+	UpdateDirectModifier();
 }
 
 void UGameMovementComponent::SetFlyable()
 {
-	if (MovementMode != EMovementMode::MOVE_Flying)
+	DirectModifier.SetFly();
+	UpdateDirectModifier();
+}
+
+void UGameMovementComponent::ResetFlyable()
+{
+	DirectModifier.Flags &= ~EMovementModifierFlags::Fly;
+	UpdateDirectModifier();
+}
+
+/*
+ * Console command reporting the average cost of a movement tick in full and lightweight movement.
+ */
+static FAutoConsoleCommandWithWorldAndArgs MovementModeCostCommand(
+	TEXT("Ascension.Movement.ModeCost"),
+	TEXT("Reports the average cost of a movement tick in full and lightweight movement. Add Reset=1 to reset the counters."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		static const TCHAR* ModeNames[2] = { TEXT("Full"), TEXT("Lightweight") };
+
+		for (int32 Mode = 0; Mode < 2; Mode++)
+		{
+			const double Milliseconds = FPlatformTime::ToMilliseconds64(GMovementModeCycles[Mode]);
+			UE_LOG(LogBenchmark, Log, TEXT("Movement cost: %s | %lld ticks | %.3f us per tick"), ModeNames[Mode], GMovementModeTicks[Mode],
+				   GMovementModeTicks[Mode] > 0 ? Milliseconds * 1000.0 / GMovementModeTicks[Mode] : 0.0)
+		}
+
+		bool bReset = false;
+		for (const FString& Arg : Args)
+		{
+			FParse::Bool(*Arg, TEXT("Reset="), bReset);
+		}
+
+		if (bReset)
+		{
+			FMemory::Memzero(GMovementModeCycles, sizeof(GMovementModeCycles));
+			FMemory::Memzero(GMovementModeTicks, sizeof(GMovementModeTicks));
+		}
+	})
+);
+
+void FSavedMove_Game::Clear()
+{
+	Super::Clear();
+	MovementProfileID = 0;
+}
+
+void FSavedMove_Game::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+	MovementProfileID = CastChecked<UGameMovementComponent>(C->GetCharacterMovement())->GetMovementProfileID();
+}
+
+bool FSavedMove_Game::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	return MovementProfileID == static_cast<const FSavedMove_Game*>(NewMove.Get())->MovementProfileID && Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+bool FSavedMove_Game::IsImportantMove(const FSavedMovePtr& LastAckedMove) const
+{
+	return MovementProfileID != static_cast<const FSavedMove_Game*>(LastAckedMove.Get())->MovementProfileID || Super::IsImportantMove(LastAckedMove);
+}
+
+void FSavedMove_Game::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// Only replayed moves need their profile back, the movement is already in it otherwise.
+	UGameMovementComponent* MovementComponent = CastChecked<UGameMovementComponent>(C->GetCharacterMovement());
+
+	if (MovementComponent->bClientUpdating)
 	{
-		MovementMode = EMovementMode::MOVE_Flying;
+		MovementComponent->SetNetworkMovementProfile(true, MovementProfileID);
 	}
 }
 
-void UGameMovementComponent::ResetFlyable()
+FSavedMovePtr FNetworkPredictionData_Client_Game::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Game());
+}
+
+void FGameCharacterNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+	MovementProfileID = static_cast<const FSavedMove_Game&>(ClientMove).MovementProfileID;
+}
+
+bool FGameCharacterNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
 {
-	if (MovementMode == EMovementMode::MOVE_Flying)
+	const bool bSuperSerialized = Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	// Most moves have no profile, so a bit says whether one follows.
+	uint8 bHasProfile = MovementProfileID != 0 ? 1 : 0;
+	Ar.SerializeBits(&bHasProfile, 1);
+
+	if (bHasProfile)
+	{
+		Ar << MovementProfileID;
+	}
+	else
 	{
-		MovementMode = EMovementMode::MOVE_Falling;
+		MovementProfileID = 0;
 	}
+
+	return bSuperSerialized && !Ar.IsError();
 }
+
+/*
+ * Console command reporting how many client moves the server corrected.
+ */
+static FAutoConsoleCommandWithWorldAndArgs MovementCorrectionsCommand(
+	TEXT("Ascension.Movement.Corrections"),
+	TEXT("Reports how many client moves the server checked and corrected. Add Reset=1 to reset the counters."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		const double Seconds = GCorrectionCountStartTime > 0.0 ? FPlatformTime::Seconds() - GCorrectionCountStartTime : 0.0;
+
+		UE_LOG(LogBenchmark, Log, TEXT("Movement corrections: profile prediction %d | %lld moves checked | %lld corrected (%.2f%%) | %.2f per second"),
+			   CVarMovementProfilePrediction.GetValueOnGameThread(), GServerMovesChecked, GServerCorrections,
+			   GServerMovesChecked > 0 ? GServerCorrections * 100.0 / GServerMovesChecked : 0.0, Seconds > 0.0 ? GServerCorrections / Seconds : 0.0)
+
+		bool bReset = false;
+		for (const FString& Arg : Args)
+		{
+			FParse::Bool(*Arg, TEXT("Reset="), bReset);
+		}
+
+		if (bReset)
+		{
+			GServerMovesChecked = 0;
+			GServerCorrections = 0;
+			GCorrectionCountStartTime = FPlatformTime::Seconds();
+		}
+	})
+);
@@ -4,9 +4,144 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "GameMovementComponent.generated.h"
 
 
+/*
+ * Movement properties a movement modifier overrides.
+ */
+enum class EMovementModifierFlags : uint8
+{
+	None			= 0,
+	Speed			= 1 << 0,
+	Acceleration	= 1 << 1,
+	TurnRate		= 1 << 2,
+	Gravity			= 1 << 3,
+	Fly				= 1 << 4
+};
+ENUM_CLASS_FLAGS(EMovementModifierFlags);
+
+/*
+ * Override of some of a character's movement properties, pushed onto its movement component's modifier stack.
+ * For each property, the highest priority modifier overriding it wins, and the most recent one among equals.
+ */
+struct FMovementModifier
+{
+	FMovementModifier()
+		: Flags(EMovementModifierFlags::None)
+		, ProfileID(0)
+		, Priority(0)
+		, Speed(0.0f)
+		, Acceleration(0.0f)
+		, TurnRate(0.0f)
+		, Gravity(1.0f)
+	{}
+
+	/** Properties overridden by the modifier. */
+	EMovementModifierFlags Flags;
+
+	/** Movement profile the modifier was made from, sent to the server in place of the overrides. 0 if none. */
+	uint8 ProfileID;
+
+	/** Priority of the modifier. */
+	int32 Priority;
+
+	/** Maximum walk speed. */
+	float Speed;
+
+	/** Maximum acceleration. */
+	float Acceleration;
+
+	/** Yaw rotation rate. */
+	float TurnRate;
+
+	/** Gravity scale. */
+	float Gravity;
+
+	/** Overrides the speed. */
+	FORCEINLINE FMovementModifier& SetSpeed(const float InSpeed) { Speed = InSpeed; Flags |= EMovementModifierFlags::Speed; return *this; }
+
+	/** Overrides the acceleration. */
+	FORCEINLINE FMovementModifier& SetAcceleration(const float InAcceleration) { Acceleration = InAcceleration; Flags |= EMovementModifierFlags::Acceleration; return *this; }
+
+	/** Overrides the turn rate. */
+	FORCEINLINE FMovementModifier& SetTurnRate(const float InTurnRate) { TurnRate = InTurnRate; Flags |= EMovementModifierFlags::TurnRate; return *this; }
+
+	/** Overrides the gravity scale. */
+	FORCEINLINE FMovementModifier& SetGravity(const float InGravity) { Gravity = InGravity; Flags |= EMovementModifierFlags::Gravity; return *this; }
+
+	/** Makes the character fly. */
+	FORCEINLINE FMovementModifier& SetFly() { Flags |= EMovementModifierFlags::Fly; return *this; }
+};
+
+/*
+ * Saved move recording the movement profile the client simulated the move with, so replayed moves use it again.
+ */
+class FSavedMove_Game : public FSavedMove_Character
+{
+	typedef FSavedMove_Character Super;
+
+public:
+	/* Saved move functions. */
+	virtual void Clear() override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual bool IsImportantMove(const FSavedMovePtr& LastAckedMove) const override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	/** Movement profile of the move. */
+	uint8 MovementProfileID;
+};
+
+/*
+ * Client prediction data allocating game saved moves.
+ */
+class FNetworkPredictionData_Client_Game : public FNetworkPredictionData_Client_Character
+{
+	typedef FNetworkPredictionData_Client_Character Super;
+
+public:
+	FNetworkPredictionData_Client_Game(const UCharacterMovementComponent& ClientMovement) : Super(ClientMovement) {}
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/*
+ * Move data sent to the server, carrying the movement profile of the move.
+ * The profile costs a single bit when no controlled movement is active.
+ */
+struct FGameCharacterNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	FGameCharacterNetworkMoveData() : MovementProfileID(0) {}
+
+	/* Network move data functions. */
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+
+	/** Movement profile of the move. */
+	uint8 MovementProfileID;
+};
+
+/*
+ * Container of the new, pending and old game move data sent to the server.
+ */
+struct FGameCharacterNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FGameCharacterNetworkMoveDataContainer()
+	{
+		NewMoveData = &MoveData[0];
+		PendingMoveData = &MoveData[1];
+		OldMoveData = &MoveData[2];
+	}
+
+	/** New, pending and old move data. */
+	FGameCharacterNetworkMoveData MoveData[3];
+};
+
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class ASCENSION_API UGameMovementComponent : public UCharacterMovementComponent
 {
@@ -33,25 +168,112 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Movement")
 	FVector MovementDirection;
 
+	/** Time in seconds between collision sweeps during lightweight movement. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Movement|Lightweight", meta = (ClampMin = 0, UIMin = 0))
+	float LightweightSweepInterval;
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
 public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/* Network prediction functions. */
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual bool ClientUpdatePositionAfterServerUpdate() override;
+
+protected:
+	/* Network prediction functions. */
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc,
+										UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
+public:
+	/*
+	 * Movement profile of the active controlled movement, i.e. the slot of its ability plus one. 0 if none.
+	 * Clients send it with each move, so the server simulates the move with the same movement properties.
+	 */
+	FORCEINLINE uint8 GetMovementProfileID() const { return MovementProfileID; }
+
+	/*
+	 * Replaces the movement modifiers of abilities with a movement profile, while simulating a remote client's moves
+	 * on the server or replaying saved moves on the client.
+	 * @param bEnable		Whether to use the profile. The ability modifiers are used again when disabled.
+	 * @param ProfileID		Movement profile to use. 0 for none.
+	 */
+	void SetNetworkMovementProfile(const bool bEnable, const uint8 ProfileID = 0);
+
+public:
+	/*
+	 * Enables or disables lightweight movement, for characters nobody is interacting with.
+	 * Lightweight movement walks on the navmesh instead of doing floor checks, and only sweeps for collisions every
+	 * LightweightSweepInterval seconds. The character switches to it the next time it is walking, and back to full
+	 * walking right away, finding its floor again so the switch isn't visible.
+	 * @param bEnable	Whether to use lightweight movement.
+	 */
+	void SetLightweightMovement(const bool bEnable);
+
+	/*
+	 * Whether the character is using lightweight movement.
+	 */
+	FORCEINLINE bool IsLightweightMovement() const { return MovementMode == EMovementMode::MOVE_NavWalking; }
+
+public:
+	/** Maximum number of movement modifiers active at once. */
+	static constexpr int32 MaxMovementModifiers = 8;
+
+	/*
+	 * Pushes a movement modifier onto the stack and applies the resulting movement properties.
+	 * @param Modifier		Modifier to push.
+	 * @param Source		Name of what pushed the modifier, e.g. an ability name.
+	 * @returns int32		Handle of the modifier. 0 if the stack is full.
+	 */
+	int32 PushMovementModifier(const FMovementModifier& Modifier, const FName Source = NAME_None);
+
+	/*
+	 * Removes a movement modifier from the stack and applies the resulting movement properties.
+	 * @param Handle	Handle of the modifier.
+	 * @returns bool	Whether the modifier was on the stack.
+	 */
+	bool RemoveMovementModifier(const int32 Handle);
+
+	/*
+	 * Replaces the overrides of a movement modifier, making it the most recent of its priority.
+	 * @param Handle	Handle of the modifier.
+	 * @param Modifier	New overrides of the modifier.
+	 * @returns bool	Whether the modifier was on the stack.
+	 */
+	bool UpdateMovementModifier(const int32 Handle, const FMovementModifier& Modifier);
+
+	/*
+	 * Sets the movement properties used when no modifier overrides them.
+	 * @param Speed			Default maximum walk speed.
+	 * @param Acceleration	Default maximum acceleration.
+	 * @param TurnRate		Default yaw rotation rate.
+	 */
+	void SetDefaultMovement(const float Speed, const float Acceleration, const float TurnRate);
+
 	/*
 	 * Function to setup variables for controlled movement.
+	 * Pushes a movement modifier, finished with FinishControlledMovement.
 	 * @param TargetSpeed				Speed at which movement is to be performed.
 	 * @param TargetAcceleration		Acceleration with which movement is to be performed.
 	 * @param TargetTurnRate			Turn rate at which movement is to be performed.
 	 * @param MaxTurnAngleDegrees		Maximum angle at which the movement can differ from the character's current direction.
 	 * @param HasZMovement				Whether the movement contains movement along the Z-axis.
+	 * @param Priority					Priority of the movement over other movement modifiers.
+	 * @returns int						Instance ID of the controlled movement.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	virtual int SetupControlledMovement(float TargetSpeed, float TargetAcceleration, float TargetTurnRate,
-										float MaxTurnAngleDegrees, bool HasZMovement);
+										float MaxTurnAngleDegrees, bool HasZMovement, int32 Priority = 0);
 
 	/*
 	 * Function to setup variables for controlled movement during an ability.
+	 * If the ability has a movement curve and a montage, the movement is driven from the curve every tick until the
+	 * montage stops or the movement is finished, and doesn't need to be driven with ControlledMove.
 	 * @param AbilityName	Name of the active ability.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
@@ -65,20 +287,27 @@ public:
 	void ControlledMove(FVector MovementVector);
 
 	/*
-	 * Function that resets movement params to default values when controlled movement completes.
+	 * Function that removes the movement modifier of controlled movement when it completes.
 	 * @param InstanceID	ID of the instance of controlled movement.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	virtual void FinishControlledMovement(int InstanceID);
 
 	/*
-	 * Function that resets movement params to default values when controlled movement completes.
+	 * Function that removes the movement modifier of an ability's controlled movement when it completes.
+	 * Removes the instance if it belongs to the ability, otherwise the ability's oldest instance.
 	 * @param AbilityName	Name of the ability for which controlled movement was performed.
+	 * @param InstanceID	ID of the instance of controlled movement.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	virtual void FinishControlledMovementAbility(FString AbilityName, int InstanceID);
 
-protected:
+public:
+	/*
+	 * Direct overrides of the movement properties, kept in a single movement modifier.
+	 * Each setter makes the modifier the most recent of its priority, and each reset removes its override.
+	 */
+
 	/** Called to limit character movement to a certain speed. */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void SetMovementSpeed(float Speed);
@@ -103,9 +332,13 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void ResetTurningRate();
 
-	/** Sets the direction for the entity to move in. */
+	/** Called to set gravity to a value. */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
-	void SetMovementDirection(FVector Direction);
+	void SetGravity(float GravityValue);
+
+	/** Called to reset gravity. */
+	UFUNCTION(BlueprintCallable, Category = "Movement")
+	void ResetGravity();
 
 	/** Sets movement mode to flying. */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
@@ -115,26 +348,115 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void ResetFlyable();
 
-	/** Called to set gravity to a value. */
+protected:
+	/** Sets the direction for the entity to move in. */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
-	void SetGravity(float GravityValue);
+	void SetMovementDirection(FVector Direction);
 
-	/** Called to reset gravity. */
-	UFUNCTION(BlueprintCallable, Category = "Movement")
-	void ResetGravity();
+	/** Computes the basis controlled movement is applied in from the movement direction. */
+	void UpdateMovementBasis();
+
+	/** Applies the movement curve of the active ability for the current montage time. */
+	void ApplyMovementCurve();
 
-protected:
 	/*
-	 * Variable to keep track of the instance of controlled movement.
-	 * Necessary to ensure that there isn't a race to reset movement parameters when two instances of controlled
-	 * movement coincide.
+	 * Pushes the movement modifier of an instance of controlled movement and sets its movement direction.
+	 * @see SetupControlledMovement
+	 * @param Source		Name of what started the controlled movement, e.g. an ability name.
+	 * @param ProfileID		Movement profile of the controlled movement. 0 if it doesn't come from an ability.
+	 * @returns int32		Instance ID of the controlled movement. 0 if the modifier stack is full.
 	 */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
-	int ControlledMovementInstanceID;
+	int32 BeginControlledMovement(float TargetSpeed, float TargetAcceleration, float TargetTurnRate, float MaxTurnAngleDegrees,
+								  bool HasZMovement, int32 Priority, const FName Source, const uint8 ProfileID = 0);
+
+	/** Pushes, updates or removes the direct override modifier after one of its overrides changed. */
+	void UpdateDirectModifier();
 
+	/** Recomputes the movement properties from the defaults and the modifier stack. */
+	void ApplyMovementModifiers();
+
+protected:
 	/*
-	 * Map of ability names to their movement instance IDs.
+	 * Movement modifier on the stack.
 	 */
-	TMap<FString, TArray<int>> AbilityNameIDsMap;
+	struct FMovementModifierSlot
+	{
+		/** Handle of the modifier. */
+		int32 Handle;
+
+		/** Order in which the modifier was pushed or last updated. Breaks priority ties. */
+		uint32 Sequence;
+
+		/** Name of what pushed the modifier. */
+		FName Source;
+
+		/** Overrides of the modifier. */
+		FMovementModifier Modifier;
+	};
+
+	/** Active movement modifiers. */
+	TArray<FMovementModifierSlot, TInlineAllocator<MaxMovementModifiers>> MovementModifiers;
+
+	/** Handle given to the next movement modifier. */
+	int32 NextModifierHandle;
+
+	/** Sequence given to the next pushed or updated movement modifier. */
+	uint32 NextModifierSequence;
+
+	/** Overrides set through the direct setters. */
+	FMovementModifier DirectModifier;
+
+	/** Handle of the direct override modifier. 0 if it has no overrides. */
+	int32 DirectModifierHandle;
+
+	/** Whether the modifier stack put the character in flying mode. */
+	bool bModifierFlying;
+
+	/** Gravity scale used when no modifier overrides it. */
+	float DefaultGravity;
+
+	/** Movement profile of the active controlled movement. */
+	uint8 MovementProfileID;
+
+	/** Whether the ability modifiers are replaced by the network profile. */
+	bool bUseNetworkProfile;
+
+	/** Movement profile replacing the ability modifiers. */
+	uint8 NetworkProfileID;
+
+	/** Overrides of the network profile. */
+	FMovementModifier NetworkProfile;
+
+	/** Move data sent to and received from the network. */
+	FGameCharacterNetworkMoveDataContainer NetworkMoveDataContainer;
+
+	/** State timeline of the owner. */
+	UPROPERTY(Transient)
+	class UStateTimelineComponent* StateTimeline;
+
+	/** Whether lightweight movement is enabled. */
+	bool bWantsLightweightMovement;
+
+	/** Time since the last collision sweep during lightweight movement. */
+	float TimeSinceLightweightSweep;
+
+	/** Movement direction the movement basis was computed from. */
+	FVector BasisDirection;
+
+	/** Forward, right and up axes of the movement direction. */
+	FVector BasisForward;
+	FVector BasisRight;
+	FVector BasisUp;
+
+	/** Curve driving the controlled movement of the active ability. Null if the movement is driven externally. */
+	UPROPERTY()
+	class UCurveVector* MovementCurve;
+
+	/** Montage whose time the movement curve is evaluated at. */
+	UPROPERTY()
+	class UAnimMontage* MovementCurveMontage;
+
+	/** Instance of controlled movement driven by the movement curve. */
+	int MovementCurveInstanceID;
 
 };
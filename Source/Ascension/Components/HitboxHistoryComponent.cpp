@@ -0,0 +1,320 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "HitboxHistoryComponent.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitbox History Record"), STAT_HitboxHistoryRecord, STATGROUP_Ascension);
+DECLARE_CYCLE_STAT(TEXT("Hitbox History Sweep"), STAT_HitboxHistorySweep, STATGROUP_Ascension);
+
+/** Number of rewound sweeps and time spent on them, for the report. */
+static int64 GNumRewoundSweeps = 0;
+static double GRewoundSweepSeconds = 0.0;
+
+
+/*
+ * Tests a swept sphere against a capsule.
+ * @param Start				Start of the sweep.
+ * @param End				End of the sweep.
+ * @param Radius			Radius of the swept sphere.
+ * @param CapsuleStart		Center of the start of the capsule.
+ * @param CapsuleEnd		Center of the end of the capsule.
+ * @param CapsuleRadius		Radius of the capsule.
+ * @param OutHitPoint		Point on the capsule closest to the sweep.
+ * @returns bool			Whether the sweep hit.
+ */
+static bool SweepSphereAgainstCapsule(const FVector& Start, const FVector& End, const float Radius, const FVector& CapsuleStart, const FVector& CapsuleEnd,
+									  const float CapsuleRadius, FVector& OutHitPoint)
+{
+	FVector SweepPoint;
+	FVector CapsulePoint;
+	FMath::SegmentDistToSegmentSafe(Start, End, CapsuleStart, CapsuleEnd, SweepPoint, CapsulePoint);
+
+	const float CombinedRadius = Radius + CapsuleRadius;
+
+	if (FVector::DistSquared(SweepPoint, CapsulePoint) > CombinedRadius * CombinedRadius)
+	{
+		return false;
+	}
+
+	OutHitPoint = CapsulePoint + (SweepPoint - CapsulePoint).GetSafeNormal() * CapsuleRadius;
+	return true;
+}
+
+
+// Sets default values for this component's properties.
+UHitboxHistoryComponent::UHitboxHistoryComponent()
+{
+	// Record once the owner has finished moving for the frame.
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	HistoryFrames = 32;
+	HitboxTag = FName("Hitbox");
+	Capsule = nullptr;
+	NextFrame = 0;
+	NumRecorded = 0;
+}
+
+// Called when the game starts.
+void UHitboxHistoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only servers check hits from remote clients.
+	const ENetMode NetMode = GetNetMode();
+
+	if (NetMode != NM_DedicatedServer && NetMode != NM_ListenServer)
+	{
+		return;
+	}
+
+	AActor* Owner = GetOwner();
+	Capsule = Cast<UCapsuleComponent>(Owner->GetRootComponent());
+
+	TArray<UShapeComponent*> ShapeComponents;
+	Owner->GetComponents<UShapeComponent>(ShapeComponents);
+
+	for (UShapeComponent* ShapeComponent : ShapeComponents)
+	{
+		if (!ShapeComponent->ComponentHasTag(HitboxTag))
+		{
+			continue;
+		}
+
+		FRecordedHitbox HitboxShape;
+
+		if (const UBoxComponent* Box = Cast<UBoxComponent>(ShapeComponent))
+		{
+			HitboxShape.Shape = FRecordedHitbox::EShape::Box;
+			HitboxShape.Extent = Box->GetUnscaledBoxExtent();
+		}
+		else if (const UCapsuleComponent* HitboxCapsule = Cast<UCapsuleComponent>(ShapeComponent))
+		{
+			HitboxShape.Shape = FRecordedHitbox::EShape::Capsule;
+			HitboxShape.Extent = FVector(HitboxCapsule->GetUnscaledCapsuleRadius(), 0.0f, HitboxCapsule->GetUnscaledCapsuleHalfHeight_WithoutHemisphere());
+		}
+		else if (const USphereComponent* Sphere = Cast<USphereComponent>(ShapeComponent))
+		{
+			HitboxShape.Shape = FRecordedHitbox::EShape::Sphere;
+			HitboxShape.Extent = FVector(Sphere->GetUnscaledSphereRadius());
+		}
+		else
+		{
+			continue;
+		}
+
+		Hitboxes.Add(ShapeComponent);
+		HitboxShapes.Add(HitboxShape);
+	}
+
+	if (Capsule == nullptr && Hitboxes.Num() == 0)
+	{
+		return;
+	}
+
+	// The whole history is allocated up front and reused.
+	HistoryFrames = FMath::Max(HistoryFrames, 2);
+	FrameTimes.SetNumZeroed(HistoryFrames);
+	CapsuleLocations.SetNumZeroed(HistoryFrames);
+	HitboxTransforms.SetNum(HistoryFrames * Hitboxes.Num());
+
+	SetComponentTickEnabled(true);
+}
+
+// Called every frame.
+void UHitboxHistoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	RecordFrame();
+}
+
+void UHitboxHistoryComponent::RecordFrame()
+{
+	SCOPE_CYCLE_COUNTER(STAT_HitboxHistoryRecord);
+
+	FrameTimes[NextFrame] = GetWorld()->GetTimeSeconds();
+	CapsuleLocations[NextFrame] = Capsule ? Capsule->GetComponentLocation() : GetOwner()->GetActorLocation();
+
+	for (int32 Index = 0; Index < Hitboxes.Num(); Index++)
+	{
+		const UShapeComponent* Hitbox = Hitboxes[Index];
+		HitboxTransforms[NextFrame * Hitboxes.Num() + Index] = Hitbox ? Hitbox->GetComponentTransform() : FTransform::Identity;
+	}
+
+	NextFrame = (NextFrame + 1) % HistoryFrames;
+	NumRecorded = FMath::Min(NumRecorded + 1, HistoryFrames);
+}
+
+void UHitboxHistoryComponent::FindFrames(const float Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const
+{
+	const int32 Newest = (NextFrame - 1 + HistoryFrames) % HistoryFrames;
+	OutOlder = Newest;
+	OutNewer = Newest;
+	OutAlpha = 0.0f;
+
+	if (Time >= FrameTimes[Newest])
+	{
+		return;
+	}
+
+	for (int32 Age = 1; Age < NumRecorded; Age++)
+	{
+		const int32 Frame = (Newest - Age + HistoryFrames) % HistoryFrames;
+		OutNewer = OutOlder;
+		OutOlder = Frame;
+
+		if (FrameTimes[Frame] <= Time)
+		{
+			const float FrameSpan = FrameTimes[OutNewer] - FrameTimes[Frame];
+			OutAlpha = FrameSpan > SMALL_NUMBER ? (Time - FrameTimes[Frame]) / FrameSpan : 0.0f;
+			return;
+		}
+	}
+
+	// Older than the history, use the oldest frame.
+	OutNewer = OutOlder;
+	OutAlpha = 0.0f;
+}
+
+bool UHitboxHistoryComponent::SweepAtTime(const float Time, const FVector& Start, const FVector& End, const float Radius, FVector& OutHitPoint) const
+{
+	if (!HasHistory())
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_HitboxHistorySweep);
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	int32 Older = 0;
+	int32 Newer = 0;
+	float Alpha = 0.0f;
+	FindFrames(Time, Older, Newer, Alpha);
+
+	bool bHit = false;
+
+	if (Hitboxes.Num() == 0)
+	{
+		const FVector Center = FMath::Lerp(CapsuleLocations[Older], CapsuleLocations[Newer], Alpha);
+		const FVector HalfSegment = FVector(0.0f, 0.0f, Capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere());
+
+		bHit = SweepSphereAgainstCapsule(Start, End, Radius, Center - HalfSegment, Center + HalfSegment, Capsule->GetScaledCapsuleRadius(), OutHitPoint);
+	}
+
+	for (int32 Index = 0; Index < Hitboxes.Num() && !bHit; Index++)
+	{
+		const FRecordedHitbox& HitboxShape = HitboxShapes[Index];
+
+		FTransform Transform;
+		Transform.Blend(HitboxTransforms[Older * Hitboxes.Num() + Index], HitboxTransforms[Newer * Hitboxes.Num() + Index], Alpha);
+
+		switch (HitboxShape.Shape)
+		{
+		case FRecordedHitbox::EShape::Sphere:
+		{
+			const FVector Center = Transform.GetLocation();
+			const FVector SweepPoint = FMath::ClosestPointOnSegment(Center, Start, End);
+			const float SphereRadius = HitboxShape.Extent.X * Transform.GetMaximumAxisScale();
+
+			if (FVector::Dist(SweepPoint, Center) <= Radius + SphereRadius)
+			{
+				OutHitPoint = Center + (SweepPoint - Center).GetSafeNormal() * SphereRadius;
+				bHit = true;
+			}
+			break;
+		}
+
+		case FRecordedHitbox::EShape::Capsule:
+		{
+			const FVector Scale = Transform.GetScale3D().GetAbs();
+			const FVector HalfSegment = Transform.GetUnitAxis(EAxis::Z) * HitboxShape.Extent.Z * Scale.Z;
+			const FVector Center = Transform.GetLocation();
+
+			bHit = SweepSphereAgainstCapsule(Start, End, Radius, Center - HalfSegment, Center + HalfSegment, HitboxShape.Extent.X * FMath::Max(Scale.X, Scale.Y), OutHitPoint);
+			break;
+		}
+
+		case FRecordedHitbox::EShape::Box:
+		{
+			// Test the sweep in the box's space against the box grown by the sweep radius.
+			const FVector LocalStart = Transform.InverseTransformPosition(Start);
+			const FVector LocalEnd = Transform.InverseTransformPosition(End);
+			const float LocalRadius = Radius / FMath::Max(Transform.GetMinimumAxisScale(), KINDA_SMALL_NUMBER);
+			const FBox Box(-HitboxShape.Extent - FVector(LocalRadius), HitboxShape.Extent + FVector(LocalRadius));
+
+			if (Box.IsInside(LocalStart) || FMath::LineBoxIntersection(Box, LocalStart, LocalEnd, LocalEnd - LocalStart))
+			{
+				const FBox HitboxBox(-HitboxShape.Extent, HitboxShape.Extent);
+				OutHitPoint = Transform.TransformPosition(HitboxBox.GetClosestPointTo((LocalStart + LocalEnd) * 0.5f));
+				bHit = true;
+			}
+			break;
+		}
+		}
+	}
+
+	GNumRewoundSweeps++;
+	GRewoundSweepSeconds += FPlatformTime::Seconds() - StartSeconds;
+
+	return bHit;
+}
+
+SIZE_T UHitboxHistoryComponent::GetHistoryMemory() const
+{
+	return FrameTimes.GetAllocatedSize() + CapsuleLocations.GetAllocatedSize() + HitboxTransforms.GetAllocatedSize() +
+		Hitboxes.GetAllocatedSize() + HitboxShapes.GetAllocatedSize();
+}
+
+/*
+ * Console command reporting the hitbox history memory of every actor and the cost of rewound sweeps so far.
+ */
+static FAutoConsoleCommandWithWorldAndArgs LagCompensationReportCommand(
+	TEXT("Ascension.LagCompensation.Report"),
+	TEXT("Reports the hitbox history memory per actor and the cost of lag compensated melee sweeps. Add Reset=1 to reset the sweep counters."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		int32 NumHistories = 0;
+		SIZE_T TotalMemory = 0;
+
+		for (TObjectIterator<UHitboxHistoryComponent> It; It; ++It)
+		{
+			if (It->GetWorld() != World || !It->HasHistory())
+			{
+				continue;
+			}
+
+			const SIZE_T Memory = It->GetHistoryMemory();
+			UE_LOG(LogBenchmark, Log, TEXT("Lag compensation: %s | %d frames | %d bytes"), *GetNameSafe(It->GetOwner()), It->HistoryFrames, int32(Memory))
+
+			NumHistories++;
+			TotalMemory += Memory;
+		}
+
+		UE_LOG(LogBenchmark, Log, TEXT("Lag compensation: %d actors | %d bytes total | %d bytes per actor | %lld rewound sweeps | %.3f us per sweep"),
+			   NumHistories, int32(TotalMemory), NumHistories > 0 ? int32(TotalMemory / NumHistories) : 0, GNumRewoundSweeps,
+			   GNumRewoundSweeps > 0 ? GRewoundSweepSeconds * 1000000.0 / GNumRewoundSweeps : 0.0)
+
+		bool bReset = false;
+		for (const FString& Arg : Args)
+		{
+			FParse::Bool(*Arg, TEXT("Reset="), bReset);
+		}
+
+		if (bReset)
+		{
+			GNumRewoundSweeps = 0;
+			GRewoundSweepSeconds = 0.0;
+		}
+	})
+);
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HitboxHistoryComponent.generated.h"
+
+
+/*
+ * Shape of a hitbox recorded by the hitbox history.
+ */
+struct FRecordedHitbox
+{
+	/** Type of the shape. */
+	enum class EShape : uint8
+	{
+		Box,
+		Capsule,
+		Sphere
+	};
+
+	/** Type of the shape. */
+	EShape Shape;
+
+	/** Box extent, or capsule radius and half height in X and Z, or sphere radius in X. Unscaled. */
+	FVector Extent;
+};
+
+/*
+ * Component keeping a short history of where its owner's collision was on the server, so melee hits from remote
+ * clients can be checked against where the client saw the target rather than where it is now.
+ *
+ * Each server frame, the owner's capsule location and the transforms of its hitboxes are written to a fixed size ring
+ * buffer. Melee queries rewind targets by interpolating between the recorded frames and test the swept weapon against
+ * the rewound shapes analytically, without touching the physics scene.
+ *
+ * Only records on servers. To try it locally, play in editor with multiple clients and emulate lag, e.g. with
+ * "Net PktLag=150", then run Ascension.LagCompensation.Report to see the history memory per actor and query cost.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class ASCENSION_API UHitboxHistoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties.
+	UHitboxHistoryComponent();
+
+protected:
+	// Called when the game starts.
+	virtual void BeginPlay() override;
+
+public:
+	// Called every frame.
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+public:
+	/** Number of frames recorded. Frames older than this are overwritten. */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation", meta = (ClampMin = 2, UIMin = 2))
+	int32 HistoryFrames;
+
+	/** Tag of the owner's shape components that are recorded as hitboxes. */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation")
+	FName HitboxTag;
+
+public:
+	/*
+	 * Whether the history has recorded any frames.
+	 */
+	FORCEINLINE bool HasHistory() const { return NumRecorded > 0; }
+
+	/*
+	 * Tests a swept sphere against the owner's collision as it was at a time in the past.
+	 * Tests the recorded hitboxes, or the capsule if the owner has no hitboxes.
+	 * @param Time			Server time to rewind to. Clamped to the recorded frames.
+	 * @param Start			Start of the sweep.
+	 * @param End			End of the sweep.
+	 * @param Radius		Radius of the swept sphere.
+	 * @param OutHitPoint	Closest point of the sweep to the hit shape.
+	 * @returns bool		Whether the sweep hit.
+	 */
+	bool SweepAtTime(const float Time, const FVector& Start, const FVector& End, const float Radius, FVector& OutHitPoint) const;
+
+	/*
+	 * Returns the memory used by the history, in bytes.
+	 */
+	SIZE_T GetHistoryMemory() const;
+
+protected:
+	/*
+	 * Finds the two recorded frames around a time.
+	 * @param Time			Server time.
+	 * @param OutOlder		Ring index of the older frame.
+	 * @param OutNewer		Ring index of the newer frame.
+	 * @param OutAlpha		Interpolation from the older to the newer frame.
+	 */
+	void FindFrames(const float Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const;
+
+	/** Records the current frame. */
+	void RecordFrame();
+
+protected:
+	/** Capsule of the owner. */
+	UPROPERTY()
+	class UCapsuleComponent* Capsule;
+
+	/** Hitboxes of the owner. */
+	UPROPERTY()
+	TArray<class UShapeComponent*> Hitboxes;
+
+	/** Shapes of the hitboxes. */
+	TArray<FRecordedHitbox> HitboxShapes;
+
+	/** Server time of each recorded frame. */
+	TArray<float> FrameTimes;
+
+	/** Capsule location of each recorded frame. */
+	TArray<FVector> CapsuleLocations;
+
+	/** Hitbox transforms of each recorded frame, ordered by frame then hitbox. */
+	TArray<FTransform> HitboxTransforms;
+
+	/** Ring index the next frame is written to. */
+	int32 NextFrame;
+
+	/** Number of frames recorded, up to the history size. */
+	int32 NumRecorded;
+};
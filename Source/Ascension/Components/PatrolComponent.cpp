@@ -2,6 +2,7 @@
 
 #include "Ascension.h"
 #include "PatrolComponent.h"
+#include "AI/PatrolRoute.h"
 
 
 // Sets default values for this component's properties
@@ -10,9 +11,11 @@ UPatrolComponent::UPatrolComponent()
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = false;
+
+	Route = nullptr;
 }
 
-TArray<AActor*> UPatrolComponent::GetPatrolPoints() const
+const TArray<AActor*>& UPatrolComponent::GetPatrolPoints() const
 {
-	return PatrolPoints;
-}
\ No newline at end of file
+	return Route ? Route->GetPoints() : PatrolPoints;
+}
@@ -15,11 +15,18 @@ public:
 	// Sets default values for this component's properties
 	UPatrolComponent();
 
-	/** Gets the patrol points. */
+	/** Gets the patrol points: the points of the route if there is one, otherwise the component's own. */
 	UFUNCTION(BlueprintCallable, Category = "Helper")
-	TArray<AActor*> GetPatrolPoints() const;
+	const TArray<AActor*>& GetPatrolPoints() const;
+
+	/** Gets the route patrolled. Null if the component's own points are patrolled. */
+	FORCEINLINE class APatrolRoute* GetRoute() const { return Route; }
 
 protected:
 	UPROPERTY(EditInstanceOnly, Category = "Patrol Points")
 	TArray<AActor*> PatrolPoints;
+
+	/** Route patrolled, shared with the other enemies on it. Used instead of the patrol points when set. */
+	UPROPERTY(EditInstanceOnly, Category = "Patrol Points")
+	class APatrolRoute* Route;
 };
@@ -12,6 +12,7 @@ UPlayerAttackComponent::UPlayerAttackComponent()
 {
 	ComboMeter = 0;
 	MaxComboCount = 3;
+	SelectedComboNode = INDEX_NONE;
 }
 
 void UPlayerAttackComponent::BeginPlay()
@@ -21,6 +22,11 @@ void UPlayerAttackComponent::BeginPlay()
 
 FString UPlayerAttackComponent::SelectAttack_Implementation(const FString& AttackType)
 {
+	if (ComboGraph)
+	{
+		return SelectComboAttack(FName(*AttackType), SelectedComboNode);
+	}
+
 	FString AttackName = FString();
 	if (AttackType.Equals(FString("Light Attack")))
 	{
@@ -90,24 +96,23 @@ bool UPlayerAttackComponent::Attack_Implementation(const FString& AttackName)
 	// This is done to choose the correct attack in a combo.
 	FString PlayerAttackName = SelectAttack(AttackName);
 
-	UGameAbilitySystemComponent* AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
-	if (AbilitySystem->CanActivateAbility(PlayerAttackName))
+	if (!PlayerAttackName.IsEmpty() && AbilitySystem->CanActivateAbility(PlayerAttackName))
 	{
 		uint8 AttackID = 0;
 		bool Activated = AbilitySystem->ActivateAbility(PlayerAttackName, AttackID);
 
 		if (Activated)
 		{
-			ActiveAttackIDs.Add(AttackID);
+			ActiveAttacks.Add(FName(*PlayerAttackName), AttackID);
 
-			if (!ActiveAttackNameIDsMap.Contains(PlayerAttackName))
+			if (ComboGraph)
 			{
-				TArray<uint8> AttackIDs = TArray<uint8>();
-				ActiveAttackNameIDsMap.Add(PlayerAttackName, AttackIDs);
+				AdvanceCombo(SelectedComboNode);
+			}
+			else
+			{
+				ComboMeter = (++ComboMeter) % MaxComboCount;
 			}
-			ActiveAttackNameIDsMap[PlayerAttackName].Add(AttackID);
-
-			ComboMeter = (++ComboMeter) % MaxComboCount;
 			return true;
 		}
 	}
@@ -117,60 +122,16 @@ bool UPlayerAttackComponent::Attack_Implementation(const FString& AttackName)
 
 void UPlayerAttackComponent::FinishAttack_Implementation(const FString& AttackName, const uint8 AttackID)
 {
-	UGameAbilitySystemComponent* AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
+	const FName AttackDefinition = FName(*AttackName);
+	const int32 FinishedID = ActiveAttacks.Resolve(AttackDefinition, AttackID);
 
-	if (!AttackName.Equals(FString("")))
+	if (FinishedID != INDEX_NONE && AbilitySystem)
 	{
-		if (ActiveAttackNameIDsMap.Contains(AttackName))
-		{
-			TArray<uint8> IDs = ActiveAttackNameIDsMap[AttackName];
-
-			if (IDs.Num() > 0)
-			{
-				if (IDs.Contains(AttackID) && ActiveAttackIDs.Contains(AttackID))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(AttackName, AttackID);
-						ActiveAttackIDs.Remove(AttackID);
-						ActiveAttackNameIDsMap[AttackName].Remove(AttackID);
-					}
-				}
-				else if (ActiveAttackIDs.Contains(IDs[0]))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(AttackName, IDs[0]);
-						ActiveAttackIDs.Remove(IDs[0]);
-						ActiveAttackNameIDsMap[AttackName].Remove(IDs[0]);
-					}
-				}
-			}
-
-			UPlayerStateComponent* StateComponent = Owner->FindComponentByClass<UPlayerStateComponent>();
-			if (StateComponent)
-			{
-				StateComponent->SetCharacterState(ECharacterState::CS_Idle);
-			}
-		}
+		EndActiveAttack(AttackName, FinishedID);
 	}
 
-	else if (ActiveAttackIDs.Contains(AttackID))
+	if (FinishedID != INDEX_NONE || ActiveAttacks.IsKnownDefinition(AttackDefinition))
 	{
-		if (AbilitySystem)
-		{
-			AbilitySystem->FinishAbility(AttackName, AttackID);
-			ActiveAttackIDs.Remove(AttackID);
-
-			if (ActiveAttackNameIDsMap.Contains(AttackName))
-			{
-				if (ActiveAttackNameIDsMap[AttackName].Contains(AttackID))
-				{
-					ActiveAttackNameIDsMap[AttackName].Remove(AttackID);
-				}
-			}
-		}
-
 		UPlayerStateComponent* StateComponent = Owner->FindComponentByClass<UPlayerStateComponent>();
 		if (StateComponent)
 		{
@@ -182,4 +143,5 @@ void UPlayerAttackComponent::FinishAttack_Implementation(const FString& AttackNa
 void UPlayerAttackComponent::ResetCombo_Implementation()
 {
 	ComboMeter = 0;
+	ResetComboGraph();
 }
@@ -29,9 +29,13 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Combos")
 	int MaxComboCount;
 
+	/** Node of the combo graph of the attack selected by the last SelectAttack call. */
+	int32 SelectedComboNode;
+
 public:
 	/*
 	 * Implementation for selecting attacks.
+	 * Uses the combo graph if one is set, with the attack type as the input.
 	 * @param AttackType	Type of attack to perform.
 	 * @returns FString		Name of attack ability to perform.
 	 */
@@ -32,59 +32,17 @@ bool UPlayerDodgeComponent::Dodge_Implementation(const FString& DodgeName = FStr
 void UPlayerDodgeComponent::FinishDodge_Implementation(const FString& DodgeName = FString("Dodge"), const uint8 DodgeID = 0)
 {
 	UGameAbilitySystemComponent* AbilitySystem = Owner->FindComponentByClass<UGameAbilitySystemComponent>();
+	const FName DodgeDefinition = FName(*DodgeName);
+	const int32 FinishedID = ActiveDodges.Resolve(DodgeDefinition, DodgeID);
 
-	if (!DodgeName.Equals(FString("")))
+	if (FinishedID != INDEX_NONE && AbilitySystem)
 	{
-		if (ActiveDodgeNameIDsMap.Contains(DodgeName))
-		{
-			TArray<uint8> IDs = ActiveDodgeNameIDsMap[DodgeName];
-
-			if (IDs.Num() > 0)
-			{
-				if (IDs.Contains(DodgeID) && ActiveDodgeIDs.Contains(DodgeID))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(DodgeName, DodgeID);
-						ActiveDodgeIDs.Remove(DodgeID);
-						ActiveDodgeNameIDsMap[DodgeName].Remove(DodgeID);
-					}
-				}
-				else if (ActiveDodgeIDs.Contains(IDs[0]))
-				{
-					if (AbilitySystem)
-					{
-						AbilitySystem->FinishAbility(DodgeName, IDs[0]);
-						ActiveDodgeIDs.Remove(IDs[0]);
-						ActiveDodgeNameIDsMap[DodgeName].Remove(IDs[0]);
-					}
-				}
-			}
-
-			UPlayerStateComponent* StateComponent = Owner->FindComponentByClass<UPlayerStateComponent>();
-			if (StateComponent)
-			{
-				StateComponent->SetCharacterState(ECharacterState::CS_Idle);
-			}
-		}
+		AbilitySystem->FinishAbility(DodgeName, FinishedID);
+		ActiveDodges.Remove(FinishedID);
 	}
 
-	else if (ActiveDodgeIDs.Contains(DodgeID))
+	if (FinishedID != INDEX_NONE || ActiveDodges.IsKnownDefinition(DodgeDefinition))
 	{
-		if (AbilitySystem)
-		{
-			AbilitySystem->FinishAbility(DodgeName, DodgeID);
-			ActiveDodgeIDs.Remove(DodgeID);
-
-			if (ActiveDodgeNameIDsMap.Contains(DodgeName))
-			{
-				if (ActiveDodgeNameIDsMap[DodgeName].Contains(DodgeID))
-				{
-					ActiveDodgeNameIDsMap[DodgeName].Remove(DodgeID);
-				}
-			}
-		}
-
 		UPlayerStateComponent* StateComponent = Owner->FindComponentByClass<UPlayerStateComponent>();
 		if (StateComponent)
 		{
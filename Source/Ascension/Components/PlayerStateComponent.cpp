@@ -4,6 +4,92 @@
 #include "Entities/Characters/Player/AscensionCharacter.h"
 #include "PlayerStateComponent.h"
 
+/** Number of packed states: three bits of character state, one of movement state and one of weapon state. */
+static constexpr int32 NumPackedStates = 1 << 5;
+
+/** Returns the bit of a character state in the transition table. */
+static constexpr uint8 StateBit(const ECharacterState State)
+{
+	return uint8(1 << (uint8) State);
+}
+
+/** Character states each character state can change to. */
+static const uint8 CharacterStateTransitions[] =
+{
+	// Idle
+	StateBit(ECharacterState::CS_Switching) | StateBit(ECharacterState::CS_Dodging) | StateBit(ECharacterState::CS_Attacking) |
+	StateBit(ECharacterState::CS_Stunned) | StateBit(ECharacterState::CS_Dead),
+	// Switching
+	StateBit(ECharacterState::CS_Idle) | StateBit(ECharacterState::CS_Stunned) | StateBit(ECharacterState::CS_Dead),
+	// Dodging, chaining into attacks and dodges.
+	StateBit(ECharacterState::CS_Idle) | StateBit(ECharacterState::CS_Dodging) | StateBit(ECharacterState::CS_Attacking) |
+	StateBit(ECharacterState::CS_Stunned) | StateBit(ECharacterState::CS_Dead),
+	// Attacking, chaining into attacks and dodges.
+	StateBit(ECharacterState::CS_Idle) | StateBit(ECharacterState::CS_Dodging) | StateBit(ECharacterState::CS_Attacking) |
+	StateBit(ECharacterState::CS_Stunned) | StateBit(ECharacterState::CS_Dead),
+	// Stunned
+	StateBit(ECharacterState::CS_Idle) | StateBit(ECharacterState::CS_Stunned) | StateBit(ECharacterState::CS_Dead),
+	// Dead
+	0
+};
+
+/*
+ * Capabilities of every packed state, computed once.
+ */
+struct FPlayerCapabilityTable
+{
+	FPlayerCapabilityTable()
+	{
+		for (int32 State = 0; State < NumPackedStates; State++)
+		{
+			Capabilities[State] = ComputeCapabilities(UPlayerStateComponent::UnpackCharacterState(State), UPlayerStateComponent::UnpackMovementState(State),
+													  UPlayerStateComponent::UnpackWeaponState(State));
+		}
+	}
+
+	static EPlayerCapability ComputeCapabilities(const ECharacterState CharacterState, const EMovementState MovementState, const EWeaponState WeaponState)
+	{
+		const bool bIdle = CharacterState == ECharacterState::CS_Idle;
+		const bool bInAction = CharacterState == ECharacterState::CS_Attacking || CharacterState == ECharacterState::CS_Dodging;
+		const bool bOnGround = MovementState == EMovementState::MS_OnGround;
+		const bool bArmed = WeaponState == EWeaponState::WS_Unsheathed;
+
+		EPlayerCapability Capabilities = EPlayerCapability::None;
+
+		if (bIdle)
+		{
+			Capabilities |= EPlayerCapability::Move | EPlayerCapability::Jump;
+		}
+
+		if (bIdle && bOnGround)
+		{
+			Capabilities |= EPlayerCapability::Sprint | EPlayerCapability::SwitchWeapon | EPlayerCapability::Dodge;
+		}
+
+		if (bInAction && bOnGround)
+		{
+			Capabilities |= EPlayerCapability::ChainDodge;
+		}
+
+		if (bIdle && bOnGround && bArmed)
+		{
+			Capabilities |= EPlayerCapability::Attack;
+		}
+
+		if (bInAction && bOnGround && bArmed)
+		{
+			Capabilities |= EPlayerCapability::ChainAttack;
+		}
+
+		return Capabilities;
+	}
+
+	/** Capabilities of each packed state. */
+	EPlayerCapability Capabilities[NumPackedStates];
+};
+
+static const FPlayerCapabilityTable CapabilityTable;
+
 
 // Sets default values for this component's properties
 UPlayerStateComponent::UPlayerStateComponent()
@@ -12,6 +98,8 @@ UPlayerStateComponent::UPlayerStateComponent()
 	CharacterState = ECharacterState::CS_Idle;
 	MovementState = EMovementState::MS_OnGround;
 	WeaponState = EWeaponState::WS_Sheathed;
+	PackedState = PackState(CharacterState, MovementState, WeaponState);
+	Capabilities = GetStateCapabilities(PackedState);
 }
 
 // Called when the game starts
@@ -37,17 +125,58 @@ EWeaponState UPlayerStateComponent::GetWeaponState() const
 	return WeaponState;
 }
 
-void UPlayerStateComponent::SetCharacterState(ECharacterState State)
+bool UPlayerStateComponent::SetCharacterState(ECharacterState State)
 {
+	if (State == CharacterState)
+	{
+		return true;
+	}
+
+	if (!CanEnterCharacterState(State))
+	{
+		return false;
+	}
+
 	CharacterState = State;
+	CommitState();
+	return true;
+}
+
+bool UPlayerStateComponent::CanEnterCharacterState(ECharacterState State) const
+{
+	return (CharacterStateTransitions[(uint8) CharacterState] & StateBit(State)) != 0;
 }
 
 void UPlayerStateComponent::SetMovementState(EMovementState State)
 {
 	MovementState = State;
+	CommitState();
 }
 
 void UPlayerStateComponent::SetWeaponState(EWeaponState State)
 {
 	WeaponState = State;
+	CommitState();
+}
+
+uint8 UPlayerStateComponent::PackState(const ECharacterState InCharacterState, const EMovementState InMovementState, const EWeaponState InWeaponState)
+{
+	return (uint8) InCharacterState | ((uint8) InMovementState << 3) | ((uint8) InWeaponState << 4);
+}
+
+EPlayerCapability UPlayerStateComponent::GetStateCapabilities(const uint8 State)
+{
+	return CapabilityTable.Capabilities[State & (NumPackedStates - 1)];
+}
+
+void UPlayerStateComponent::CommitState()
+{
+	const uint8 PreviousState = PackedState;
+	PackedState = PackState(CharacterState, MovementState, WeaponState);
+
+	if (PackedState != PreviousState)
+	{
+		Capabilities = GetStateCapabilities(PackedState);
+		StateChangedEvent.Broadcast(PreviousState, PackedState);
+	}
 }
@@ -32,7 +32,37 @@ enum class EWeaponState : uint8
 	WS_Unsheathed		UMETA(DisplayName = "Unsheathed")
 };
 
-
+/*
+ * Actions the player can take, derived from the packed state. Each query is a single bit test.
+ */
+enum class EPlayerCapability : uint16
+{
+	None			= 0,
+	Move			= 1 << 0,
+	Jump			= 1 << 1,
+	Sprint			= 1 << 2,
+	SwitchWeapon	= 1 << 3,
+	Attack			= 1 << 4,
+	ChainAttack		= 1 << 5,
+	Dodge			= 1 << 6,
+	ChainDodge		= 1 << 7
+};
+ENUM_CLASS_FLAGS(EPlayerCapability);
+
+/*
+ * Notification that the player's state changed.
+ * @param PreviousState		Packed state before the change.
+ * @param NewState			Packed state after the change.
+ */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPlayerStateChanged, uint8 /* PreviousState */, uint8 /* NewState */);
+
+
+/*
+ * State machine of the player character.
+ * The character, movement and weapon states are packed into a single state word. Character state changes are
+ * guarded by a transition table, and the capabilities of each packed state are computed once, so checking whether
+ * the player can move, attack or dodge is a single bit test. Systems subscribe to OnStateChanged instead of polling.
+ */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class ASCENSION_API UPlayerStateComponent : public UActorComponent
 {
@@ -48,17 +78,26 @@ protected:
 
 protected:
 	/** General state that the character is in. */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Character State")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character State")
 	ECharacterState CharacterState;
 
 	/** State of character's movement. Indicates whether they are in ground/air. */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Character State")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character State")
 	EMovementState MovementState;
 
 	/** State that the character's weapon is in. Determines whether the weapon is sheathed/unsheathed. */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Character State")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character State")
 	EWeaponState WeaponState;
 
+	/** Character, movement and weapon states packed into a single word. */
+	uint8 PackedState;
+
+	/** Capabilities of the packed state. */
+	EPlayerCapability Capabilities;
+
+	/** Notification that the state changed. */
+	FOnPlayerStateChanged StateChangedEvent;
+
 public:
 	/*
 	 * Gets the character state.
@@ -82,11 +121,20 @@ public:
 	EWeaponState GetWeaponState() const;
 
 	/*
-	 * Sets the character state.
+	 * Sets the character state, if the transition table allows it from the current state.
+	 * Dead characters stay dead, and only the end of an action or a recovery returns the character to idle.
 	 * @param State		State of the character.
+	 * @returns bool	Whether the character is in the state afterwards.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "State Helper")
-	void SetCharacterState(ECharacterState State);
+	bool SetCharacterState(ECharacterState State);
+
+	/*
+	 * Whether the character state can change to another.
+	 * @param State		State to change to.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Character State")
+	bool CanEnterCharacterState(ECharacterState State) const;
 
 	/*
 	 * Sets the movement state.
@@ -102,6 +150,46 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "State Helper")
 	void SetWeaponState(EWeaponState State);
 
+	/*
+	 * Whether the player can take an action in the current state.
+	 * @param Capability	Action to check.
+	 */
+	FORCEINLINE bool HasCapability(const EPlayerCapability Capability) const { return EnumHasAnyFlags(Capabilities, Capability); }
+
+	/** Returns the character, movement and weapon states packed into a single word. */
+	FORCEINLINE uint8 GetPackedState() const { return PackedState; }
+
+	/** Returns the notification broadcast whenever the state changes. */
+	FORCEINLINE FOnPlayerStateChanged& OnStateChanged() { return StateChangedEvent; }
+
+	/*
+	 * Packs the character, movement and weapon states into a single word.
+	 * @returns uint8	Packed state.
+	 */
+	static uint8 PackState(const ECharacterState InCharacterState, const EMovementState InMovementState, const EWeaponState InWeaponState);
+
+	/** Returns the character state of a packed state. */
+	static FORCEINLINE ECharacterState UnpackCharacterState(const uint8 State) { return ECharacterState(State & 0x07); }
+
+	/** Returns the movement state of a packed state. */
+	static FORCEINLINE EMovementState UnpackMovementState(const uint8 State) { return EMovementState((State >> 3) & 0x01); }
+
+	/** Returns the weapon state of a packed state. */
+	static FORCEINLINE EWeaponState UnpackWeaponState(const uint8 State) { return EWeaponState((State >> 4) & 0x01); }
+
+	/*
+	 * Gets the capabilities of a packed state.
+	 * @param State						Packed state.
+	 * @returns EPlayerCapability		Actions the player can take in the state.
+	 */
+	static EPlayerCapability GetStateCapabilities(const uint8 State);
+
+protected:
+	/*
+	 * Packs the current states, updates the capabilities and notifies subscribers if anything changed.
+	 */
+	void CommitState();
+
 protected:
 	/** The component's owner. */
 	UPROPERTY(VisibleAnywhere, Category = "Owner")
@@ -0,0 +1,312 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "StateTimelineComponent.h"
+#include "Components/PlayerStateComponent.h"
+#include "Abilities/AbilitySystems/GameAbilitySystemComponent.h"
+#include "Globals.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_STATE_TIMELINE
+int32 UStateTimelineComponent::RecordEvents = 1;
+
+static FAutoConsoleVariableRef CVarTimelineEnable(
+	TEXT("Ascension.Timeline.Enable"),
+	UStateTimelineComponent::RecordEvents,
+	TEXT("Whether state timelines record events."),
+	ECVF_Default);
+
+/** Lanes of a timeline in a trace: one per state, one for abilities and one for movement modifiers. */
+static constexpr int32 NumTimelineLanes = 7;
+
+/** Names of the lanes of a timeline. */
+static const TCHAR* TimelineLaneNames[NumTimelineLanes] =
+{
+	TEXT("Character State"), TEXT("Movement State"), TEXT("Weapon State"), TEXT("Enemy State"), TEXT("AI State"), TEXT("Abilities"), TEXT("Movement Modifiers")
+};
+
+/** Returns the lane of a channel. */
+static int32 GetTimelineLane(const EStateTimelineChannel Channel)
+{
+	switch (Channel)
+	{
+	case EStateTimelineChannel::AbilityActivated:
+	case EStateTimelineChannel::AbilityFinished:
+		return 5;
+	case EStateTimelineChannel::ModifierPushed:
+	case EStateTimelineChannel::ModifierUpdated:
+	case EStateTimelineChannel::ModifierRemoved:
+		return 6;
+	default:
+		return (int32) Channel;
+	}
+}
+
+/** Whether a channel records states, shown as spans lasting until the next state. */
+static FORCEINLINE bool IsStateChannel(const EStateTimelineChannel Channel)
+{
+	return Channel <= EStateTimelineChannel::AIState;
+}
+
+/** Escapes a string to be written in a JSON string. */
+static FString EscapeJson(const FString& String)
+{
+	FString Escaped;
+	Escaped.Reserve(String.Len());
+
+	for (const TCHAR Char : String)
+	{
+		switch (Char)
+		{
+		case TEXT('"'):		Escaped += TEXT("\\\""); break;
+		case TEXT('\\'):	Escaped += TEXT("\\\\"); break;
+		case TEXT('\n'):	Escaped += TEXT("\\n"); break;
+		case TEXT('\r'):	Escaped += TEXT("\\r"); break;
+		case TEXT('\t'):	Escaped += TEXT("\\t"); break;
+		default:
+			if (Char < 0x20)
+			{
+				Escaped += FString::Printf(TEXT("\\u%04x"), (uint32) Char);
+			}
+			else
+			{
+				Escaped.AppendChar(Char);
+			}
+		}
+	}
+
+	return Escaped;
+}
+#endif
+
+
+// Sets default values for this component's properties
+UStateTimelineComponent::UStateTimelineComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	StateComponent = nullptr;
+#if WITH_STATE_TIMELINE
+	NumRecorded = 0;
+#endif
+}
+
+// Called when the game starts
+void UStateTimelineComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+#if WITH_STATE_TIMELINE
+	StateComponent = GetOwner()->FindComponentByClass<UPlayerStateComponent>();
+
+	if (StateComponent)
+	{
+		StateComponent->OnStateChanged().AddUObject(this, &UStateTimelineComponent::OnPlayerStateChanged);
+
+		// The timeline starts in the current states.
+		const uint8 State = StateComponent->GetPackedState();
+		Record(EStateTimelineChannel::CharacterState, (uint8) UPlayerStateComponent::UnpackCharacterState(State));
+		Record(EStateTimelineChannel::MovementState, (uint8) UPlayerStateComponent::UnpackMovementState(State));
+		Record(EStateTimelineChannel::WeaponState, (uint8) UPlayerStateComponent::UnpackWeaponState(State));
+	}
+#endif
+}
+
+// Called when the component stops playing
+void UStateTimelineComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (StateComponent)
+	{
+		StateComponent->OnStateChanged().RemoveAll(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UStateTimelineComponent::OnPlayerStateChanged(uint8 PreviousState, uint8 NewState)
+{
+	const ECharacterState CharacterState = UPlayerStateComponent::UnpackCharacterState(NewState);
+	const EMovementState MovementState = UPlayerStateComponent::UnpackMovementState(NewState);
+	const EWeaponState WeaponState = UPlayerStateComponent::UnpackWeaponState(NewState);
+
+	if (CharacterState != UPlayerStateComponent::UnpackCharacterState(PreviousState))
+	{
+		Record(EStateTimelineChannel::CharacterState, (uint8) CharacterState);
+	}
+
+	if (MovementState != UPlayerStateComponent::UnpackMovementState(PreviousState))
+	{
+		Record(EStateTimelineChannel::MovementState, (uint8) MovementState);
+	}
+
+	if (WeaponState != UPlayerStateComponent::UnpackWeaponState(PreviousState))
+	{
+		Record(EStateTimelineChannel::WeaponState, (uint8) WeaponState);
+	}
+}
+
+#if WITH_STATE_TIMELINE
+uint64 UStateTimelineComponent::GetOldestCycles() const
+{
+	if (NumRecorded == 0)
+	{
+		return 0;
+	}
+
+	const uint32 Oldest = NumRecorded > Capacity ? NumRecorded - Capacity : 0;
+	return Records[Oldest & (Capacity - 1)].Cycles;
+}
+
+FString UStateTimelineComponent::GetEventName(const FStateTimelineRecord& Event) const
+{
+	switch (Event.Channel)
+	{
+	case EStateTimelineChannel::CharacterState:
+		return StaticEnum<ECharacterState>()->GetDisplayNameTextByValue(Event.Value).ToString();
+	case EStateTimelineChannel::MovementState:
+		return StaticEnum<EMovementState>()->GetDisplayNameTextByValue(Event.Value).ToString();
+	case EStateTimelineChannel::WeaponState:
+		return StaticEnum<EWeaponState>()->GetDisplayNameTextByValue(Event.Value).ToString();
+	case EStateTimelineChannel::EnemyState:
+		return StaticEnum<EEnemyState>()->GetDisplayNameTextByValue(Event.Value).ToString();
+	case EStateTimelineChannel::AIState:
+		return StaticEnum<EAIState>()->GetDisplayNameTextByValue(Event.Value).ToString();
+	case EStateTimelineChannel::AbilityActivated:
+	case EStateTimelineChannel::AbilityFinished:
+	{
+		// Abilities are recorded by slot, so nothing is looked up until export.
+		const UGameAbilitySystemComponent* AbilitySystem = GetOwner() ? GetOwner()->FindComponentByClass<UGameAbilitySystemComponent>() : nullptr;
+		const UClass* AbilityClass = AbilitySystem ? AbilitySystem->GetAbilityInSlot(Event.Extra) : nullptr;
+
+		return FString::Printf(TEXT("%s %s"), Event.Channel == EStateTimelineChannel::AbilityActivated ? TEXT("Activated") : TEXT("Finished"),
+							   AbilityClass ? *AbilityClass->GetName() : *FString::Printf(TEXT("slot %d"), Event.Extra));
+	}
+	default:
+		return FString::Printf(TEXT("%s %s #%d (%d active)"), Event.Channel == EStateTimelineChannel::ModifierPushed ? TEXT("Pushed") :
+							   Event.Channel == EStateTimelineChannel::ModifierUpdated ? TEXT("Updated") : TEXT("Removed"), *Event.Name.ToString(), Event.Extra, Event.Value);
+	}
+}
+
+void UStateTimelineComponent::ExportTraceEvents(FString& OutEvents, const uint64 BaseCycles, const uint64 EndCycles, const int32 ThreadBase) const
+{
+	auto ToMicroseconds = [BaseCycles](const uint64 Cycles)
+	{
+		return FPlatformTime::ToMilliseconds64(Cycles - BaseCycles) * 1000.0;
+	};
+
+	auto AppendEvent = [&OutEvents](const FString& Event)
+	{
+		if (!OutEvents.IsEmpty())
+		{
+			OutEvents += TEXT(",\n");
+		}
+
+		OutEvents += Event;
+	};
+
+	const FString OwnerName = EscapeJson(GetNameSafe(GetOwner()));
+
+	for (int32 Lane = 0; Lane < NumTimelineLanes; Lane++)
+	{
+		AppendEvent(FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %s\"}}"),
+									ThreadBase + Lane, *OwnerName, TimelineLaneNames[Lane]));
+		AppendEvent(FString::Printf(TEXT("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}"),
+									ThreadBase + Lane, ThreadBase + Lane));
+	}
+
+	const uint32 Oldest = NumRecorded > Capacity ? NumRecorded - Capacity : 0;
+
+	for (uint32 Index = Oldest; Index < NumRecorded; Index++)
+	{
+		const FStateTimelineRecord& Event = Records[Index & (Capacity - 1)];
+		const int32 ThreadID = ThreadBase + GetTimelineLane(Event.Channel);
+
+		if (IsStateChannel(Event.Channel))
+		{
+			// A state lasts until the next state of its channel.
+			uint64 SpanEnd = EndCycles;
+
+			for (uint32 Next = Index + 1; Next < NumRecorded; Next++)
+			{
+				if (Records[Next & (Capacity - 1)].Channel == Event.Channel)
+				{
+					SpanEnd = Records[Next & (Capacity - 1)].Cycles;
+					break;
+				}
+			}
+
+			AppendEvent(FString::Printf(TEXT("{\"name\":\"%s\",\"cat\":\"State\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}"),
+										*EscapeJson(GetEventName(Event)), ThreadID, ToMicroseconds(Event.Cycles), ToMicroseconds(SpanEnd) - ToMicroseconds(Event.Cycles)));
+		}
+		else
+		{
+			AppendEvent(FString::Printf(TEXT("{\"name\":\"%s\",\"cat\":\"Event\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}"),
+										*EscapeJson(GetEventName(Event)), ThreadID, ToMicroseconds(Event.Cycles)));
+		}
+	}
+}
+
+/*
+ * Console command exporting state timelines to a Chrome trace file.
+ * Arguments: Actor=<part of an actor name>
+ */
+static FAutoConsoleCommandWithWorldAndArgs TimelineExportCommand(
+	TEXT("Ascension.Timeline.Export"),
+	TEXT("Writes the state timelines of every actor, or of the actors whose name contains Actor=<name>, to a Chrome trace file."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		FString ActorFilter;
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("Actor="), ActorFilter);
+		}
+
+		TArray<const UStateTimelineComponent*> Timelines;
+		uint64 BaseCycles = MAX_uint64;
+
+		for (TObjectIterator<UStateTimelineComponent> It; It; ++It)
+		{
+			if (It->GetWorld() != World || !It->HasEvents() || (!ActorFilter.IsEmpty() && !GetNameSafe(It->GetOwner()).Contains(ActorFilter)))
+			{
+				continue;
+			}
+
+			Timelines.Add(*It);
+			BaseCycles = FMath::Min(BaseCycles, It->GetOldestCycles());
+		}
+
+		if (Timelines.Num() == 0)
+		{
+			UE_LOG(LogBenchmark, Warning, TEXT("Timeline: no timelines recorded%s."), ActorFilter.IsEmpty() ? TEXT("") : *FString::Printf(TEXT(" for %s"), *ActorFilter))
+			return;
+		}
+
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+		FString Events;
+
+		for (int32 Index = 0; Index < Timelines.Num(); Index++)
+		{
+			Timelines[Index]->ExportTraceEvents(Events, BaseCycles, EndCycles, Index * NumTimelineLanes);
+		}
+
+		const FString Trace = FString::Printf(TEXT("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n%s\n]}\n"), *Events);
+		const FString FileName = FString::Printf(TEXT("Timeline-%s.json"), *FDateTime::Now().ToString());
+		const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Timelines"), FileName);
+
+		if (FFileHelper::SaveStringToFile(Trace, *FilePath))
+		{
+			UE_LOG(LogBenchmark, Log, TEXT("Timeline: %d actors written to %s"), Timelines.Num(), *FilePath)
+		}
+		else
+		{
+			UE_LOG(LogBenchmark, Error, TEXT("Timeline: failed to write %s"), *FilePath)
+		}
+	})
+);
+#endif
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "StateTimelineComponent.generated.h"
+
+/** Whether state timelines are compiled in. */
+#define WITH_STATE_TIMELINE !UE_BUILD_SHIPPING
+
+
+/*
+ * Kind of event recorded in a state timeline.
+ */
+enum class EStateTimelineChannel : uint8
+{
+	CharacterState,
+	MovementState,
+	WeaponState,
+	EnemyState,
+	AIState,
+	AbilityActivated,
+	AbilityFinished,
+	ModifierPushed,
+	ModifierUpdated,
+	ModifierRemoved,
+	Num
+};
+
+/*
+ * Event recorded in a state timeline.
+ */
+struct FStateTimelineRecord
+{
+	/** Time of the event, in cycles. */
+	uint64 Cycles;
+
+	/** Name of what caused the event, e.g. the source of a movement modifier. */
+	FName Name;
+
+	/** Ability slot or modifier handle of the event. */
+	uint16 Extra;
+
+	/** Kind of event. */
+	EStateTimelineChannel Channel;
+
+	/** New state for state changes, or the number of modifiers on the stack for modifier changes. */
+	uint8 Value;
+};
+
+/*
+ * Component recording a timeline of its owner's state changes, ability activations and movement modifier changes,
+ * so what happened before a dropped combo or a stuck enemy can be seen after the fact.
+ *
+ * Events are written as packed records to a fixed size ring buffer, overwriting the oldest. Recording an event is a
+ * timestamp and a few stores, with no allocation, so the timeline can stay enabled in test builds. The buffer and the
+ * recording are compiled out of shipping builds, and recording can be turned off with Ascension.Timeline.Enable 0.
+ *
+ * Ascension.Timeline.Export writes the timelines to a Chrome trace file, which can be opened in chrome://tracing or
+ * Perfetto. States are shown as spans and the other events as instants.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class ASCENSION_API UStateTimelineComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties.
+	UStateTimelineComponent();
+
+protected:
+	// Called when the game starts.
+	virtual void BeginPlay() override;
+
+	// Called when the component stops playing.
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	/** Number of events kept. Must be a power of two. */
+	static constexpr int32 Capacity = 256;
+
+#if WITH_STATE_TIMELINE
+	/** Whether events are recorded, when not 0. Set by Ascension.Timeline.Enable. */
+	static int32 RecordEvents;
+#endif
+
+	/*
+	 * Records an event.
+	 * @param Channel	Kind of event.
+	 * @param Value		New state, or the number of modifiers on the stack.
+	 * @param Extra		Ability slot or modifier handle.
+	 * @param Name		Name of what caused the event.
+	 */
+	FORCEINLINE void Record(const EStateTimelineChannel Channel, const uint8 Value, const uint16 Extra = 0, const FName Name = NAME_None)
+	{
+#if WITH_STATE_TIMELINE
+		if (RecordEvents)
+		{
+			FStateTimelineRecord& Event = Records[NumRecorded & (Capacity - 1)];
+			Event.Cycles = FPlatformTime::Cycles64();
+			Event.Name = Name;
+			Event.Extra = Extra;
+			Event.Channel = Channel;
+			Event.Value = Value;
+			NumRecorded++;
+		}
+#endif
+	}
+
+#if WITH_STATE_TIMELINE
+	/*
+	 * Appends the recorded events to a Chrome trace.
+	 * @param OutEvents		Trace events, comma separated.
+	 * @param BaseCycles	Cycles the trace starts at.
+	 * @param EndCycles		Cycles the trace ends at. Spans still open end here.
+	 * @param ThreadBase	First thread ID of the component's lanes.
+	 */
+	void ExportTraceEvents(FString& OutEvents, const uint64 BaseCycles, const uint64 EndCycles, const int32 ThreadBase) const;
+
+	/*
+	 * Returns the time of the oldest event kept, in cycles. 0 if nothing was recorded.
+	 */
+	uint64 GetOldestCycles() const;
+
+	/*
+	 * Whether any events were recorded.
+	 */
+	FORCEINLINE bool HasEvents() const { return NumRecorded > 0; }
+#endif
+
+protected:
+	/*
+	 * Records the states that changed in the player's state component.
+	 * @param PreviousState		Packed state before the change.
+	 * @param NewState			Packed state after the change.
+	 */
+	void OnPlayerStateChanged(uint8 PreviousState, uint8 NewState);
+
+#if WITH_STATE_TIMELINE
+	/*
+	 * Gets the display name of an event's value or extra data.
+	 * @param Event		Recorded event.
+	 */
+	FString GetEventName(const FStateTimelineRecord& Event) const;
+#endif
+
+protected:
+	/** Player state component the timeline is subscribed to. */
+	UPROPERTY(Transient)
+	class UPlayerStateComponent* StateComponent;
+
+#if WITH_STATE_TIMELINE
+	/** Recorded events, indexed by record number modulo the capacity. */
+	FStateTimelineRecord Records[Capacity];
+
+	/** Number of events recorded. */
+	uint32 NumRecorded;
+#endif
+};
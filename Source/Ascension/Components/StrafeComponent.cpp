@@ -8,20 +8,46 @@
 // Sets default values for this component's properties
 UStrafeComponent::UStrafeComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = false;
+	// Set this component to be initialized when the game starts, and to only tick while strafing.
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	Owner = nullptr;
+	Controller = nullptr;
+	AIController = nullptr;
+	StrafeTarget = nullptr;
 }
 
 void UStrafeComponent::BeginPlay()
 {
+	Super::BeginPlay();
+
 	Owner = Cast<ACharacter>(GetOwner());
-	Controller = Owner->GetController();
-	AIController = Cast<AAIController>(Controller);
+}
+
+void UStrafeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (StrafeTarget)
+	{
+		Strafe(StrafeTarget);
+	}
 }
 
 void UStrafeComponent::StrafeStart(AActor* Enemy)
 {
+	if (Owner == nullptr)
+	{
+		return;
+	}
+
+	// The controller is found again each time, as the owner may have been possessed since.
+	Controller = Owner->GetController();
+	AIController = Cast<AAIController>(Controller);
+	StrafeTarget = Enemy;
+	SetComponentTickEnabled(StrafeTarget != nullptr);
+
 	if (AIController)
 	{
 		AIController->SetFocus(Enemy);
@@ -34,7 +60,12 @@ void UStrafeComponent::StrafeStart(AActor* Enemy)
 
 void UStrafeComponent::Strafe(AActor* Enemy)
 {
-	if (!AIController)
+	if (Owner == nullptr)
+	{
+		return;
+	}
+
+	if (!AIController && Controller && Enemy)
 	{
 		// Finding the direction to look at while strafing.
 		FRotator Direction = UKismetMathLibrary::FindLookAtRotation(Owner->GetActorLocation(), Enemy->GetActorLocation());
@@ -49,6 +80,14 @@ void UStrafeComponent::Strafe(AActor* Enemy)
 
 void UStrafeComponent::StrafeEnd()
 {
+	StrafeTarget = nullptr;
+	SetComponentTickEnabled(false);
+
+	if (Owner == nullptr)
+	{
+		return;
+	}
+
 	if (AIController)
 	{
 		AIController->ClearFocus(EAIFocusPriority::Gameplay);
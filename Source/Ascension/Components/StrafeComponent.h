@@ -17,9 +17,15 @@ public:
 	UStrafeComponent();
 
 	/** Called when the component comes into play. */
-	void BeginPlay();
+	virtual void BeginPlay() override;
 
-	/** Function called when strafing is started. */
+	/** Moves the owner around the strafe target while strafing. */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/*
+	 * Function called when strafing is started. The component ticks, moving the owner around the enemy, until
+	 * strafing ends, so the movement doesn't depend on how often the AI updates.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Strafe")
 	void StrafeStart(AActor* Enemy);
 
@@ -40,4 +46,8 @@ private:
 
 	UPROPERTY(VisibleAnywhere, Category = "Owner")
 	AAIController* AIController;
+
+	/** Actor strafed around. Null while not strafing. */
+	UPROPERTY(Transient)
+	AActor* StrafeTarget;
 };
@@ -2,16 +2,25 @@
 
 #include "Ascension.h"
 #include "Enemy.h"
+#include "Significance/EnemySignificanceSubsystem.h"
+#include "Combat/CombatCoordinatorSubsystem.h"
+#include "AI/EnemyAIController.h"
 
 
 // Sets default values
 AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ 	// Enemies don't need to tick, Blueprints that do can enable it.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// Enemy controllers let significance throttle their behavior trees.
+	AIControllerClass = AEnemyAIController::StaticClass();
 
 	Dead = false;
+	SignificanceBucket = ESignificanceBucket::SB_Near;
+	bWaitingToAttack = false;
 }
 
 // Called when the game starts or when spawned
@@ -19,6 +28,26 @@ void AEnemy::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (UEnemySignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>())
+	{
+		SignificanceSubsystem->RegisterEnemy(this);
+	}
+}
+
+// Called when the enemy exits play
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UEnemySignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>())
+	{
+		SignificanceSubsystem->UnregisterEnemy(this);
+	}
+
+	if (UCombatCoordinatorSubsystem* CombatCoordinator = GetWorld()->GetSubsystem<UCombatCoordinatorSubsystem>())
+	{
+		CombatCoordinator->LeaveCombat(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AEnemy::Attack_Implementation()
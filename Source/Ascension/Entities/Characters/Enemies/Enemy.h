@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Entities/Characters/GameCharacter.h"
+#include "Globals.h"
 #include "Enemy.generated.h"
 
 
@@ -23,6 +24,9 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the enemy exits play.
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	/** Event fired when enemy is hit. */
 	UPROPERTY(BlueprintAssignable, BlueprintCallable, Category = "Event Dispatchers")
@@ -48,4 +52,40 @@ public:
 
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+public:
+	/*
+	 * Whether the enemy is fighting. Enemies in combat always update at full rate.
+	 */
+	virtual bool IsInCombat() const { return false; }
+
+	/*
+	 * Whether the enemy is fighting without an attack token, circling its target until it gets one.
+	 * Waiting enemies update at reduced rates even when near.
+	 */
+	FORCEINLINE bool IsWaitingToAttack() const { return bWaitingToAttack; }
+
+	/*
+	 * Sets whether the enemy is waiting for an attack token. Called by the combat coordinator.
+	 * @param bWaiting	Whether the enemy is waiting.
+	 */
+	FORCEINLINE void SetWaitingToAttack(const bool bWaiting) { bWaitingToAttack = bWaiting; }
+
+	/*
+	 * Gets the significance bucket of the enemy, which sets how often it updates.
+	 */
+	FORCEINLINE ESignificanceBucket GetSignificanceBucket() const { return SignificanceBucket; }
+
+	/*
+	 * Sets the significance bucket of the enemy. Called by the enemy significance subsystem.
+	 * @param Bucket	Significance bucket.
+	 */
+	FORCEINLINE void SetSignificanceBucket(const ESignificanceBucket Bucket) { SignificanceBucket = Bucket; }
+
+private:
+	/** Significance bucket of the enemy. */
+	ESignificanceBucket SignificanceBucket;
+
+	/** Whether the enemy is waiting for an attack token. */
+	bool bWaitingToAttack;
 };
@@ -2,7 +2,11 @@
 
 #include "Ascension.h"
 #include "Components/AttackComponent.h"
+#include "Components/GameMovementComponent.h"
+#include "Significance/EnemySignificanceSubsystem.h"
+#include "Combat/CombatCoordinatorSubsystem.h"
 #include "Abilities/AbilitySystems/GameAbilitySystemComponent.h"
+#include "Components/StateTimelineComponent.h"
 #include "Goblin.h"
 
 
@@ -26,10 +30,11 @@ AGoblin::AGoblin(const FObjectInitializer& ObjectInitializer)
 
 	// Configure character movement
 	GetCharacterMovement()->bOrientRotationToMovement = true; // Character moves in the direction of input...	
-	GetCharacterMovement()->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
 	GetCharacterMovement()->JumpZVelocity = 600.f;
 	GetCharacterMovement()->AirControl = 0.2f;
-	GetCharacterMovement()->MaxWalkSpeed = 500.0f;
+
+	// Speed and rotation rate are defaults of the movement modifier stack, so abilities restore them when they finish.
+	GetGameMovementComponent()->SetDefaultMovement(500.0f, GetCharacterMovement()->MaxAcceleration, 540.0f);
 
 	// Create and initialize the Goblin's attack component.
 	AttackComponent = CreateDefaultSubobject<UAttackComponent>(AGoblin::AttackComponentName);
@@ -46,6 +51,15 @@ void AGoblin::GetHealthPercent_Implementation(float& HealthPercent)
 
 void AGoblin::ApplyHitEffect_Implementation(const AActor* SourceActor, const float Damage, const EHitEffect HitEffect, const FAttackEffect AttackEffect)
 {
+	ApplyAttackEffects(SourceActor, Damage, HitEffect, AttackEffect);
+
+	if (CheckDead())
+	{
+		KillActor();
+	}
+
+	ShowHitVisuals();
+	OnHit.Broadcast();
 }
 
 void AGoblin::ShowHealthBar_Implementation()
@@ -92,11 +106,23 @@ void AGoblin::EnterCombat(AActor* Enemy)
 	
 	Blackboard->SetValueAsObject(EnemyKeyName, Enemy);
 
-	AIState = EAIState::AIS_Combat;
+	SetAIState(EAIState::AIS_Combat);
 	Blackboard->SetValueAsEnum(AIStateKeyName, (uint8) AIState);
 
 	CombatState = EEnemyCombatState::ECS_Observing;
 	Blackboard->SetValueAsEnum(CombatStateKeyName, (uint8) CombatState);
+
+	// Fight with full movement and update rates straight away.
+	if (UEnemySignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>())
+	{
+		SignificanceSubsystem->MakeSignificant(this);
+	}
+
+	// Only a few goblins attack at once, the others circle until it's their turn.
+	if (UCombatCoordinatorSubsystem* CombatCoordinator = GetWorld()->GetSubsystem<UCombatCoordinatorSubsystem>())
+	{
+		CombatCoordinator->JoinCombat(this, Enemy, WantsAttackKeyName, WantsObserveKeyName);
+	}
 }
 
 void AGoblin::ExitCombat()
@@ -105,8 +131,13 @@ void AGoblin::ExitCombat()
 
 	Blackboard->ClearValue(EnemyKeyName);
 
-	AIState = EAIState::AIS_Patrol;
+	SetAIState(EAIState::AIS_Patrol);
 	Blackboard->SetValueAsEnum(AIStateKeyName, (uint8) AIState);
+
+	if (UCombatCoordinatorSubsystem* CombatCoordinator = GetWorld()->GetSubsystem<UCombatCoordinatorSubsystem>())
+	{
+		CombatCoordinator->LeaveCombat(this);
+	}
 }
 
 void AGoblin::ShowHitVisuals_Implementation() {}
@@ -117,16 +148,24 @@ void AGoblin::Attack_Implementation()
 	{
 		if (ActionState == EEnemyState::ES_Idle)
 		{
-			ActionState = EEnemyState::ES_Attacking;
-			// ToDo: Don't hard-code attack names.
-			AttackComponent->Attack(FString("Light01"));
+			SetActionState(EEnemyState::ES_Attacking);
+
+			// Goblins without a combo graph only know a single attack.
+			const bool bAttacked = AttackComponent->HasComboGraph() ? AttackComponent->ComboAttack(AttackInputName)
+																	: AttackComponent->Attack(FString("Light01"));
+
+			// Nothing was performed, e.g. no transition of the combo graph matched, so the goblin can try again.
+			if (!bAttacked)
+			{
+				SetActionState(EEnemyState::ES_Idle);
+			}
 		}
 	}
 }
 
 void AGoblin::ResetAttack_Implementation()
 {
-	ActionState = EEnemyState::ES_Idle;
+	SetActionState(EEnemyState::ES_Idle);
 }
 
 void AGoblin::AttackComplete_Implementation()
@@ -134,10 +173,25 @@ void AGoblin::AttackComplete_Implementation()
 
 }
 
+void AGoblin::ApplyResolvedHit(const FResolvedHit& Hit)
+{
+	if (Dead)
+	{
+		return;
+	}
+
+	// ApplyHitEffect applies the damage, reaction, death and hit events, whether natively or in a Blueprint override.
+	ApplyHitEffect(Hit.SourceActor, Hit.Damage, Hit.HitEffect, Hit.AttackEffect);
+}
+
 void AGoblin::ApplyAttackEffects_Implementation(const AActor* SourceActor, float Damage, const EHitEffect HitEffect, const FAttackEffect AttackEffect)
 {
 	DecrementHealth(Damage);
+	ReactToHit(SourceActor, HitEffect, AttackEffect);
+}
 
+void AGoblin::ReactToHit(const AActor* SourceActor, const EHitEffect HitEffect, const FAttackEffect& AttackEffect)
+{
 	if (SourceActor != nullptr)
 	{
 		// Find the direction in which we need to launch our character.
@@ -174,6 +228,13 @@ void AGoblin::ApplyAttackEffects_Implementation(const AActor* SourceActor, float
 void AGoblin::KillActor_Implementation()
 {
 	Dead = true;
+
+	// Dead goblins hand their attack token on before losing their controller and blackboard.
+	if (UCombatCoordinatorSubsystem* CombatCoordinator = GetWorld()->GetSubsystem<UCombatCoordinatorSubsystem>())
+	{
+		CombatCoordinator->LeaveCombat(this);
+	}
+
 	DetachFromControllerPendingDestroy();
 	DisableMovement();
 }
@@ -182,3 +243,21 @@ void AGoblin::DecrementHealth_Implementation(float Damage)
 {
 	Health -= Damage;
 }
+
+void AGoblin::SetActionState(const EEnemyState State)
+{
+	if (State != ActionState)
+	{
+		ActionState = State;
+		GetStateTimelineComponent()->Record(EStateTimelineChannel::EnemyState, (uint8) State);
+	}
+}
+
+void AGoblin::SetAIState(const EAIState State)
+{
+	if (State != AIState)
+	{
+		AIState = State;
+		GetStateTimelineComponent()->Record(EStateTimelineChannel::AIState, (uint8) State);
+	}
+}
@@ -57,6 +57,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Parameters")
 	EEnemyState ActionState;
 
+	/** Input given to the attack component's combo graph when attacking. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combos")
+	FName AttackInputName = FName("Attack");
+
 	/** Points which the entity patrols. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Behavior")
 	TArray<AActor*> PatrolPoints;
@@ -75,6 +79,14 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Blackboard Keys")
 	FName EnemyKeyName = FName("Enemy");
 
+	/** Wants attack key name. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Blackboard Keys")
+	FName WantsAttackKeyName = FName("WantsAttack");
+
+	/** Wants observe key name. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Blackboard Keys")
+	FName WantsObserveKeyName = FName("WantsObserve");
+
 public:
 	/* DAMAGEABLE INTERFACE FUNCTIONS */
 
@@ -103,6 +115,15 @@ public:
 	bool IsDead();
 	virtual bool IsDead_Implementation() override;
 
+	/** Applies the hits received this frame natively, reacting to them only once. */
+	virtual void ApplyResolvedHit(const FResolvedHit& Hit) override;
+
+	/** Whether the goblin is fighting. */
+	virtual bool IsInCombat() const override { return AIState == EAIState::AIS_Combat; }
+
+	/** Goblins can be locked on to until they die. */
+	virtual bool CanBeLockedOn() const override { return !Dead; }
+
 public:
 	/** Implementation of attack. */
 	virtual void Attack_Implementation() override;
@@ -161,6 +182,26 @@ protected:
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Gameplay")
 	void KillActor();
 
+	/*
+	 * Launches and turns the goblin away from the source of a hit.
+	 * @param SourceActor	Actor that caused the hit.
+	 * @param HitEffect		Type of effect of the hit.
+	 * @param AttackEffect	Effect of the attack on the goblin.
+	 */
+	void ReactToHit(const AActor* SourceActor, const EHitEffect HitEffect, const FAttackEffect& AttackEffect);
+
+	/*
+	 * Sets the action state and records it in the state timeline.
+	 * @param State		State of the goblin's actions.
+	 */
+	void SetActionState(const EEnemyState State);
+
+	/*
+	 * Sets the AI state and records it in the state timeline.
+	 * @param State		General state of the AI.
+	 */
+	void SetAIState(const EAIState State);
+
 private:
 	
 };
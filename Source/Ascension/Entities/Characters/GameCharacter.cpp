@@ -3,6 +3,13 @@
 #include "Ascension.h"
 #include "GameCharacter.h"
 #include "Components/GameMovementComponent.h"
+#include "Combat/DamageableSubsystem.h"
+#include "Combat/LockOnSubsystem.h"
+#include "Components/HitboxHistoryComponent.h"
+#include "Components/StateTimelineComponent.h"
+
+FName AGameCharacter::HitboxHistoryComponentName(TEXT("HitboxHistoryComponent"));
+FName AGameCharacter::StateTimelineComponentName(TEXT("StateTimelineComponent"));
 
 // Sets default values
 AGameCharacter::AGameCharacter(const FObjectInitializer& ObjectInitializer)
@@ -11,13 +18,45 @@ AGameCharacter::AGameCharacter(const FObjectInitializer& ObjectInitializer)
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	CombatIndex = INDEX_NONE;
+
+	// Create the character's hitbox history component.
+	HitboxHistoryComponent = CreateDefaultSubobject<UHitboxHistoryComponent>(AGameCharacter::HitboxHistoryComponentName);
+
+	// Create the character's state timeline component.
+	StateTimelineComponent = CreateDefaultSubobject<UStateTimelineComponent>(AGameCharacter::StateTimelineComponentName);
 }
 
 // Called when the game starts or when spawned
 void AGameCharacter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	UDamageableSubsystem* DamageableSubsystem = GetWorld()->GetSubsystem<UDamageableSubsystem>();
+
+	if (DamageableSubsystem)
+	{
+		CombatIndex = DamageableSubsystem->RegisterDamageable(this);
+	}
+
+	// Characters that aren't lockable are ignored by the lock-on subsystem.
+	if (ULockOnSubsystem* LockOnSubsystem = GetWorld()->GetSubsystem<ULockOnSubsystem>())
+	{
+		LockOnSubsystem->RegisterLockable(this);
+	}
+}
+
+// Called when the character exits play
+void AGameCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	CombatIndex = INDEX_NONE;
+}
+
+UGameMovementComponent* AGameCharacter::GetGameMovementComponent() const
+{
+	return CastChecked<UGameMovementComponent>(GetCharacterMovement());
 }
 
 // Called every frame
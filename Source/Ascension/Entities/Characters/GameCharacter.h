@@ -11,6 +11,21 @@ class ASCENSION_API AGameCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	/** Component recording the character's hitboxes on servers, for lag compensated hits. */
+	UPROPERTY(Category = Character, VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class UHitboxHistoryComponent* HitboxHistoryComponent;
+
+	/** Component recording the character's state changes, for debugging. */
+	UPROPERTY(Category = Character, VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class UStateTimelineComponent* StateTimelineComponent;
+
+public:
+	/** Name of the hitbox history component. */
+	static FName HitboxHistoryComponentName;
+
+	/** Name of the state timeline component. */
+	static FName StateTimelineComponentName;
+
 public:
 	// Sets default values for this character's properties
 	AGameCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
@@ -19,6 +34,9 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the character exits play.
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -26,4 +44,22 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	/*
+	 * Gets the combat index of the character, given by the world's damageable subsystem.
+	 * INDEX_NONE if the character isn't damageable or isn't in play.
+	 */
+	FORCEINLINE int32 GetCombatIndex() const { return CombatIndex; }
+
+	/** Returns the character movement component as a game movement component. */
+	class UGameMovementComponent* GetGameMovementComponent() const;
+
+	/** Returns the hitbox history component. */
+	FORCEINLINE class UHitboxHistoryComponent* GetHitboxHistoryComponent() const { return HitboxHistoryComponent; }
+
+	/** Returns the state timeline component. */
+	FORCEINLINE class UStateTimelineComponent* GetStateTimelineComponent() const { return StateTimelineComponent; }
+
+private:
+	/** Combat index of the character. */
+	int32 CombatIndex;
 };
@@ -13,78 +13,63 @@ UPlayerAbilitySystemComponent::UPlayerAbilitySystemComponent()
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
-	
+
+	StateComponent = nullptr;
+	CanChain = false;
+}
+
+// Called when the game starts
+void UPlayerAbilitySystemComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	StateComponent = GetOwner()->FindComponentByClass<UPlayerStateComponent>();
+
+	if (StateComponent)
+	{
+		StateComponent->OnStateChanged().AddUObject(this, &UPlayerAbilitySystemComponent::OnPlayerStateChanged);
+	}
+}
+
+void UPlayerAbilitySystemComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (StateComponent)
+	{
+		StateComponent->OnStateChanged().RemoveAll(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UPlayerAbilitySystemComponent::OnPlayerStateChanged(uint8 PreviousState, uint8 NewState)
+{
+	// A chain window can't outlive the action it was opened in.
+	if (UPlayerStateComponent::UnpackCharacterState(NewState) != UPlayerStateComponent::UnpackCharacterState(PreviousState))
+	{
+		CanChain = false;
+	}
 }
 
 
 bool UPlayerAbilitySystemComponent::CanActivateAbility(const FString& AbilityName)
 {
-	const AAscensionCharacter* Player = Cast<AAscensionCharacter>(Owner);
-	UPlayerStateComponent* StateComponent = Player->FindComponentByClass<UPlayerStateComponent>();
+	// Cooldowns, charges and stamina are checked first as they are the cheapest to reject on.
+	if (!Super::CanActivateAbility(AbilityName))
+	{
+		return false;
+	}
 
-	if (StateComponent)
+	if (StateComponent && GetAbility(AbilityName) != nullptr)
 	{
-		if (GetAbility(AbilityName) != nullptr)
+		// TODO: Chaining needs to be done by a anim notify sequence and not via a variable.
+		if (IsAttack(AbilityName))
+		{
+			return StateComponent->HasCapability(EPlayerCapability::Attack) || (CanChain && StateComponent->HasCapability(EPlayerCapability::ChainAttack));
+		}
+
+		if (IsDodge(AbilityName))
 		{
-			if (IsAttack(AbilityName))
-			{
-				if ((StateComponent->GetCharacterState() == ECharacterState::CS_Idle ||
-					 StateComponent->GetCharacterState() == ECharacterState::CS_Attacking ||
-					 StateComponent->GetCharacterState() == ECharacterState::CS_Dodging) &&
-					(StateComponent->GetMovementState() == EMovementState::MS_OnGround) &&
-					(StateComponent->GetWeaponState() == EWeaponState::WS_Unsheathed))
-				{
-					if (StateComponent->GetCharacterState() == ECharacterState::CS_Attacking ||
-						StateComponent->GetCharacterState() == ECharacterState::CS_Dodging)
-					{
-						if (CanChain)
-						{
-							// TODO: This needs to be done by a anim notify sequence and not via a variable.
-							return true;
-						}
-						else
-						{
-							return false;
-						}
-					}
-					else
-					{
-						return true;
-					}
-				}
-				else
-				{
-					return false;
-				}
-
-			}
-
-			else if (IsDodge(AbilityName))
-			{
-				if ((StateComponent->GetCharacterState() == ECharacterState::CS_Idle ||
-					 StateComponent->GetCharacterState() == ECharacterState::CS_Attacking ||
-					 StateComponent->GetCharacterState() == ECharacterState::CS_Dodging) &&
-					(StateComponent->GetMovementState() == EMovementState::MS_OnGround))
-				{
-					if (StateComponent->GetCharacterState() == ECharacterState::CS_Attacking ||
-						StateComponent->GetCharacterState() == ECharacterState::CS_Dodging)
-					{
-						if (CanChain)
-						{
-							// TODO: This needs to be done by a anim notify sequence and not via a variable.
-							return true;
-						}
-						else
-						{
-							return false;
-						}
-					}
-					else
-					{
-						return true;
-					}
-				}
-			}
+			return StateComponent->HasCapability(EPlayerCapability::Dodge) || (CanChain && StateComponent->HasCapability(EPlayerCapability::ChainDodge));
 		}
 	}
 	
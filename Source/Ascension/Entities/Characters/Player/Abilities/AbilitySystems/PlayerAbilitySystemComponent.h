@@ -19,6 +19,24 @@ public:
 	UPlayerAbilitySystemComponent();
 
 protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	// Called when the component stops playing
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/*
+	 * Closes the chain window when the character state changes.
+	 * @param PreviousState		Packed state before the change.
+	 * @param NewState			Packed state after the change.
+	 */
+	void OnPlayerStateChanged(uint8 PreviousState, uint8 NewState);
+
+protected:
+	/** State component of the player. */
+	UPROPERTY(Transient)
+	class UPlayerStateComponent* StateComponent;
+
 	/** Set to true if the character can chain an attack. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Gameplay")
 	bool CanChain;
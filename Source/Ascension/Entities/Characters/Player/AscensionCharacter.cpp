@@ -7,6 +7,8 @@
 #include "Components/PlayerAttackComponent.h"
 #include "Components/PlayerDodgeComponent.h"
 #include "Components/PlayerInputComponent.h"
+#include "Components/GameMovementComponent.h"
+#include "Combat/LockOnSubsystem.h"
 #include "Abilities/AbilitySystems/PlayerAbilitySystemComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "AscensionCharacter.h"
@@ -39,6 +41,19 @@ AAscensionCharacter::AAscensionCharacter(const FObjectInitializer& ObjectInitial
 	SprintSpeed = 800.0f;
 	NormalAcceleration = 2048.0f;
 	NormalTurnRate = 540.0f;
+	SprintModifierHandle = 0;
+
+	// Set movement intent variables.
+	ForwardAxisValue = 0.0f;
+	RightAxisValue = 0.0f;
+	IntentControlYaw = 0.0f;
+	ControlForward = FVector::ForwardVector;
+	ControlRight = FVector::RightVector;
+	MoveBufferedFrame = 0;
+	InputBufferComponent = nullptr;
+
+	// State follows movement mode changes and intent follows input, so the character doesn't need to tick.
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Set gameplay variables.
 	ShouldCharSwitch = false;
@@ -46,6 +61,9 @@ AAscensionCharacter::AAscensionCharacter(const FObjectInitializer& ObjectInitial
 	// Camera lock-on variables.
 	LockedOn = false;
 	LockedActor = nullptr;
+	LockDirection = FVector::ForwardVector;
+	LockDirectionFrame = 0;
+	LockOnSubsystem = nullptr;
 
 	// Don't rotate when the controller rotates. Let that just affect the camera.
 	bUseControllerRotationPitch = false;
@@ -115,6 +133,11 @@ void AAscensionCharacter::SetupPlayerInputComponent(class UInputComponent* Playe
 
 	PlayerInputComponent->BindAction("SheathWeapon", IE_Pressed, this, &AAscensionCharacter::SwitchWeapon);
 
+	// PlayerCharacter_BP's LockOn event overrides this binding until the event is removed from the Blueprint.
+	PlayerInputComponent->BindAction("LockOn", IE_Pressed, this, &AAscensionCharacter::ToggleLockOn);
+	PlayerInputComponent->BindAction("SwitchTargetLeft", IE_Pressed, this, &AAscensionCharacter::SwitchTargetLeft);
+	PlayerInputComponent->BindAction("SwitchTargetRight", IE_Pressed, this, &AAscensionCharacter::SwitchTargetRight);
+
 	PlayerInputComponent->BindAxis("MoveForward", this, &AAscensionCharacter::MoveForward);
 	PlayerInputComponent->BindAxis("MoveRight", this, &AAscensionCharacter::MoveRight);
 
@@ -129,42 +152,99 @@ void AAscensionCharacter::SetupPlayerInputComponent(class UInputComponent* Playe
 void AAscensionCharacter::BeginPlay()
 {
 	Super::BeginPlay();
+
+	GetGameMovementComponent()->SetDefaultMovement(NormalSpeed, NormalAcceleration, NormalTurnRate);
+
+	UpdateMovementState();
+	MovementIntent = GetActorForwardVector().GetSafeNormal2D();
+
+	LockOnSubsystem = GetWorld()->GetSubsystem<ULockOnSubsystem>();
+
+	if (LockOnSubsystem)
+	{
+		LockOnSubsystem->RegisterSeeker(this);
+		LockOnSubsystem->OnCandidatesRefreshed().AddUObject(this, &AAscensionCharacter::OnLockOnCandidatesRefreshed);
+	}
 }
 
-void AAscensionCharacter::Tick(float DeltaSeconds)
+void AAscensionCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaSeconds);
-
-	if (GetCharacterMovement()->IsFalling())
+	if (LockOnSubsystem)
 	{
-		if (StateComponent)
-		{
-			StateComponent->SetMovementState(EMovementState::MS_InAir);
-		}
+		LockOnSubsystem->OnCandidatesRefreshed().RemoveAll(this);
+		LockOnSubsystem->UnregisterSeeker(this);
+		LockOnSubsystem = nullptr;
 	}
-	else
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAscensionCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+	InputBufferComponent = nullptr;
+}
+
+void AAscensionCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+	InputBufferComponent = nullptr;
+}
+
+void AAscensionCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+	InputBufferComponent = nullptr;
+}
+
+UPlayerInputComponent* AAscensionCharacter::GetInputBufferComponent()
+{
+	// Found again after each possession, in case the controller created it later.
+	if (InputBufferComponent == nullptr && Controller != nullptr)
 	{
-		if (StateComponent)
-		{
-			StateComponent->SetMovementState(EMovementState::MS_OnGround);
-		}
+		InputBufferComponent = Controller->FindComponentByClass<UPlayerInputComponent>();
 	}
 
-	MovementIntent = ForwardIntent + SideIntent;
+	return InputBufferComponent;
+}
 
-	if (Controller != nullptr)
+void AAscensionCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+	UpdateMovementState();
+}
+
+void AAscensionCharacter::UpdateMovementState()
+{
+	if (StateComponent)
 	{
-		UPlayerInputComponent* PlayerInputComponent = Controller->FindComponentByClass<UPlayerInputComponent>();
+		StateComponent->SetMovementState(GetCharacterMovement()->IsFalling() ? EMovementState::MS_InAir : EMovementState::MS_OnGround);
+	}
+}
 
-		if (PlayerInputComponent)
-		{
-			if (!MovementIntent.IsNearlyZero(0.01f))
-			{
-				PlayerInputComponent->BufferInput("Move", true);
-			}
-		}
+void AAscensionCharacter::UpdateMovementIntent(const float ForwardValue, const float RightValue)
+{
+	const float ControlYaw = Controller ? Controller->GetControlRotation().Yaw : IntentControlYaw;
+
+	if (ControlYaw != IntentControlYaw)
+	{
+		const FRotationMatrix YawRotation(FRotator(0.0f, ControlYaw, 0.0f));
+		ControlForward = YawRotation.GetUnitAxis(EAxis::X);
+		ControlRight = YawRotation.GetUnitAxis(EAxis::Y);
+		IntentControlYaw = ControlYaw;
+	}
+	else if (ForwardValue == ForwardAxisValue && RightValue == RightAxisValue)
+	{
+		BufferMoveInput();
+		return;
 	}
 
+	ForwardAxisValue = ForwardValue;
+	RightAxisValue = RightValue;
+	ForwardIntent = ControlForward * ForwardValue;
+	SideIntent = ControlRight * RightValue;
+	MovementIntent = ForwardIntent + SideIntent;
+
 	if (MovementIntent.IsNearlyZero(0.01f))
 	{
 		const FRotator YawRotation(0, GetActorRotation().Yaw, 0);
@@ -174,6 +254,24 @@ void AAscensionCharacter::Tick(float DeltaSeconds)
 	{
 		MovementIntent.Normalize();
 	}
+
+	BufferMoveInput();
+}
+
+void AAscensionCharacter::BufferMoveInput()
+{
+	// The move input stays buffered for as long as it is held, refreshed once per frame.
+	if (MoveBufferedFrame == GFrameCounter || (ForwardIntent + SideIntent).IsNearlyZero(0.01f))
+	{
+		return;
+	}
+
+	MoveBufferedFrame = GFrameCounter;
+
+	if (UPlayerInputComponent* InputBuffer = GetInputBufferComponent())
+	{
+		InputBuffer->BufferInput("Move", true);
+	}
 }
 
 void AAscensionCharacter::OnResetVR()
@@ -194,42 +292,22 @@ void AAscensionCharacter::TouchStopped(ETouchIndex::Type FingerIndex, FVector Lo
 
 void AAscensionCharacter::MoveForward(float Value)
 {
-	// find out which way is forward
-	const FRotator Rotation = Controller->GetControlRotation();
-	const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-	// get forward vector
-	const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-	ForwardIntent = Direction * Value;
+	UpdateMovementIntent(Value, RightAxisValue);
 
-	if (StateComponent)
+	if ((Controller != NULL) && (Value != 0.0f) && StateComponent && StateComponent->HasCapability(EPlayerCapability::Move))
 	{
-		if ((Controller != NULL) && (Value != 0.0f) &&
-			StateComponent->GetCharacterState() == ECharacterState::CS_Idle)
-		{
-			AddMovementInput(Direction, Value);
-		}
+		AddMovementInput(ControlForward, Value);
 	}
 }
 
 void AAscensionCharacter::MoveRight(float Value)
 {
-	// find out which way is right
-	const FRotator Rotation = Controller->GetControlRotation();
-	const FRotator YawRotation(0, Rotation.Yaw, 0);
+	UpdateMovementIntent(ForwardAxisValue, Value);
 
-	// get right vector 
-	const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
-	SideIntent = Direction * Value;
-
-	if (StateComponent)
+	if ((Controller != NULL) && (Value != 0.0f) && StateComponent && StateComponent->HasCapability(EPlayerCapability::Move))
 	{
-		if ((Controller != NULL) && (Value != 0.0f) &&
-			StateComponent->GetCharacterState() == ECharacterState::CS_Idle)
-		{
-			// add movement in that direction
-			AddMovementInput(Direction, Value);
-		}
+		// add movement in that direction
+		AddMovementInput(ControlRight, Value);
 	}
 }
 
@@ -248,127 +326,99 @@ void AAscensionCharacter::LookUpAtRate(float Rate)
 
 void AAscensionCharacter::Sprint_Implementation()
 {
-	if (StateComponent)
+	if (StateComponent && StateComponent->HasCapability(EPlayerCapability::Sprint) && SprintModifierHandle == 0)
 	{
-		if (StateComponent->GetCharacterState() == ECharacterState::CS_Idle &&
-			StateComponent->GetMovementState() == EMovementState::MS_OnGround)
-		{
-			UCharacterMovementComponent* MovementComponent = GetCharacterMovement();
-			MovementComponent->MaxWalkSpeed = SprintSpeed;
-		}
+		// Sprinting yields to the movement of abilities.
+		FMovementModifier SprintModifier;
+		SprintModifier.Priority = -1;
+		SprintModifier.SetSpeed(SprintSpeed);
+
+		SprintModifierHandle = GetGameMovementComponent()->PushMovementModifier(SprintModifier, FName("Sprint"));
 	}
 }
 
 void AAscensionCharacter::StopSprinting()
 {
-	if (StateComponent)
-	{
-		if (StateComponent->GetCharacterState() == ECharacterState::CS_Idle)
-		{
-			UCharacterMovementComponent* MovementComponent = GetCharacterMovement();
-			MovementComponent->MaxWalkSpeed = NormalSpeed;
-		}
-	}
+	GetGameMovementComponent()->RemoveMovementModifier(SprintModifierHandle);
+	SprintModifierHandle = 0;
 }
 
 void AAscensionCharacter::Jump()
 {
-	if (StateComponent)
+	if (StateComponent && StateComponent->HasCapability(EPlayerCapability::Jump))
 	{
-		if (StateComponent->GetCharacterState() == ECharacterState::CS_Idle)
-		{
-			ACharacter::Jump();
-		}
+		ACharacter::Jump();
 	}
 }
 
 void AAscensionCharacter::StopJumping()
 {
-	if (StateComponent)
+	if (StateComponent && StateComponent->HasCapability(EPlayerCapability::Jump))
 	{
-		if (StateComponent->GetCharacterState() == ECharacterState::CS_Idle)
-		{
-			ACharacter::StopJumping();
-		}
+		ACharacter::StopJumping();
 	}
 }
 
 void AAscensionCharacter::LightAttack_Implementation()
 {
-	if (Controller != nullptr)
-	{
-		UPlayerInputComponent* PlayerInputComponent = Controller->FindComponentByClass<UPlayerInputComponent>();
+	UPlayerInputComponent* PlayerInputComponent = GetInputBufferComponent();
 
-		if (PlayerInputComponent)
-		{
-			PlayerInputComponent->BufferInput("Light Attack", false);
-			PlayerInputComponent->TryBufferedAction();
-		}
+	if (PlayerInputComponent)
+	{
+		PlayerInputComponent->BufferInput("Light Attack", false);
+		PlayerInputComponent->TryBufferedAction();
 	}
 }
 
 void AAscensionCharacter::StrongAttack_Implementation()
 {
-	if (Controller != nullptr)
-	{
-		UPlayerInputComponent* PlayerInputComponent = Controller->FindComponentByClass<UPlayerInputComponent>();
+	UPlayerInputComponent* PlayerInputComponent = GetInputBufferComponent();
 
-		if (PlayerInputComponent)
-		{
-			PlayerInputComponent->BufferInput("Strong Attack", false);
-			PlayerInputComponent->TryBufferedAction();
-		}
+	if (PlayerInputComponent)
+	{
+		PlayerInputComponent->BufferInput("Strong Attack", false);
+		PlayerInputComponent->TryBufferedAction();
 	}
 }
 
 void AAscensionCharacter::UpperAttack_Implementation()
 {
-	if (Controller != nullptr)
-	{
-		UPlayerInputComponent* PlayerInputComponent = Controller->FindComponentByClass<UPlayerInputComponent>();
+	UPlayerInputComponent* PlayerInputComponent = GetInputBufferComponent();
 
-		if (PlayerInputComponent)
-		{
-			PlayerInputComponent->BufferInput("Upper Attack", false);
-			PlayerInputComponent->TryBufferedAction();
-		}
+	if (PlayerInputComponent)
+	{
+		PlayerInputComponent->BufferInput("Upper Attack", false);
+		PlayerInputComponent->TryBufferedAction();
 	}
 }
 
 void AAscensionCharacter::Dodge_Implementation()
 {
-	if (Controller != nullptr)
-	{
-		UPlayerInputComponent* PlayerInputComponent = Controller->FindComponentByClass<UPlayerInputComponent>();
+	UPlayerInputComponent* PlayerInputComponent = GetInputBufferComponent();
 
-		if (PlayerInputComponent)
-		{
-			PlayerInputComponent->BufferInput("Dodge", false);
-			PlayerInputComponent->TryBufferedAction();
-		}
+	if (PlayerInputComponent)
+	{
+		PlayerInputComponent->BufferInput("Dodge", false);
+		PlayerInputComponent->TryBufferedAction();
 	}
 }
 
 void AAscensionCharacter::SwitchWeapon()
 {
-	if (StateComponent)
+	if (StateComponent && StateComponent->HasCapability(EPlayerCapability::SwitchWeapon))
 	{
-		if (StateComponent->GetCharacterState() == ECharacterState::CS_Idle &&
-			StateComponent->GetMovementState() == EMovementState::MS_OnGround)
+		switch (StateComponent->GetWeaponState())
 		{
-			switch (StateComponent->GetWeaponState())
-			{
-			case EWeaponState::WS_Sheathed:
-				StateComponent->SetWeaponState(EWeaponState::WS_Unsheathed);
-				break;
-
-			case EWeaponState::WS_Unsheathed:
-				StateComponent->SetWeaponState(EWeaponState::WS_Sheathed);
-				break;
-			}
-
-			StateComponent->SetCharacterState(ECharacterState::CS_Switching);
+		case EWeaponState::WS_Sheathed:
+			StateComponent->SetWeaponState(EWeaponState::WS_Unsheathed);
+			break;
+
+		case EWeaponState::WS_Unsheathed:
+			StateComponent->SetWeaponState(EWeaponState::WS_Sheathed);
+			break;
 		}
+
+		StateComponent->SetCharacterState(ECharacterState::CS_Switching);
 	}
 
 	StopMovement();
@@ -378,52 +428,52 @@ void AAscensionCharacter::SwitchWeapon()
 
 void AAscensionCharacter::StopMovement()
 {
-	GetCharacterMovement()->MaxWalkSpeed = 0.0f;
+	GetGameMovementComponent()->SetMovementSpeed(0.0f);
 }
 
 void AAscensionCharacter::SetMovementSpeed(float Speed)
 {
-	GetCharacterMovement()->MaxWalkSpeed = Speed;
+	GetGameMovementComponent()->SetMovementSpeed(Speed);
 }
 
 void AAscensionCharacter::ResetMovementSpeed()
 {
-	GetCharacterMovement()->MaxWalkSpeed = NormalSpeed;
+	GetGameMovementComponent()->ResetMovementSpeed();
 }
 
 void AAscensionCharacter::SetAcceleration(float Acceleration)
 {
-	GetCharacterMovement()->MaxAcceleration = Acceleration;
+	GetGameMovementComponent()->SetAcceleration(Acceleration);
 }
 
 void AAscensionCharacter::ResetAcceleration()
 {
-	GetCharacterMovement()->MaxAcceleration = NormalAcceleration;
+	GetGameMovementComponent()->ResetAcceleration();
 }
 
 void AAscensionCharacter::StopTurning()
 {
-	GetCharacterMovement()->RotationRate = FRotator(0.0f, 0.0f, 0.0f);
+	GetGameMovementComponent()->SetTurningRate(0.0f);
 }
 
 void AAscensionCharacter::SetTurningRate(float Rate)
 {
-	GetCharacterMovement()->RotationRate = FRotator(0.0f, Rate, 0.0f);
+	GetGameMovementComponent()->SetTurningRate(Rate);
 }
 
 void AAscensionCharacter::ResetTurningRate()
 {
-	GetCharacterMovement()->RotationRate = FRotator(0.0f, NormalTurnRate, 0.0f);
+	GetGameMovementComponent()->ResetTurningRate();
 }
 
 void AAscensionCharacter::SetGravity(float GravityValue)
 {
-	GetCharacterMovement()->GravityScale = GravityValue;
+	GetGameMovementComponent()->SetGravity(GravityValue);
 }
 
 void AAscensionCharacter::ResetGravity()
 {
-	GetCharacterMovement()->GravityScale = 1.0f;
+	GetGameMovementComponent()->ResetGravity();
 }
 
 float AAscensionCharacter::GetHealthPercentage() const
@@ -552,6 +602,11 @@ void AAscensionCharacter::ApplyHitEffect_Implementation(const AActor* SourceActo
 	}
 }
 
+void AAscensionCharacter::ApplyResolvedHit(const FResolvedHit& Hit)
+{
+	ApplyHitEffect(Hit.SourceActor, Hit.Damage, Hit.HitEffect, Hit.AttackEffect);
+}
+
 bool AAscensionCharacter::IsDead_Implementation()
 {
 	return (StateComponent->GetCharacterState() == ECharacterState::CS_Dead);
@@ -564,10 +619,97 @@ FVector AAscensionCharacter::GetMovementDirection_Implementation() const
 {
 	if (LockedOn && LockedActor != nullptr)
 	{
-		FVector TargetDirection = LockedActor->GetActorLocation() - GetActorLocation();
-		TargetDirection.Normalize();
-		return TargetDirection;
+		// Abilities and movement ask for the direction many times a frame.
+		if (LockDirectionFrame != GFrameCounter)
+		{
+			LockDirection = (LockedActor->GetActorLocation() - GetActorLocation()).GetSafeNormal();
+			LockDirectionFrame = GFrameCounter;
+		}
+
+		return LockDirection;
+	}
+
+	// Without input, the intent is wherever the character faces now.
+	if ((ForwardIntent + SideIntent).IsNearlyZero(0.01f))
+	{
+		const FRotator YawRotation(0, GetActorRotation().Yaw, 0);
+		return FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
 	}
 
 	return MovementIntent;
 }
+
+void AAscensionCharacter::ToggleLockOn()
+{
+	if (LockedOn)
+	{
+		ReleaseLockOn();
+		return;
+	}
+
+	AActor* Target = LockOnSubsystem ? LockOnSubsystem->FindBestTarget(this) : nullptr;
+
+	if (Target)
+	{
+		LockedOn = true;
+		LockedActor = Target;
+		LockDirectionFrame = 0;
+		LockOnSubsystem->SetHeldTarget(this, Target);
+	}
+}
+
+void AAscensionCharacter::SwitchLockOnTarget(int32 Direction)
+{
+	if (!LockedOn || LockOnSubsystem == nullptr)
+	{
+		return;
+	}
+
+	if (AActor* Target = LockOnSubsystem->FindNextTarget(this, LockedActor, Direction))
+	{
+		LockedActor = Target;
+		LockDirectionFrame = 0;
+		LockOnSubsystem->SetHeldTarget(this, Target);
+	}
+}
+
+void AAscensionCharacter::ReleaseLockOn()
+{
+	LockedOn = false;
+	LockedActor = nullptr;
+
+	if (LockOnSubsystem)
+	{
+		LockOnSubsystem->SetHeldTarget(this, nullptr);
+	}
+}
+
+void AAscensionCharacter::SwitchTargetLeft()
+{
+	SwitchLockOnTarget(-1);
+}
+
+void AAscensionCharacter::SwitchTargetRight()
+{
+	SwitchLockOnTarget(1);
+}
+
+void AAscensionCharacter::OnLockOnCandidatesRefreshed(APawn* Seeker)
+{
+	if (Seeker != this || !LockedOn || LockOnSubsystem->IsTargetValid(this, LockedActor))
+	{
+		return;
+	}
+
+	// The locked actor died, got out of range or out of sight.
+	if (AActor* Target = LockOnSubsystem->FindBestTarget(this))
+	{
+		LockedActor = Target;
+		LockDirectionFrame = 0;
+		LockOnSubsystem->SetHeldTarget(this, Target);
+	}
+	else
+	{
+		ReleaseLockOn();
+	}
+}
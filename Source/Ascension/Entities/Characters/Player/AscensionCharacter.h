@@ -59,8 +59,16 @@ public:
 	/** Character's BeginPlay function. */
 	virtual void BeginPlay();
 
-	/** Character's Tick function. */
-	virtual void Tick(float DeltaSeconds);
+	/** Called when the character exits play. */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/* Possession functions. */
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
+	virtual void OnRep_Controller() override;
+
+	/** Updates the movement state when the movement mode changes, e.g. when falling or landing. */
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
 
 public:
 	/** Current health of the character.*/
@@ -99,6 +107,9 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
 	float NormalTurnRate;
 
+	/** Handle of the sprint movement modifier. 0 while not sprinting. */
+	int32 SprintModifierHandle;
+
 	/** Used to indicate to the animation blueprint whether the character should switch weapons. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Animation")
 	bool ShouldCharSwitch;
@@ -115,6 +126,26 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
 	FVector MovementIntent;
 
+	/** Value of the forward axis when the movement intent was last computed. */
+	float ForwardAxisValue;
+
+	/** Value of the right axis when the movement intent was last computed. */
+	float RightAxisValue;
+
+	/** Control yaw when the movement intent was last computed. */
+	float IntentControlYaw;
+
+	/** Horizontal forward and right axes of the control rotation at IntentControlYaw. */
+	FVector ControlForward;
+	FVector ControlRight;
+
+	/** Frame the move input was last buffered in. */
+	uint64 MoveBufferedFrame;
+
+	/** Input buffer of the controller. */
+	UPROPERTY(Transient)
+	class UPlayerInputComponent* InputBufferComponent;
+
 	/** The direction the player should perform an action. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Movement")
 	FVector ActionDirection;
@@ -127,6 +158,16 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
 	AActor* LockedActor;
 
+	/** Direction to the locked actor, computed once per frame. */
+	mutable FVector LockDirection;
+
+	/** Frame the direction to the locked actor was last computed in. */
+	mutable uint64 LockDirectionFrame;
+
+	/** Subsystem picking lock-on targets. */
+	UPROPERTY(Transient)
+	class ULockOnSubsystem* LockOnSubsystem;
+
 protected:
 	/** Resets HMD orientation in VR. */
 	void OnResetVR();
@@ -183,6 +224,33 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Gameplay")
 	void SwitchWeapon();
 
+	/** Locks on to the best target in front of the player, or releases the lock if already locked on. */
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void ToggleLockOn();
+
+	/*
+	 * Switches the lock to the next target to the side.
+	 * @param Direction		Positive to switch to the right, negative to switch to the left.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void SwitchLockOnTarget(int32 Direction);
+
+	/** Releases the lock on the locked actor. */
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void ReleaseLockOn();
+
+	/** Called for the player to switch the lock to the target on the left. */
+	void SwitchTargetLeft();
+
+	/** Called for the player to switch the lock to the target on the right. */
+	void SwitchTargetRight();
+
+	/*
+	 * Switches to the best target, or releases the lock, when the locked actor is out of range or out of sight.
+	 * @param Seeker	Pawn whose candidates were refreshed.
+	 */
+	void OnLockOnCandidatesRefreshed(APawn* Seeker);
+
 	/** Called to stop player movement. */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void StopMovement();
@@ -223,6 +291,26 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void ResetGravity();
 
+	/*
+	 * Recomputes the movement intent if the movement axes or the control rotation changed since it was last computed,
+	 * and keeps the move input buffered while there is any.
+	 * @param ForwardValue	Value of the forward axis.
+	 * @param RightValue	Value of the right axis.
+	 */
+	void UpdateMovementIntent(const float ForwardValue, const float RightValue);
+
+	/** Refreshes the move input in the input buffer while there is movement intent. */
+	void BufferMoveInput();
+
+	/** Sets the movement state from the movement mode. */
+	void UpdateMovementState();
+
+	/*
+	 * Function to get the input buffer of the controller, cached on possession.
+	 * @returns UPlayerInputComponent*	Input buffer of the controller. Null if it has none.
+	 */
+	class UPlayerInputComponent* GetInputBufferComponent();
+
 	/** Handler for when a touch input begins. */
 	void TouchStarted(ETouchIndex::Type FingerIndex, FVector Location);
 
@@ -312,6 +400,9 @@ public:
 	void ApplyHitEffect(const AActor* SourceActor, const float Damage, const EHitEffect HitEffect, const FAttackEffect AttackEffect);
 	virtual void ApplyHitEffect_Implementation(const AActor* SourceActor, const float Damage, const EHitEffect HitEffect, const FAttackEffect AttackEffect) override;
 
+	/** Applies the hits received this frame natively. */
+	virtual void ApplyResolvedHit(const FResolvedHit& Hit) override;
+
 	/** Shows the entity's health bar. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Interface Functions")
 	void ShowHealthBar();
@@ -18,6 +18,16 @@ enum class EAIState : uint8
 	AIS_Combat			UMETA(DisplayName = "Combat")
 };
 
+UENUM(BlueprintType)
+enum class ESignificanceBucket : uint8
+{
+	SB_Near				UMETA(DisplayName = "Near"),
+	SB_Visible			UMETA(DisplayName = "Visible"),
+	SB_Hidden			UMETA(DisplayName = "Hidden"),
+	SB_Dormant			UMETA(DisplayName = "Dormant"),
+	SB_MAX				UMETA(Hidden)
+};
+
 UENUM(BlueprintType)
 enum class EEnemyState : uint8
 {
@@ -118,4 +128,13 @@ struct FCustomMovementParams
 	// Whether the attack has Z-movement.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
 	bool HasZMovement = false;
+
+	// Priority of the movement over other movement modifiers, e.g. sprinting.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
+	int32 Priority = 0;
+
+	// Forward, side and up movement over the normalized time of the ability's montage, in the same units as
+	// ControlledMove. If set, the movement component drives the controlled movement itself while the montage plays.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
+	class UCurveVector* MovementCurve = nullptr;
 };
@@ -9,3 +9,8 @@ UDamageable::UDamageable(const class FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
 }
+
+void IDamageable::ApplyResolvedHit(const FResolvedHit& Hit)
+{
+	Execute_ApplyHitEffect(_getUObject(), Hit.SourceActor, Hit.Damage, Hit.HitEffect, Hit.AttackEffect);
+}
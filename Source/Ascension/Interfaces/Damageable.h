@@ -6,6 +6,56 @@
 #include "Damageable.generated.h"
 
 
+/*
+ * Record of a single hit on a damageable actor, queued to be resolved at the end of the frame.
+ */
+struct FCombatHitRecord
+{
+	/** Actor that caused the hit. */
+	const AActor* SourceActor;
+
+	/** Combat index of the actor that was hit. */
+	int32 TargetIndex;
+
+	/** Damage dealt by the hit. */
+	float Damage;
+
+	/** Type of effect of the hit. */
+	EHitEffect HitEffect;
+
+	/** Effect of the attack on the actor. */
+	FAttackEffect AttackEffect;
+
+	/** Location of the hit. */
+	FVector HitPoint;
+};
+
+/*
+ * Every hit an actor received during a frame, combined into one.
+ * The effect, source and location are those of the hit that dealt the most damage.
+ */
+struct FResolvedHit
+{
+	/** Actor that caused the strongest hit. */
+	const AActor* SourceActor;
+
+	/** Total damage dealt by every hit. */
+	float Damage;
+
+	/** Type of effect of the strongest hit. */
+	EHitEffect HitEffect;
+
+	/** Effect of the strongest hit. */
+	FAttackEffect AttackEffect;
+
+	/** Location of the strongest hit. */
+	FVector HitPoint;
+
+	/** Number of hits combined. */
+	int32 NumHits;
+};
+
+
 // This class does not need to be modified.
 UINTERFACE(MinimalAPI)
 class UDamageable : public UInterface
@@ -41,4 +91,11 @@ public:
 	/** Checks if the entity is dead. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Interface Functions")
 	bool IsDead();
+
+	/*
+	 * Applies every hit the entity received this frame at once. Called by the damageable subsystem.
+	 * Defaults to a single ApplyHitEffect call with the combined damage.
+	 * @param Hit	The combined hits.
+	 */
+	virtual void ApplyResolvedHit(const FResolvedHit& Hit);
 };
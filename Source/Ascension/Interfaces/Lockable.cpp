@@ -11,3 +11,14 @@ ULockable::ULockable(const class FObjectInitializer& ObjectInitializer)
 }
 
 // Add default functionality here for any ILockable functions that are not pure virtual.
+
+bool ILockable::CanBeLockedOn() const
+{
+	return true;
+}
+
+FVector ILockable::GetLockOnLocation() const
+{
+	const AActor* Actor = Cast<AActor>(_getUObject());
+	return Actor ? Actor->GetActorLocation() : FVector::ZeroVector;
+}
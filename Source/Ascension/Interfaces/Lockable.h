@@ -11,8 +11,9 @@ class ULockable : public UInterface
 	GENERATED_UINTERFACE_BODY()
 };
 
-/**
- * 
+/*
+ * Interface for actors the player can lock on to.
+ * Lockable actors are registered with the lock-on subsystem, which picks targets from them.
  */
 class ASCENSION_API ILockable
 {
@@ -20,6 +21,15 @@ class ASCENSION_API ILockable
 
 	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
 public:
-	
-	
+	/*
+	 * Whether the actor can be locked on to right now, e.g. false once it is dead.
+	 * Defaults to true.
+	 */
+	virtual bool CanBeLockedOn() const;
+
+	/*
+	 * Gets the point the camera and line of sight checks aim at.
+	 * Defaults to the actor's location.
+	 */
+	virtual FVector GetLockOnLocation() const;
 };
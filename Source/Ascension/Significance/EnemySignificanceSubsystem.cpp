@@ -0,0 +1,310 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "EnemySignificanceSubsystem.h"
+#include "Entities/Characters/Enemies/Enemy.h"
+#include "Components/GameMovementComponent.h"
+#include "Components/StrafeComponent.h"
+#include "AI/ThrottledBehaviorTreeComponent.h"
+#include "AIController.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AISenseConfig.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Significance Update"), STAT_EnemySignificanceUpdate, STATGROUP_Ascension);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Near"), STAT_EnemiesNear, STATGROUP_Ascension);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Visible"), STAT_EnemiesVisible, STATGROUP_Ascension);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Hidden"), STAT_EnemiesHidden, STATGROUP_Ascension);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Dormant"), STAT_EnemiesDormant, STATGROUP_Ascension);
+
+static TAutoConsoleVariable<int32> CVarSignificanceEnable(
+	TEXT("Ascension.Significance.Enable"),
+	1,
+	TEXT("Whether enemies update less often when they are far from the players or can't be seen."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceUpdateInterval(
+	TEXT("Ascension.Significance.UpdateInterval"),
+	0.2f,
+	TEXT("Time in seconds between significance updates."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceNearDistance(
+	TEXT("Ascension.Significance.NearDistance"),
+	2000.0f,
+	TEXT("Distance within which enemies always update at full rate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceVisibleDistance(
+	TEXT("Ascension.Significance.VisibleDistance"),
+	6000.0f,
+	TEXT("Distance within which rendered enemies are in the visible bucket. Further or unrendered enemies are hidden."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceDormantDistance(
+	TEXT("Ascension.Significance.DormantDistance"),
+	12000.0f,
+	TEXT("Distance beyond which enemies are dormant."),
+	ECVF_Default);
+
+const FName UEnemySignificanceSubsystem::SignificanceTag(TEXT("Enemy"));
+
+/** Update rates of each bucket, from most to least significant. */
+static const FSignificanceBucketSettings BucketSettings[(uint8) ESignificanceBucket::SB_MAX] =
+{
+	// Actor,	Movement,	AI,		Senses,	Mesh,	URO,	Anim tick option
+	{ 0.0f,		0.0f,		0.0f,	true,	0.0f,	false,	EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones },
+	{ 0.1f,		0.033f,		0.1f,	true,	0.0f,	true,	EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered },
+	{ 0.25f,	0.1f,		0.25f,	false,	0.1f,	true,	EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered },
+	{ 0.5f,		0.25f,		0.5f,	false,	0.25f,	true,	EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered }
+};
+
+
+void UEnemySignificanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FMemory::Memzero(BucketCounts, sizeof(BucketCounts));
+	TimeUntilUpdate = 0.0f;
+	bWasEnabled = true;
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UEnemySignificanceSubsystem::UpdateSignificance);
+}
+
+void UEnemySignificanceSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	Enemies.Reset();
+
+	Super::Deinitialize();
+}
+
+void UEnemySignificanceSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld());
+
+	if (Enemy == nullptr || SignificanceManager == nullptr || Enemies.Contains(Enemy))
+	{
+		return;
+	}
+
+	Enemies.Add(Enemy);
+	BucketCounts[(uint8) Enemy->GetSignificanceBucket()]++;
+
+	SignificanceManager->RegisterObject(Enemy, SignificanceTag, &UEnemySignificanceSubsystem::CalculateSignificance, USignificanceManager::EPostSignificanceType::Sequential,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+		{
+			PostSignificance(ObjectInfo, OldSignificance, Significance, bFinal);
+		});
+}
+
+void UEnemySignificanceSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	if (Enemies.RemoveSwap(Enemy) == 0)
+	{
+		return;
+	}
+
+	BucketCounts[(uint8) Enemy->GetSignificanceBucket()]--;
+
+	if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterObject(Enemy);
+	}
+}
+
+void UEnemySignificanceSubsystem::MakeSignificant(AEnemy* Enemy)
+{
+	if (Enemy && Enemy->GetSignificanceBucket() != ESignificanceBucket::SB_Near && Enemies.Contains(Enemy))
+	{
+		ApplyBucket(Enemy, ESignificanceBucket::SB_Near);
+	}
+}
+
+const FSignificanceBucketSettings& UEnemySignificanceSubsystem::GetBucketSettings(const ESignificanceBucket Bucket)
+{
+	return BucketSettings[(uint8) Bucket];
+}
+
+void UEnemySignificanceSubsystem::UpdateSignificance(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || Enemies.Num() == 0)
+	{
+		return;
+	}
+
+	const bool bEnabled = CVarSignificanceEnable.GetValueOnGameThread() != 0;
+
+	if (!bEnabled)
+	{
+		if (bWasEnabled)
+		{
+			ResetBuckets();
+		}
+
+		bWasEnabled = false;
+		return;
+	}
+
+	// Update right away when re-enabled.
+	TimeUntilUpdate = bWasEnabled ? TimeUntilUpdate - DeltaSeconds : 0.0f;
+	bWasEnabled = true;
+
+	if (TimeUntilUpdate > 0.0f)
+	{
+		return;
+	}
+
+	TimeUntilUpdate = CVarSignificanceUpdateInterval.GetValueOnGameThread();
+
+	USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(World);
+
+	if (SignificanceManager == nullptr)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_EnemySignificanceUpdate);
+
+	// Servers also keep enemies near remote players significant.
+	Viewpoints.Reset();
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			Viewpoints.Add(FTransform(Rotation, Location));
+		}
+	}
+
+	SignificanceManager->Update(Viewpoints);
+
+	SET_DWORD_STAT(STAT_EnemiesNear, BucketCounts[(uint8) ESignificanceBucket::SB_Near]);
+	SET_DWORD_STAT(STAT_EnemiesVisible, BucketCounts[(uint8) ESignificanceBucket::SB_Visible]);
+	SET_DWORD_STAT(STAT_EnemiesHidden, BucketCounts[(uint8) ESignificanceBucket::SB_Hidden]);
+	SET_DWORD_STAT(STAT_EnemiesDormant, BucketCounts[(uint8) ESignificanceBucket::SB_Dormant]);
+}
+
+float UEnemySignificanceSubsystem::CalculateSignificance(USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+{
+	const AEnemy* Enemy = CastChecked<AEnemy>(ObjectInfo->GetObject());
+	const float DistanceSquared = FVector::DistSquared(Enemy->GetActorLocation(), Viewpoint.GetLocation());
+
+	ESignificanceBucket Bucket = ESignificanceBucket::SB_Dormant;
+
+	// Enemies circling while they wait to attack only need the update rates of visible enemies.
+	if (Enemy->IsInCombat() && Enemy->IsWaitingToAttack())
+	{
+		Bucket = ESignificanceBucket::SB_Visible;
+	}
+	else if (Enemy->IsInCombat() || DistanceSquared <= FMath::Square(CVarSignificanceNearDistance.GetValueOnAnyThread()))
+	{
+		Bucket = ESignificanceBucket::SB_Near;
+	}
+	else if (DistanceSquared <= FMath::Square(CVarSignificanceVisibleDistance.GetValueOnAnyThread()) && Enemy->WasRecentlyRendered(0.25f))
+	{
+		Bucket = ESignificanceBucket::SB_Visible;
+	}
+	else if (DistanceSquared <= FMath::Square(CVarSignificanceDormantDistance.GetValueOnAnyThread()))
+	{
+		Bucket = ESignificanceBucket::SB_Hidden;
+	}
+
+	// The most significant viewpoint wins, so nearer buckets are more significant.
+	return float((uint8) ESignificanceBucket::SB_MAX - 1 - (uint8) Bucket);
+}
+
+void UEnemySignificanceSubsystem::PostSignificance(USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+{
+	AEnemy* Enemy = CastChecked<AEnemy>(ObjectInfo->GetObject());
+
+	// Enemies leaving play get their full update rates back.
+	const ESignificanceBucket Bucket = bFinal ? ESignificanceBucket::SB_Near : ESignificanceBucket((uint8) ESignificanceBucket::SB_MAX - 1 - (uint8) Significance);
+
+	if (Bucket != Enemy->GetSignificanceBucket())
+	{
+		ApplyBucket(Enemy, Bucket);
+	}
+}
+
+void UEnemySignificanceSubsystem::ApplyBucket(AEnemy* Enemy, const ESignificanceBucket Bucket)
+{
+	const FSignificanceBucketSettings& Settings = GetBucketSettings(Bucket);
+
+	if (Enemies.Contains(Enemy))
+	{
+		BucketCounts[(uint8) Enemy->GetSignificanceBucket()]--;
+		BucketCounts[(uint8) Bucket]++;
+	}
+
+	Enemy->SetSignificanceBucket(Bucket);
+	Enemy->SetActorTickInterval(Settings.ActorTickInterval);
+	Enemy->GetCharacterMovement()->SetComponentTickInterval(Settings.MovementTickInterval);
+	Enemy->GetGameMovementComponent()->SetLightweightMovement(Bucket != ESignificanceBucket::SB_Near);
+
+	// Strafing only adds movement input, so there's no point in it ticking more often than the movement.
+	if (UStrafeComponent* StrafeComponent = Enemy->FindComponentByClass<UStrafeComponent>())
+	{
+		StrafeComponent->SetComponentTickInterval(Settings.MovementTickInterval);
+	}
+
+	AAIController* AIController = Cast<AAIController>(Enemy->GetController());
+
+	if (AIController)
+	{
+		AIController->SetActorTickInterval(Settings.AITickInterval);
+
+		// Behavior trees overwrite their own tick interval, so only controllers with a throttled tree can be slowed down.
+		if (UThrottledBehaviorTreeComponent* BehaviorTree = Cast<UThrottledBehaviorTreeComponent>(AIController->GetBrainComponent()))
+		{
+			BehaviorTree->SetTickThrottle(Settings.AITickInterval);
+		}
+	}
+
+	// Enemies that can't be seen stop perceiving. They come back into view long before they could reach the players.
+	// Goblins carry their perception on the pawn, other enemies may have it on their controller.
+	UAIPerceptionComponent* Perception = Enemy->FindComponentByClass<UAIPerceptionComponent>();
+
+	if (Perception == nullptr && AIController)
+	{
+		Perception = AIController->GetPerceptionComponent();
+	}
+
+	if (Perception)
+	{
+		for (auto It = Perception->GetSensesConfigIterator(); It; ++It)
+		{
+			if (const UAISenseConfig* SenseConfig = *It)
+			{
+				Perception->SetSenseEnabled(SenseConfig->GetSenseImplementation(), Settings.bPerception);
+			}
+		}
+	}
+
+	// Visible enemies skip animation frames and interpolate them. Enemies that can't be seen tick their mesh less often.
+	USkeletalMeshComponent* Mesh = Enemy->GetMesh();
+
+	if (Mesh)
+	{
+		Mesh->bEnableUpdateRateOptimizations = Settings.bUpdateRateOptimizations;
+		Mesh->VisibilityBasedAnimTickOption = Settings.AnimTickOption;
+		Mesh->SetComponentTickInterval(Settings.MeshTickInterval);
+
+		if (Mesh->AnimUpdateRateParams)
+		{
+			Mesh->AnimUpdateRateParams->bInterpolateSkippedFrames = true;
+		}
+	}
+}
+
+void UEnemySignificanceSubsystem::ResetBuckets()
+{
+	for (AEnemy* Enemy : Enemies)
+	{
+		if (Enemy && Enemy->GetSignificanceBucket() != ESignificanceBucket::SB_Near)
+		{
+			ApplyBucket(Enemy, ESignificanceBucket::SB_Near);
+		}
+	}
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Globals.h"
+#include "SignificanceManager.h"
+#include "EnemySignificanceSubsystem.generated.h"
+
+
+/*
+ * How often an enemy in a significance bucket updates.
+ */
+struct FSignificanceBucketSettings
+{
+	/** Tick interval of the enemy actor. */
+	float ActorTickInterval;
+
+	/** Tick interval of the character movement. */
+	float MovementTickInterval;
+
+	/** Tick interval of the AI controller and its throttled behavior tree. Ticking tasks get the time since the tree last ticked. */
+	float AITickInterval;
+
+	/** Whether the enemy's senses update. */
+	bool bPerception;
+
+	/** Tick interval of the mesh. Only used in buckets where the enemy isn't seen. */
+	float MeshTickInterval;
+
+	/** Whether animation update rate optimizations are used, interpolating skipped frames. */
+	bool bUpdateRateOptimizations;
+
+	/** How the mesh ticks while it isn't rendered. */
+	EVisibilityBasedAnimTickOption AnimTickOption;
+};
+
+/*
+ * Subsystem bucketing enemies by their significance to the players, using the significance manager.
+ *
+ * Enemies are bucketed by distance from the players' viewpoints and by whether they were recently rendered. Enemies
+ * in combat are always near, unless they are waiting for an attack token, in which case they are visible. The
+ * movement, AI and animation of enemies in less significant buckets tick less often: visible enemies interpolate their
+ * skipped animation frames, and enemies that can't be seen only tick montages.
+ * Enemies outside the near bucket also use lightweight movement, walking on the navmesh, and hidden and dormant
+ * enemies stop perceiving until they come back into view.
+ *
+ * Significance is updated at an interval rather than every frame, and an enemy's update rates are only changed when
+ * it moves to another bucket. Use Ascension.Benchmark.Significance to compare frame times with and without it, and
+ * Ascension.Benchmark.AI to measure the time spent on AI.
+ */
+UCLASS()
+class ASCENSION_API UEnemySignificanceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Subsystem functions. */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/*
+	 * Registers an enemy with the significance manager. The enemy starts in the near bucket.
+	 * @param Enemy		Enemy to register.
+	 */
+	void RegisterEnemy(class AEnemy* Enemy);
+
+	/*
+	 * Unregisters an enemy from the significance manager.
+	 * @param Enemy		Enemy to unregister.
+	 */
+	void UnregisterEnemy(class AEnemy* Enemy);
+
+	/*
+	 * Moves an enemy to the near bucket right away, e.g. when it enters combat, rather than on the next update.
+	 * @param Enemy		Enemy.
+	 */
+	void MakeSignificant(class AEnemy* Enemy);
+
+	/*
+	 * Gets the update rates of a bucket.
+	 * @param Bucket	Significance bucket.
+	 */
+	static const FSignificanceBucketSettings& GetBucketSettings(const ESignificanceBucket Bucket);
+
+	/*
+	 * Returns the number of registered enemies in each bucket.
+	 */
+	FORCEINLINE const int32* GetBucketCounts() const { return BucketCounts; }
+
+protected:
+	/*
+	 * Updates the significance of every registered enemy, if the update interval has passed.
+	 * @param World			World that ticked.
+	 * @param TickType		Type of the tick.
+	 * @param DeltaSeconds	Time since the last tick.
+	 */
+	void UpdateSignificance(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/*
+	 * Computes the significance of an enemy for a viewpoint.
+	 * @param ObjectInfo	Significance manager info of the enemy.
+	 * @param Viewpoint		Viewpoint of a player.
+	 * @returns float		Significance of the enemy, higher for more significant buckets.
+	 */
+	static float CalculateSignificance(USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint);
+
+	/*
+	 * Moves an enemy to the bucket of its new significance, if it changed.
+	 * @param ObjectInfo		Significance manager info of the enemy.
+	 * @param OldSignificance	Previous significance of the enemy.
+	 * @param Significance		New significance of the enemy.
+	 * @param bFinal			Whether the enemy is being unregistered.
+	 */
+	void PostSignificance(USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal);
+
+	/*
+	 * Applies the update rates of a bucket to an enemy.
+	 * @param Enemy		Enemy.
+	 * @param Bucket	Significance bucket.
+	 */
+	void ApplyBucket(class AEnemy* Enemy, const ESignificanceBucket Bucket);
+
+	/*
+	 * Moves every registered enemy back to the near bucket.
+	 */
+	void ResetBuckets();
+
+protected:
+	/** Tag enemies are registered with. */
+	static const FName SignificanceTag;
+
+	/** Enemies registered. */
+	UPROPERTY(Transient)
+	TArray<class AEnemy*> Enemies;
+
+	/** Number of registered enemies in each bucket. */
+	int32 BucketCounts[(uint8) ESignificanceBucket::SB_MAX];
+
+	/** Time until significance is next updated. */
+	float TimeUntilUpdate;
+
+	/** Whether significance was enabled on the last update. */
+	bool bWasEnabled;
+
+	/** Viewpoints of the players, reused between updates. */
+	TArray<FTransform> Viewpoints;
+
+	/** Handle of the post actor tick delegate. */
+	FDelegateHandle PostActorTickHandle;
+};
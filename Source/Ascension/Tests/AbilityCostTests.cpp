@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "Misc/AutomationTest.h"
+#include "Abilities/Ability.h"
+#include "Abilities/AbilitySystems/GameAbilitySystemComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAbilityCostAboveMaxStaminaTest, "Ascension.Abilities.CostAboveMaxStamina",
+								 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAbilityCostAboveMaxStaminaTest::RunTest(const FString& Parameters)
+{
+	UGameAbilitySystemComponent* AbilitySystem = NewObject<UGameAbilitySystemComponent>();
+	UAbility* AbilityDefaults = UAbility::StaticClass()->GetDefaultObject<UAbility>();
+
+	// Costs are read from the class defaults when the ability is added.
+	const float PreviousStaminaCost = AbilityDefaults->StaminaCost;
+	AbilityDefaults->StaminaCost = 1000.0f;
+	AbilitySystem->AddAbility(TEXT("Expensive"), UAbility::StaticClass());
+	AbilityDefaults->StaminaCost = PreviousStaminaCost;
+
+	TestFalse(TEXT("An ability costing more than the maximum stamina can't be activated"), AbilitySystem->CanActivateAbility(TEXT("Expensive")));
+
+	return true;
+}
+
+#endif
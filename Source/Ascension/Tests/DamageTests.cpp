@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ascension.h"
+#include "Misc/AutomationTest.h"
+#include "Entities/Characters/Enemies/Goblin.h"
+#include "Interfaces/Damageable.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FResolvedHitDamageTest, "Ascension.Combat.ResolvedHitDamage",
+								 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FResolvedHitDamageTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	AGoblin* Goblin = World->SpawnActor<AGoblin>();
+
+	if (!TestNotNull(TEXT("Goblin spawned"), Goblin))
+	{
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	FResolvedHit Hit;
+	Hit.SourceActor = nullptr;
+	Hit.Damage = 10.0f;
+	Hit.HitEffect = EHitEffect::HE_PushBack;
+	Hit.AttackEffect = FAttackEffect();
+	Hit.HitPoint = FVector::ZeroVector;
+	Hit.NumHits = 1;
+
+	IDamageable* Damageable = Goblin;
+	const float StartHealth = Goblin->Health;
+
+	Damageable->ApplyResolvedHit(Hit);
+	TestEqual(TEXT("Health drops by the damage of one resolved hit"), Goblin->Health, StartHealth - Hit.Damage);
+
+	Damageable->ApplyResolvedHit(Hit);
+	TestEqual(TEXT("Health drops by the damage of each resolved hit"), Goblin->Health, StartHealth - 2.0f * Hit.Damage);
+
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif